@@ -464,6 +464,7 @@ $$ LANGUAGE plpgsql
  * @param {text} pAgent - Агент
  * @param {inet} pHost - IP адрес
  * @param {interval} pTimeWindow - Временное окно
+ * @param {boolean} pLog - Записать запрос в api.log (false - запись делает сервер приложений, см. daemon.WriteLog)
  * @return {SETOF json} - Записи в JSON
  */
 CREATE OR REPLACE FUNCTION daemon.SignFetch (
@@ -474,7 +475,8 @@ CREATE OR REPLACE FUNCTION daemon.SignFetch (
   pSignature    text DEFAULT null,
   pAgent        text DEFAULT null,
   pHost         inet DEFAULT null,
-  pTimeWindow   INTERVAL DEFAULT '5 sec'
+  pTimeWindow   INTERVAL DEFAULT '5 sec',
+  pLog          boolean DEFAULT true
 ) RETURNS       SETOF json
 AS $$
 DECLARE
@@ -504,7 +506,9 @@ BEGIN
     pTimeWindow := INTERVAL '1 min';
   END IF;
 
-  nApiId := AddApiLog(pPath, Payload);
+  IF pLog THEN
+    nApiId := AddApiLog(pPath, Payload);
+  END IF;
 
   BEGIN
     dtTimeStamp := coalesce(to_timestamp(pNonce / 1000000), Now());
@@ -530,7 +534,9 @@ BEGIN
         RETURN NEXT r.fetch;
       END LOOP;
 
-      UPDATE api.log SET runtime = age(clock_timestamp(), dtBegin) WHERE id = nApiId;
+      IF pLog THEN
+        UPDATE api.log SET runtime = age(clock_timestamp(), dtBegin) WHERE id = nApiId;
+      END IF;
 
       RETURN;
     ELSE
@@ -544,7 +550,11 @@ BEGIN
   PERFORM SetErrorMessage(vMessage);
 
   IF current_session() IS NOT NULL THEN
-    UPDATE api.log SET eventid = AddEventLog('E', 5000, vMessage) WHERE id = nApiId;
+    IF pLog THEN
+      UPDATE api.log SET eventid = AddEventLog('E', 5000, vMessage) WHERE id = nApiId;
+    ELSE
+      PERFORM AddEventLog('E', 5000, vMessage);
+    END IF;
   END IF;
 
   RETURN NEXT json_build_object('error', json_build_object('code', 5000, 'message', vMessage));
@@ -564,6 +574,121 @@ $$ LANGUAGE plpgsql
    SECURITY DEFINER
    SET search_path = kernel, pg_temp;
 
+--------------------------------------------------------------------------------
+-- daemon.OcppSession ----------------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Вход по сессии зарядной станции для вызова обработчика ocpp.* сервером приложений.
+ * Сервер приложений вызывает обработчики напрямую только для сессии, которую уже подтвердила база данных
+ * (/sign/in или /authorize через daemon.SignFetch).
+ * Сессия устанавливается только до конца транзакции: соединение из пула сервера приложений затем выполняет запросы
+ * других станций и клиентов.
+ * @param {text} pSession - Сессия
+ * @param {text} pAgent - Агент
+ * @param {inet} pHost - IP адрес
+ * @return {text} - Сессия
+ */
+CREATE OR REPLACE FUNCTION daemon.OcppSession (
+  pSession      text,
+  pAgent        text DEFAULT null,
+  pHost         inet DEFAULT null
+) RETURNS       text
+AS $$
+DECLARE
+  nUserId       numeric;
+BEGIN
+  IF SessionIn(pSession, pAgent, pHost) IS NULL THEN
+    PERFORM AuthenticateError(GetErrorMessage());
+  END IF;
+
+  nUserId := GetUserId();
+
+  -- SessionIn устанавливает сессию для всего соединения: сбросить её и оставить только до конца транзакции.
+  PERFORM SetSessionKey(null);
+  PERFORM SetUserId(null);
+
+  PERFORM set_config('auth.session', pSession, true);
+  PERFORM set_config('auth.user', trim(to_char(nUserId, '999999990000')), true);
+
+  RETURN pSession;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+--------------------------------------------------------------------------------
+-- daemon.WriteLog -------------------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Пакетная запись в api.log и ocpp.log записей, собранных сервером приложений.
+ * @param {jsonb} pLog - Массив записей:
+ *   {"log": "api", "datetime": double precision, "session": text, "route": text, "json": jsonb, "runtime": double precision}
+ *   {"log": "ocpp", "datetime": double precision, "identity": text, "action": text, "request": jsonb, "response": jsonb, "runtime": double precision}
+ *   datetime - Unix time в секундах, runtime - в секундах
+ * @return {integer} - Количество записей
+ */
+CREATE OR REPLACE FUNCTION daemon.WriteLog (
+  pLog          jsonb
+) RETURNS       integer
+AS $$
+DECLARE
+  nApi          integer;
+  nOcpp         integer;
+BEGIN
+  INSERT INTO api.log (datetime, api_session, api_username, route, json, runtime)
+  SELECT to_timestamp(r.datetime)::timestamp, s.key, u.username, r.route,
+         CASE WHEN lower(r.route) = '/sign/in' THEN r.json - 'password' ELSE r.json END,
+         r.runtime * interval '1 second'
+    FROM jsonb_to_recordset(pLog) AS r(log text, datetime double precision, session text, route text, json jsonb, runtime double precision)
+         LEFT JOIN db.session s ON s.key = r.session
+         LEFT JOIN db.user u ON u.id = s.userid
+   WHERE r.log = 'api';
+
+  GET DIAGNOSTICS nApi = ROW_COUNT;
+
+  INSERT INTO ocpp.log (datetime, identity, action, request, response, runtime)
+  SELECT to_timestamp(r.datetime)::timestamp, r.identity, r.action, r.request, r.response, r.runtime * interval '1 second'
+    FROM jsonb_to_recordset(pLog) AS r(log text, datetime double precision, identity text, action text, request jsonb, response jsonb, runtime double precision)
+   WHERE r.log = 'ocpp';
+
+  GET DIAGNOSTICS nOcpp = ROW_COUNT;
+
+  RETURN nApi + nOcpp;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+--------------------------------------------------------------------------------
+-- daemon.CheckPartitions ------------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Обслуживание секций ocpp.log, api.log и db.meter_value: создание будущих и удаление устаревших.
+ * @param {jsonb} pTables - Массив: {"table": text, "period": "day" | "month", "ahead": integer, "keep": integer}
+ * @return {SETOF json} - Результат по каждой таблице (см. CheckPartitions)
+ */
+CREATE OR REPLACE FUNCTION daemon.CheckPartitions (
+  pTables       jsonb
+) RETURNS       SETOF json
+AS $$
+DECLARE
+  r             record;
+BEGIN
+  FOR r IN SELECT * FROM jsonb_to_recordset(pTables) AS x("table" text, period text, ahead integer, keep integer)
+  LOOP
+    IF r.table NOT IN ('ocpp.log', 'api.log', 'db.meter_value') THEN
+      RAISE EXCEPTION 'Partition maintenance is not allowed for table "%".', r.table;
+    END IF;
+
+    RETURN NEXT CheckPartitions(r.table, r.period, coalesce(r.ahead, 3), coalesce(r.keep, 0));
+  END LOOP;
+
+  RETURN;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
 --------------------------------------------------------------------------------
 -- ParseToken ------------------------------------------------------------------
 --------------------------------------------------------------------------------
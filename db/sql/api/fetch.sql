@@ -18,6 +18,8 @@ DECLARE
   r         record;
   e         record;
 
+  rRoute    api.route%ROWTYPE;
+
   nKey      integer;
   arJson    json[];
 
@@ -36,6 +38,13 @@ BEGIN
     RETURN;
   END IF;
 
+  SELECT * INTO rRoute FROM api.route WHERE path = lower(pPath);
+
+  IF found THEN
+    RETURN QUERY SELECT * FROM api.route_fetch(rRoute, pPath, pPayload);
+    RETURN;
+  END IF;
+
   CASE lower(pPath)
   WHEN '/sign/in' THEN
 
@@ -1456,68 +1465,6 @@ BEGIN
 	  END LOOP;
 	END LOOP;
 
-  WHEN '/calendar/method' THEN
-
-	IF pPayload IS NULL THEN
-	  PERFORM JsonIsEmpty();
-	END IF;
-
-	arKeys := array_cat(arKeys, ARRAY['id']);
-	PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-	IF jsonb_typeof(pPayload) = 'array' THEN
-
-	  FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric)
-	  LOOP
-		FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_calendar(r.id) ORDER BY id
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	ELSE
-
-	  FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric)
-	  LOOP
-		FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_calendar(r.id) ORDER BY id
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	END IF;
-
-  WHEN '/calendar/count' THEN
-
-	IF pPayload IS NOT NULL THEN
-	  arKeys := array_cat(arKeys, ARRAY['search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-	  PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-	ELSE
-	  pPayload := '{}';
-	END IF;
-
-	IF jsonb_typeof(pPayload) = 'array' THEN
-
-	  FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-	  LOOP
-		FOR e IN SELECT count(*) FROM api.list_calendar(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	ELSE
-
-	  FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-	  LOOP
-		FOR e IN SELECT count(*) FROM api.list_calendar(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	END IF;
-
   WHEN '/calendar/add' THEN
 
 	IF pPayload IS NULL THEN
@@ -1568,37 +1515,6 @@ BEGIN
 
 	END IF;
 
-  WHEN '/calendar/get' THEN
-
-	IF pPayload IS NULL THEN
-	  PERFORM JsonIsEmpty();
-	END IF;
-
-	arKeys := array_cat(arKeys, ARRAY['id', 'fields']);
-	PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-	IF jsonb_typeof(pPayload) = 'array' THEN
-
-	  FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric, fields jsonb)
-	  LOOP
-		FOR e IN EXECUTE format('SELECT %s FROM api.get_calendar($1)', JsonbToFields(r.fields, GetColumns('calendar', 'api'))) USING r.id
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	ELSE
-
-	  FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric, fields jsonb)
-	  LOOP
-		FOR e IN EXECUTE format('SELECT %s FROM api.get_calendar($1)', JsonbToFields(r.fields, GetColumns('calendar', 'api'))) USING r.id
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	END IF;
-
   WHEN '/calendar/list' THEN
 
 	IF pPayload IS NOT NULL THEN
@@ -1868,78 +1784,6 @@ BEGIN
 
 	END IF;
 
-  WHEN '/address/type' THEN
-
-      FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb)
-      LOOP
-        FOR e IN EXECUTE format('SELECT %s FROM api.type($1)', JsonbToFields(r.fields, GetColumns('type', 'api'))) USING GetEssence('address')
-        LOOP
-          RETURN NEXT row_to_json(e);
-        END LOOP;
-      END LOOP;
-
-  WHEN '/address/method' THEN
-
-	IF pPayload IS NULL THEN
-	  PERFORM JsonIsEmpty();
-	END IF;
-
-	arKeys := array_cat(arKeys, ARRAY['id']);
-	PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-	IF jsonb_typeof(pPayload) = 'array' THEN
-
-	  FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric)
-	  LOOP
-		FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_address(r.id) ORDER BY id
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	ELSE
-
-	  FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric)
-	  LOOP
-		FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_address(r.id) ORDER BY id
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	END IF;
-
-  WHEN '/address/count' THEN
-
-	IF pPayload IS NOT NULL THEN
-	  arKeys := array_cat(arKeys, ARRAY['search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-	  PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-	ELSE
-	  pPayload := '{}';
-	END IF;
-
-	IF jsonb_typeof(pPayload) = 'array' THEN
-
-	  FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-	  LOOP
-		FOR e IN SELECT count(*) FROM api.list_address(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	ELSE
-
-	  FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-	  LOOP
-		FOR e IN SELECT count(*) FROM api.list_address(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	END IF;
-
   WHEN '/address/add' THEN
 
 	IF pPayload IS NULL THEN
@@ -1990,54 +1834,6 @@ BEGIN
 
 	END IF;
 
-  WHEN '/address/get' THEN
-
-	IF pPayload IS NULL THEN
-	  PERFORM JsonIsEmpty();
-	END IF;
-
-	arKeys := array_cat(arKeys, ARRAY['id', 'fields']);
-	PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-	IF jsonb_typeof(pPayload) = 'array' THEN
-
-	  FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric, fields jsonb)
-	  LOOP
-		FOR e IN EXECUTE format('SELECT %s FROM api.get_address($1)', JsonbToFields(r.fields, GetColumns('address', 'api'))) USING r.id
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	ELSE
-
-	  FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric, fields jsonb)
-	  LOOP
-		FOR e IN EXECUTE format('SELECT %s FROM api.get_address($1)', JsonbToFields(r.fields, GetColumns('address', 'api'))) USING r.id
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	END IF;
-
-  WHEN '/address/list' THEN
-
-	IF pPayload IS NOT NULL THEN
-	  arKeys := array_cat(arKeys, ARRAY['fields', 'search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-	  PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-	ELSE
-	  pPayload := '{}';
-	END IF;
-
-	FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb, search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-	LOOP
-	  FOR e IN EXECUTE format('SELECT %s FROM api.list_address($1, $2, $3, $4, $5)', JsonbToFields(r.fields, GetColumns('address', 'api'))) USING r.search, r.filter, r.reclimit, r.recoffset, r.orderby
-	  LOOP
-		RETURN NEXT row_to_json(e);
-	  END LOOP;
-	END LOOP;
-
   WHEN '/address/string' THEN
 
 	IF pPayload IS NULL THEN
@@ -2063,78 +1859,6 @@ BEGIN
 
 	END IF;
 
-  WHEN '/client/type' THEN
-
-      FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb)
-      LOOP
-        FOR e IN EXECUTE format('SELECT %s FROM api.type($1)', JsonbToFields(r.fields, GetColumns('type', 'api'))) USING GetEssence('client')
-        LOOP
-          RETURN NEXT row_to_json(e);
-        END LOOP;
-      END LOOP;
-
-  WHEN '/client/method' THEN
-
-	IF pPayload IS NULL THEN
-	  PERFORM JsonIsEmpty();
-	END IF;
-
-	arKeys := array_cat(arKeys, ARRAY['id']);
-	PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-	IF jsonb_typeof(pPayload) = 'array' THEN
-
-	  FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric)
-	  LOOP
-		FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_client(r.id) ORDER BY id
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	ELSE
-
-	  FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric)
-	  LOOP
-		FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_client(r.id) ORDER BY id
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	END IF;
-
-  WHEN '/client/count' THEN
-
-	IF pPayload IS NOT NULL THEN
-	  arKeys := array_cat(arKeys, ARRAY['search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-	  PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-	ELSE
-	  pPayload := '{}';
-	END IF;
-
-	IF jsonb_typeof(pPayload) = 'array' THEN
-
-	  FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-	  LOOP
-		FOR e IN SELECT count(*) FROM api.list_client(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	ELSE
-
-	  FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-	  LOOP
-		FOR e IN SELECT count(*) FROM api.list_client(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	END IF;
-
   WHEN '/client/add' THEN
 
 	IF pPayload IS NULL THEN
@@ -2185,55 +1909,7 @@ BEGIN
 
 	END IF;
 
-  WHEN '/client/get' THEN
-
-	IF pPayload IS NULL THEN
-	  PERFORM JsonIsEmpty();
-	END IF;
-
-	arKeys := array_cat(arKeys, ARRAY['id', 'fields']);
-	PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-	IF jsonb_typeof(pPayload) = 'array' THEN
-
-	  FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric, fields jsonb)
-	  LOOP
-		FOR e IN EXECUTE format('SELECT %s FROM api.get_client($1)', JsonbToFields(r.fields, GetColumns('client', 'api'))) USING r.id
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	ELSE
-
-	  FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric, fields jsonb)
-	  LOOP
-		FOR e IN EXECUTE format('SELECT %s FROM api.get_client($1)', JsonbToFields(r.fields, GetColumns('client', 'api'))) USING r.id
-		LOOP
-		  RETURN NEXT row_to_json(e);
-		END LOOP;
-	  END LOOP;
-
-	END IF;
-
-  WHEN '/client/list' THEN
-
-	IF pPayload IS NOT NULL THEN
-	  arKeys := array_cat(arKeys, ARRAY['fields', 'search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-	  PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-	ELSE
-	  pPayload := '{}';
-	END IF;
-
-	FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb, search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-	LOOP
-	  FOR e IN EXECUTE format('SELECT %s FROM api.list_client($1, $2, $3, $4, $5)', JsonbToFields(r.fields, GetColumns('client', 'api'))) USING r.search, r.filter, r.reclimit, r.recoffset, r.orderby
-	  LOOP
-		RETURN NEXT row_to_json(e);
-	  END LOOP;
-	END LOOP;
-
-    WHEN '/client/tariff' THEN
+    WHEN '/client/tariff' THEN
 
       IF pPayload IS NULL THEN
         PERFORM JsonIsEmpty();
@@ -2339,78 +2015,6 @@ BEGIN
         END LOOP;
       END LOOP;
 
-    WHEN '/card/type' THEN
-
-      FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb)
-      LOOP
-        FOR e IN EXECUTE format('SELECT %s FROM api.type($1)', JsonbToFields(r.fields, GetColumns('type', 'api'))) USING GetEssence('card')
-        LOOP
-          RETURN NEXT row_to_json(e);
-        END LOOP;
-      END LOOP;
-
-    WHEN '/card/method' THEN
-
-      IF pPayload IS NULL THEN
-        PERFORM JsonIsEmpty();
-      END IF;
-
-      arKeys := array_cat(arKeys, ARRAY['id']);
-      PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric)
-        LOOP
-          FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_card(r.id) ORDER BY id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric)
-        LOOP
-          FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_card(r.id) ORDER BY id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
-    WHEN '/card/count' THEN
-
-      IF pPayload IS NOT NULL THEN
-        arKeys := array_cat(arKeys, ARRAY['search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-        PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-      ELSE
-        pPayload := '{}';
-      END IF;
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-        LOOP
-          FOR e IN SELECT count(*) FROM api.list_card(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-        LOOP
-          FOR e IN SELECT count(*) FROM api.list_card(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
     WHEN '/card/add' THEN
 
       IF pPayload IS NULL THEN
@@ -2461,126 +2065,6 @@ BEGIN
 
       END IF;
 
-    WHEN '/card/get' THEN
-
-      IF pPayload IS NULL THEN
-        PERFORM JsonIsEmpty();
-      END IF;
-
-      arKeys := array_cat(arKeys, ARRAY['id', 'fields']);
-      PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric, fields jsonb)
-        LOOP
-          FOR e IN EXECUTE format('SELECT %s FROM api.get_card($1)', JsonbToFields(r.fields, GetColumns('card', 'api'))) USING r.id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric, fields jsonb)
-        LOOP
-          FOR e IN EXECUTE format('SELECT %s FROM api.get_card($1)', JsonbToFields(r.fields, GetColumns('card', 'api'))) USING r.id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
-    WHEN '/card/list' THEN
-
-      IF pPayload IS NOT NULL THEN
-        arKeys := array_cat(arKeys, ARRAY['fields', 'search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-        PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-      ELSE
-        pPayload := '{}';
-      END IF;
-
-      FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb, search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-      LOOP
-        FOR e IN EXECUTE format('SELECT %s FROM api.list_card($1, $2, $3, $4, $5)', JsonbToFields(r.fields, GetColumns('card', 'api'))) USING r.search, r.filter, r.reclimit, r.recoffset, r.orderby
-        LOOP
-          RETURN NEXT row_to_json(e);
-        END LOOP;
-      END LOOP;
-
-    WHEN '/charge_point/type' THEN
-
-      FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb)
-      LOOP
-        FOR e IN EXECUTE format('SELECT %s FROM api.type($1)', JsonbToFields(r.fields, GetColumns('type', 'api'))) USING GetEssence('charge_point')
-        LOOP
-          RETURN NEXT row_to_json(e);
-        END LOOP;
-      END LOOP;
-
-    WHEN '/charge_point/method' THEN
-
-      IF pPayload IS NULL THEN
-        PERFORM JsonIsEmpty();
-      END IF;
-
-      arKeys := array_cat(arKeys, ARRAY['id']);
-      PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric)
-        LOOP
-          FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_charge_point(r.id) ORDER BY id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric)
-        LOOP
-          FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_charge_point(r.id) ORDER BY id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
-    WHEN '/charge_point/count' THEN
-
-      IF pPayload IS NOT NULL THEN
-        arKeys := array_cat(arKeys, ARRAY['search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-        PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-      ELSE
-        pPayload := '{}';
-      END IF;
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-        LOOP
-          FOR e IN SELECT count(*) FROM api.list_charge_point(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-        LOOP
-          FOR e IN SELECT count(*) FROM api.list_charge_point(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
     WHEN '/charge_point/add' THEN
 
       IF pPayload IS NULL THEN
@@ -2631,54 +2115,6 @@ BEGIN
 
       END IF;
 
-    WHEN '/charge_point/get' THEN
-
-      IF pPayload IS NULL THEN
-        PERFORM JsonIsEmpty();
-      END IF;
-
-      arKeys := array_cat(arKeys, ARRAY['id', 'fields']);
-      PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric, fields jsonb)
-        LOOP
-          FOR e IN EXECUTE format('SELECT %s FROM api.get_charge_point($1)', JsonbToFields(r.fields, GetColumns('charge_point', 'api'))) USING r.id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric, fields jsonb)
-        LOOP
-          FOR e IN EXECUTE format('SELECT %s FROM api.get_charge_point($1)', JsonbToFields(r.fields, GetColumns('charge_point', 'api'))) USING r.id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
-    WHEN '/charge_point/list' THEN
-
-      IF pPayload IS NOT NULL THEN
-        arKeys := array_cat(arKeys, ARRAY['fields', 'search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-        PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-      ELSE
-        pPayload := '{}';
-      END IF;
-
-      FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb, search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-      LOOP
-        FOR e IN EXECUTE format('SELECT %s FROM api.list_charge_point($1, $2, $3, $4, $5)', JsonbToFields(r.fields, GetColumns('charge_point', 'api'))) USING r.search, r.filter, r.reclimit, r.recoffset, r.orderby
-        LOOP
-          RETURN NEXT row_to_json(e);
-        END LOOP;
-      END LOOP;
-
     WHEN '/charge_point/status/get' THEN
 
       IF pPayload IS NULL THEN
@@ -2823,90 +2259,18 @@ BEGIN
         END LOOP;
       END LOOP;
 
-    WHEN '/invoice/type' THEN
-
-      FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb)
-      LOOP
-        FOR e IN EXECUTE format('SELECT %s FROM api.type($1)', JsonbToFields(r.fields, GetColumns('type', 'api'))) USING GetEssence('invoice')
-        LOOP
-          RETURN NEXT row_to_json(e);
-        END LOOP;
-      END LOOP;
-
-    WHEN '/invoice/method' THEN
+    WHEN '/invoice/add' THEN
 
       IF pPayload IS NULL THEN
         PERFORM JsonIsEmpty();
       END IF;
 
-      arKeys := array_cat(arKeys, ARRAY['id']);
+      arKeys := array_cat(arKeys, ARRAY['parent', 'type', 'code', 'transaction', 'description']);
       PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
 
       IF jsonb_typeof(pPayload) = 'array' THEN
 
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric)
-        LOOP
-          FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_invoice(r.id) ORDER BY id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric)
-        LOOP
-          FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_invoice(r.id) ORDER BY id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
-    WHEN '/invoice/count' THEN
-
-      IF pPayload IS NOT NULL THEN
-        arKeys := array_cat(arKeys, ARRAY['search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-        PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-      ELSE
-        pPayload := '{}';
-      END IF;
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-        LOOP
-          FOR e IN SELECT count(*) FROM api.list_invoice(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-        LOOP
-          FOR e IN SELECT count(*) FROM api.list_invoice(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
-    WHEN '/invoice/add' THEN
-
-      IF pPayload IS NULL THEN
-        PERFORM JsonIsEmpty();
-      END IF;
-
-      arKeys := array_cat(arKeys, ARRAY['parent', 'type', 'code', 'transaction', 'description']);
-      PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(parent numeric, type varchar, code varchar, transaction numeric, description text)
+        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(parent numeric, type varchar, code varchar, transaction numeric, description text)
         LOOP
           RETURN NEXT row_to_json(api.add_invoice(r.parent, r.type, r.code, r.transaction, r.description));
         END LOOP;
@@ -2945,126 +2309,6 @@ BEGIN
 
       END IF;
 
-    WHEN '/invoice/get' THEN
-
-      IF pPayload IS NULL THEN
-        PERFORM JsonIsEmpty();
-      END IF;
-
-      arKeys := array_cat(arKeys, ARRAY['id', 'fields']);
-      PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric, fields jsonb)
-        LOOP
-          FOR e IN EXECUTE format('SELECT %s FROM api.get_invoice($1)', JsonbToFields(r.fields, GetColumns('invoice', 'api'))) USING r.id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric, fields jsonb)
-        LOOP
-          FOR e IN EXECUTE format('SELECT %s FROM api.get_invoice($1)', JsonbToFields(r.fields, GetColumns('invoice', 'api'))) USING r.id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
-    WHEN '/invoice/list' THEN
-
-      IF pPayload IS NOT NULL THEN
-        arKeys := array_cat(arKeys, ARRAY['fields', 'search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-        PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-      ELSE
-        pPayload := '{}';
-      END IF;
-
-      FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb, search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-      LOOP
-        FOR e IN EXECUTE format('SELECT %s FROM api.list_invoice($1, $2, $3, $4, $5)', JsonbToFields(r.fields, GetColumns('invoice', 'api'))) USING r.search, r.filter, r.reclimit, r.recoffset, r.orderby
-        LOOP
-          RETURN NEXT row_to_json(e);
-        END LOOP;
-      END LOOP;
-
-    WHEN '/order/type' THEN
-
-      FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb)
-      LOOP
-        FOR e IN EXECUTE format('SELECT %s FROM api.type($1)', JsonbToFields(r.fields, GetColumns('type', 'api'))) USING GetEssence('order')
-        LOOP
-          RETURN NEXT row_to_json(e);
-        END LOOP;
-      END LOOP;
-
-    WHEN '/order/method' THEN
-
-      IF pPayload IS NULL THEN
-        PERFORM JsonIsEmpty();
-      END IF;
-
-      arKeys := array_cat(arKeys, ARRAY['id']);
-      PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric)
-        LOOP
-          FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_order(r.id) ORDER BY id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric)
-        LOOP
-          FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_order(r.id) ORDER BY id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
-    WHEN '/order/count' THEN
-
-      IF pPayload IS NOT NULL THEN
-        arKeys := array_cat(arKeys, ARRAY['search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-        PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-      ELSE
-        pPayload := '{}';
-      END IF;
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-        LOOP
-          FOR e IN SELECT count(*) FROM api.list_order(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-        LOOP
-          FOR e IN SELECT count(*) FROM api.list_order(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
     WHEN '/order/add' THEN
 
       IF pPayload IS NULL THEN
@@ -3115,126 +2359,6 @@ BEGIN
 
       END IF;
 
-    WHEN '/order/get' THEN
-
-      IF pPayload IS NULL THEN
-        PERFORM JsonIsEmpty();
-      END IF;
-
-      arKeys := array_cat(arKeys, ARRAY['id', 'fields']);
-      PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric, fields jsonb)
-        LOOP
-          FOR e IN EXECUTE format('SELECT %s FROM api.get_order($1)', JsonbToFields(r.fields, GetColumns('order', 'api'))) USING r.id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric, fields jsonb)
-        LOOP
-          FOR e IN EXECUTE format('SELECT %s FROM api.get_order($1)', JsonbToFields(r.fields, GetColumns('order', 'api'))) USING r.id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
-    WHEN '/order/list' THEN
-
-      IF pPayload IS NOT NULL THEN
-        arKeys := array_cat(arKeys, ARRAY['fields', 'search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-        PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-      ELSE
-        pPayload := '{}';
-      END IF;
-
-      FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb, search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-      LOOP
-        FOR e IN EXECUTE format('SELECT %s FROM api.list_order($1, $2, $3, $4, $5)', JsonbToFields(r.fields, GetColumns('order', 'api'))) USING r.search, r.filter, r.reclimit, r.recoffset, r.orderby
-        LOOP
-          RETURN NEXT row_to_json(e);
-        END LOOP;
-      END LOOP;
-
-    WHEN '/tariff/type' THEN
-
-      FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb)
-      LOOP
-        FOR e IN EXECUTE format('SELECT %s FROM api.type($1)', JsonbToFields(r.fields, GetColumns('type', 'api'))) USING GetEssence('tariff')
-        LOOP
-          RETURN NEXT row_to_json(e);
-        END LOOP;
-      END LOOP;
-
-    WHEN '/tariff/method' THEN
-
-      IF pPayload IS NULL THEN
-        PERFORM JsonIsEmpty();
-      END IF;
-
-      arKeys := array_cat(arKeys, ARRAY['id']);
-      PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric)
-        LOOP
-          FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_tariff(r.id) ORDER BY id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric)
-        LOOP
-          FOR e IN SELECT r.id, api.get_method(GetObjectClass(r.id), GetObjectState(r.id)) as method FROM api.get_tariff(r.id) ORDER BY id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
-    WHEN '/tariff/count' THEN
-
-      IF pPayload IS NOT NULL THEN
-        arKeys := array_cat(arKeys, ARRAY['search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-        PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-      ELSE
-        pPayload := '{}';
-      END IF;
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-        LOOP
-          FOR e IN SELECT count(*) FROM api.list_tariff(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-        LOOP
-          FOR e IN SELECT count(*) FROM api.list_tariff(r.search, r.filter, r.reclimit, r.recoffset, r.orderby)
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
     WHEN '/tariff/add' THEN
 
       IF pPayload IS NULL THEN
@@ -3285,54 +2409,6 @@ BEGIN
 
       END IF;
 
-    WHEN '/tariff/get' THEN
-
-      IF pPayload IS NULL THEN
-        PERFORM JsonIsEmpty();
-      END IF;
-
-      arKeys := array_cat(arKeys, ARRAY['id', 'fields']);
-      PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-
-      IF jsonb_typeof(pPayload) = 'array' THEN
-
-        FOR r IN SELECT * FROM jsonb_to_recordset(pPayload) AS x(id numeric, fields jsonb)
-        LOOP
-          FOR e IN EXECUTE format('SELECT %s FROM api.get_tariff($1)', JsonbToFields(r.fields, GetColumns('tariff', 'api'))) USING r.id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      ELSE
-
-        FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(id numeric, fields jsonb)
-        LOOP
-          FOR e IN EXECUTE format('SELECT %s FROM api.get_tariff($1)', JsonbToFields(r.fields, GetColumns('tariff', 'api'))) USING r.id
-          LOOP
-            RETURN NEXT row_to_json(e);
-          END LOOP;
-        END LOOP;
-
-      END IF;
-
-    WHEN '/tariff/list' THEN
-
-      IF pPayload IS NOT NULL THEN
-        arKeys := array_cat(arKeys, ARRAY['fields', 'search', 'filter', 'reclimit', 'recoffset', 'orderby']);
-        PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
-      ELSE
-        pPayload := '{}';
-      END IF;
-
-      FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb, search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
-      LOOP
-        FOR e IN EXECUTE format('SELECT %s FROM api.list_tariff($1, $2, $3, $4, $5)', JsonbToFields(r.fields, GetColumns('tariff', 'api'))) USING r.search, r.filter, r.reclimit, r.recoffset, r.orderby
-        LOOP
-          RETURN NEXT row_to_json(e);
-        END LOOP;
-      END LOOP;
-
     WHEN '/ocpp/log' THEN
 
       IF pPayload IS NOT NULL THEN
@@ -3,7 +3,7 @@
 --------------------------------------------------------------------------------
 
 CREATE TABLE api.log (
-    id			    numeric PRIMARY KEY DEFAULT NEXTVAL('SEQUENCE_API_LOG'),
+    id			    numeric NOT NULL DEFAULT NEXTVAL('SEQUENCE_API_LOG'),
     datetime		timestamp DEFAULT clock_timestamp() NOT NULL,
     username		text NOT NULL DEFAULT session_user,
     api_session		char(40),
@@ -12,8 +12,9 @@ CREATE TABLE api.log (
     json		    jsonb,
     eventid		    numeric(12),
     runtime		    interval,
+    PRIMARY KEY (id, datetime),
     CONSTRAINT fk_api_log_eventid FOREIGN KEY (eventid) REFERENCES db.log(id)
-);
+) PARTITION BY RANGE (datetime);
 
 COMMENT ON TABLE api.log IS 'Лог API.';
 
@@ -26,12 +27,16 @@ COMMENT ON COLUMN api.log.route IS 'Путь';
 COMMENT ON COLUMN api.log.json IS 'JSON';
 COMMENT ON COLUMN api.log.runtime IS 'Время выполнения запроса';
 
-CREATE INDEX ON api.log (datetime);
+CREATE INDEX ON api.log USING brin (datetime);
 --CREATE INDEX ON api.log (username);
 --CREATE INDEX ON api.log (api_session);
 CREATE INDEX ON api.log (api_username);
 CREATE INDEX ON api.log (eventid);
 
+CREATE TABLE api.log_default PARTITION OF api.log DEFAULT;
+
+SELECT CheckPartitions('api.log', 'day');
+
 --------------------------------------------------------------------------------
 -- AddApiLog -------------------------------------------------------------------
 --------------------------------------------------------------------------------
@@ -126,6 +131,7 @@ CREATE OR REPLACE FUNCTION ClearApiLog (
 ) RETURNS	void
 AS $$
 BEGIN
+  PERFORM DropPartitions('api.log', pDateTime);
   DELETE FROM api.log WHERE datetime < pDateTime;
 END;
 $$ LANGUAGE plpgsql
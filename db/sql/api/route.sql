@@ -0,0 +1,191 @@
+--------------------------------------------------------------------------------
+-- api.route -------------------------------------------------------------------
+--------------------------------------------------------------------------------
+
+CREATE TABLE api.route (
+    path        text PRIMARY KEY,
+    kind        text NOT NULL,
+    entity      text,
+    handler     text,
+    CONSTRAINT ch_route_path CHECK (path = lower(path)),
+    CONSTRAINT ch_route_kind CHECK (kind IN ('type', 'method', 'count', 'get', 'list', 'function')),
+    CONSTRAINT ch_route_target CHECK (CASE kind WHEN 'function' THEN handler IS NOT NULL ELSE entity IS NOT NULL END)
+);
+
+COMMENT ON TABLE api.route IS 'Реестр маршрутов REST API.';
+
+COMMENT ON COLUMN api.route.path IS 'Путь (в нижнем регистре)';
+COMMENT ON COLUMN api.route.kind IS 'Вид: type, method, count, get, list - типовой запрос к сущности; function - своя функция';
+COMMENT ON COLUMN api.route.entity IS 'Сущность: api.get_<entity>, api.list_<entity>';
+COMMENT ON COLUMN api.route.handler IS 'Функция (pPath text, pPayload jsonb) RETURNS SETOF json';
+
+--------------------------------------------------------------------------------
+-- api.route_fetch -------------------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Выполняет запрос по маршруту из реестра.
+ * @param {api.route} pRoute - Маршрут
+ * @param {text} pPath - Путь
+ * @param {jsonb} pPayload - Данные
+ * @return {SETOF json} - Записи в JSON
+ */
+CREATE OR REPLACE FUNCTION api.route_fetch (
+  pRoute    api.route,
+  pPath     text,
+  pPayload  jsonb DEFAULT null
+) RETURNS   SETOF json
+AS $$
+DECLARE
+  r         record;
+  e         record;
+
+  arKeys    text[];
+BEGIN
+  CASE pRoute.kind
+  WHEN 'function' THEN
+
+    RETURN QUERY EXECUTE format('SELECT * FROM %s($1, $2)', pRoute.handler) USING pPath, pPayload;
+
+  WHEN 'type' THEN
+
+    FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb)
+    LOOP
+      FOR e IN EXECUTE format('SELECT %s FROM api.type($1)', JsonbToFields(r.fields, GetColumns('type', 'api'))) USING GetEssence(pRoute.entity)
+      LOOP
+        RETURN NEXT row_to_json(e);
+      END LOOP;
+    END LOOP;
+
+  WHEN 'method' THEN
+
+    IF pPayload IS NULL THEN
+      PERFORM JsonIsEmpty();
+    END IF;
+
+    arKeys := array_cat(arKeys, ARRAY['id']);
+    PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
+
+    FOR r IN SELECT * FROM jsonb_to_recordset(CASE jsonb_typeof(pPayload) WHEN 'array' THEN pPayload ELSE jsonb_build_array(pPayload) END) AS x(id numeric)
+    LOOP
+      FOR e IN EXECUTE format('SELECT $1 AS id, api.get_method(GetObjectClass($1), GetObjectState($1)) as method FROM api.%I($1) ORDER BY id', 'get_' || pRoute.entity) USING r.id
+      LOOP
+        RETURN NEXT row_to_json(e);
+      END LOOP;
+    END LOOP;
+
+  WHEN 'count' THEN
+
+    IF pPayload IS NOT NULL THEN
+      arKeys := array_cat(arKeys, ARRAY['search', 'filter', 'reclimit', 'recoffset', 'orderby']);
+      PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
+    ELSE
+      pPayload := '{}';
+    END IF;
+
+    FOR r IN SELECT * FROM jsonb_to_recordset(CASE jsonb_typeof(pPayload) WHEN 'array' THEN pPayload ELSE jsonb_build_array(pPayload) END) AS x(search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
+    LOOP
+      FOR e IN EXECUTE format('SELECT count(*) FROM api.%I($1, $2, $3, $4, $5)', 'list_' || pRoute.entity) USING r.search, r.filter, r.reclimit, r.recoffset, r.orderby
+      LOOP
+        RETURN NEXT row_to_json(e);
+      END LOOP;
+    END LOOP;
+
+  WHEN 'get' THEN
+
+    IF pPayload IS NULL THEN
+      PERFORM JsonIsEmpty();
+    END IF;
+
+    arKeys := array_cat(arKeys, ARRAY['id', 'fields']);
+    PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
+
+    FOR r IN SELECT * FROM jsonb_to_recordset(CASE jsonb_typeof(pPayload) WHEN 'array' THEN pPayload ELSE jsonb_build_array(pPayload) END) AS x(id numeric, fields jsonb)
+    LOOP
+      FOR e IN EXECUTE format('SELECT %s FROM api.%I($1)', JsonbToFields(r.fields, GetColumns(pRoute.entity, 'api')), 'get_' || pRoute.entity) USING r.id
+      LOOP
+        RETURN NEXT row_to_json(e);
+      END LOOP;
+    END LOOP;
+
+  WHEN 'list' THEN
+
+    IF pPayload IS NOT NULL THEN
+      arKeys := array_cat(arKeys, ARRAY['fields', 'search', 'filter', 'reclimit', 'recoffset', 'orderby']);
+      PERFORM CheckJsonbKeys(pPath, arKeys, pPayload);
+    ELSE
+      pPayload := '{}';
+    END IF;
+
+    FOR r IN SELECT * FROM jsonb_to_record(pPayload) AS x(fields jsonb, search jsonb, filter jsonb, reclimit integer, recoffset integer, orderby jsonb)
+    LOOP
+      FOR e IN EXECUTE format('SELECT %s FROM api.%I($1, $2, $3, $4, $5)', JsonbToFields(r.fields, GetColumns(pRoute.entity, 'api')), 'list_' || pRoute.entity) USING r.search, r.filter, r.reclimit, r.recoffset, r.orderby
+      LOOP
+        RETURN NEXT row_to_json(e);
+      END LOOP;
+    END LOOP;
+
+  END CASE;
+
+  RETURN;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+--------------------------------------------------------------------------------
+-- api.charge_point_access -----------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Возвращает идентификаторы зарядных станций, доступных текущему пользователю: на чтение (/charge_point/access)
+ *   или на изменение (/charge_point/control - отправка команд станции).
+ * @param {text} pPath - Путь
+ * @param {jsonb} pPayload - Данные: {"identity": text} - проверить одну станцию
+ * @return {SETOF json} - Записи в JSON: {"identity": text}
+ */
+CREATE OR REPLACE FUNCTION api.charge_point_access (
+  pPath     text,
+  pPayload  jsonb DEFAULT null
+) RETURNS   SETOF json
+AS $$
+DECLARE
+  r         record;
+  vIdentity text;
+  vMask     bit(3);
+BEGIN
+  vMask := CASE WHEN pPath = '/charge_point/control' THEN B'010' ELSE B'100' END;
+
+  IF pPayload IS NOT NULL THEN
+    PERFORM CheckJsonbKeys(pPath, ARRAY['identity'], pPayload);
+    vIdentity := pPayload->>'identity';
+  END IF;
+
+  FOR r IN
+    SELECT rf.code AS identity
+      FROM db.charge_point p INNER JOIN db.reference rf ON rf.id = p.reference
+     WHERE (vIdentity IS NULL OR rf.code = vIdentity)
+       AND CheckObjectAccess(rf.object, vMask)
+  LOOP
+    RETURN NEXT row_to_json(r);
+  END LOOP;
+
+  RETURN;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+--------------------------------------------------------------------------------
+-- ROUTES ----------------------------------------------------------------------
+--------------------------------------------------------------------------------
+
+INSERT INTO api.route (path, kind, entity)
+SELECT '/' || entity || '/' || kind, kind, entity
+  FROM unnest(ARRAY['address', 'client', 'card', 'charge_point', 'invoice', 'order', 'tariff']) AS entity,
+       unnest(ARRAY['type', 'method', 'count', 'get', 'list']) AS kind;
+
+INSERT INTO api.route (path, kind, entity)
+SELECT '/calendar/' || kind, kind, 'calendar'
+  FROM unnest(ARRAY['method', 'count', 'get']) AS kind;
+
+INSERT INTO api.route (path, kind, handler) VALUES ('/charge_point/access', 'function', 'api.charge_point_access');
+INSERT INTO api.route (path, kind, handler) VALUES ('/charge_point/control', 'function', 'api.charge_point_access');
@@ -14,6 +14,7 @@ CREATE TABLE db.charge_point (
     meterSerialNumber   varchar(25),
     iccid               varchar(20),
     imsi                varchar(20),
+    lastSeen            timestamp,
     CONSTRAINT fk_charge_point_reference FOREIGN KEY (reference) REFERENCES db.reference(id),
     CONSTRAINT fk_charge_point_client FOREIGN KEY (client) REFERENCES db.client(id)
 );
@@ -33,6 +34,7 @@ COMMENT ON COLUMN db.charge_point.boxSerialNumber IS 'Optional. This contains a
 COMMENT ON COLUMN db.charge_point.meterSerialNumber IS 'Optional. This contains the serial number of the main electrical meter of the Charge Point.';
 COMMENT ON COLUMN db.charge_point.iccid IS 'Optional. This contains the ICCID of the modem’s SIM card.';
 COMMENT ON COLUMN db.charge_point.imsi IS 'Optional. This contains the IMSI of the modem’s SIM card.';
+COMMENT ON COLUMN db.charge_point.lastSeen IS 'Дата и время последнего Heartbeat.';
 
 --------------------------------------------------------------------------------
 
@@ -500,6 +502,24 @@ CREATE INDEX ON db.transaction (chargePoint);
 CREATE INDEX ON db.transaction (connectorId);
 CREATE INDEX ON db.transaction (card, chargePoint, connectorId);
 
+--------------------------------------------------------------------------------
+
+CREATE OR REPLACE FUNCTION db.ft_transaction_notify()
+RETURNS trigger AS $$
+BEGIN
+  -- Начало и конец транзакции меняют статус карты (ConcurrentTx), см. ocpp.GetIdTagStatus.
+  PERFORM pg_notify('idtag', code) FROM db.card WHERE id = NEW.card;
+  RETURN NULL;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+CREATE TRIGGER t_transaction_notify
+  AFTER INSERT OR UPDATE ON db.transaction
+  FOR EACH ROW
+  EXECUTE PROCEDURE db.ft_transaction_notify();
+
 --------------------------------------------------------------------------------
 -- FUNCTION StartTransaction ---------------------------------------------------
 --------------------------------------------------------------------------------
@@ -575,16 +595,17 @@ GRANT SELECT ON Transaction TO administrator;
 --------------------------------------------------------------------------------
 
 CREATE TABLE db.meter_value (
-    id			    numeric(12) PRIMARY KEY DEFAULT NEXTVAL('SEQUENCE_OCPP_STATUS'),
+    id			    numeric(12) NOT NULL DEFAULT NEXTVAL('SEQUENCE_OCPP_STATUS'),
     chargePoint		numeric(12) NOT NULL,
     connectorId		integer NOT NULL,
     transactionId	numeric(12),
     meterValue		json NOT NULL,
     validFromDate	timestamp DEFAULT NOW() NOT NULL,
     validToDate		timestamp DEFAULT TO_DATE('4433-12-31', 'YYYY-MM-DD') NOT NULL,
+    PRIMARY KEY (id, validFromDate),
     CONSTRAINT fk_meter_value_chargePoint FOREIGN KEY (chargePoint) REFERENCES db.charge_point(id),
     CONSTRAINT fk_meter_value_transactionId FOREIGN KEY (transactionId) REFERENCES db.transaction(id)
-);
+) PARTITION BY RANGE (validFromDate);
 
 --------------------------------------------------------------------------------
 
@@ -607,6 +628,14 @@ CREATE INDEX ON db.meter_value (chargePoint, validFromDate, validToDate);
 
 CREATE UNIQUE INDEX ON db.meter_value (chargePoint, connectorId, validFromDate, validToDate);
 
+CREATE INDEX ON db.meter_value USING brin (validFromDate);
+
+--------------------------------------------------------------------------------
+
+CREATE TABLE db.meter_value_default PARTITION OF db.meter_value DEFAULT;
+
+SELECT CheckPartitions('db.meter_value', 'month');
+
 --------------------------------------------------------------------------------
 -- FUNCTION AddMeterValue ------------------------------------------------------
 --------------------------------------------------------------------------------
@@ -677,12 +706,12 @@ GRANT SELECT ON MeterValue TO administrator;
 
 CREATE OR REPLACE VIEW ChargePoint (Id, Reference, Client, ClientCode, Identity,
   Name, Description, Model, Vendor, Version, SerialNumber, BoxSerialNumber,
-  MeterSerialNumber, iccid, imsi
+  MeterSerialNumber, iccid, imsi, LastSeen
 )
 AS
   SELECT p.id, p.reference, p.client, c.code, r.code,
          r.name, r.description, p.model, p.vendor, p.version, p.serialnumber,
-         p.boxserialnumber, p.meterserialnumber, p.iccid, p.imsi
+         p.boxserialnumber, p.meterserialnumber, p.iccid, p.imsi, p.lastseen
     FROM db.charge_point p INNER JOIN db.reference r ON r.id = p.reference
                             LEFT JOIN db.client c ON c.id = p.client;
 
@@ -3,15 +3,16 @@
 --------------------------------------------------------------------------------
 
 CREATE TABLE ocpp.log (
-    id			numeric PRIMARY KEY DEFAULT NEXTVAL('SEQUENCE_OCPP_LOG'),
+    id			numeric NOT NULL DEFAULT NEXTVAL('SEQUENCE_OCPP_LOG'),
     datetime	timestamp DEFAULT clock_timestamp() NOT NULL,
     username	text NOT NULL DEFAULT session_user,
     identity	text NOT NULL,
     action		text NOT NULL,
     request		jsonb,
     response	jsonb,
-    runtime		interval
-);
+    runtime		interval,
+    PRIMARY KEY (id, datetime)
+) PARTITION BY RANGE (datetime);
 
 COMMENT ON TABLE ocpp.log IS 'Лог OCPP.';
 
@@ -26,7 +27,11 @@ COMMENT ON COLUMN ocpp.log.runtime IS 'Время выполнения запр
 
 CREATE INDEX ON ocpp.log (identity);
 CREATE INDEX ON ocpp.log (action);
-CREATE INDEX ON ocpp.log (datetime);
+CREATE INDEX ON ocpp.log USING brin (datetime);
+
+CREATE TABLE ocpp.log_default PARTITION OF ocpp.log DEFAULT;
+
+SELECT CheckPartitions('ocpp.log', 'day');
 
 --------------------------------------------------------------------------------
 -- ocpp.WriteToLog -------------------------------------------------------------
@@ -62,6 +67,7 @@ CREATE OR REPLACE FUNCTION ocpp.ClearLog (
 ) RETURNS	void
 AS $$
 BEGIN
+  PERFORM DropPartitions('ocpp.log', pDateTime);
   DELETE FROM ocpp.log WHERE datetime < pDateTime;
 END;
 $$ LANGUAGE plpgsql
@@ -196,6 +202,70 @@ $$ LANGUAGE plpgsql
    SECURITY DEFINER
    SET search_path = kernel, pg_temp;
 
+--------------------------------------------------------------------------------
+-- ocpp.SetLastSeen ------------------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Сохраняет время последнего Heartbeat зарядных станций (ответ на Heartbeat дан сервером приложений) и выполняет
+ * действие Heartbeat (как ocpp.Heartbeat) в сессии станции. Ошибка действия одной станции не отменяет остальные, она
+ * записывается в ocpp.log.
+ * @param {text[]} pIdentity - Идентификаторы зарядных станций
+ * @param {double precision[]} pEpoch - Время в секундах (Unix time)
+ * @param {text[]} pSession - Сессии зарядных станций (подтверждённые базой данных)
+ * @return {integer} - Количество обновлённых станций
+ */
+CREATE OR REPLACE FUNCTION ocpp.SetLastSeen (
+  pIdentity	text[],
+  pEpoch	double precision[],
+  pSession	text[]
+) RETURNS	integer
+AS $$
+DECLARE
+  e		record;
+
+  nCount	integer;
+  nAction	numeric;
+
+  vError	text;
+BEGIN
+  nCount := 0;
+  nAction := GetAction('Heartbeat');
+
+  FOR e IN
+    UPDATE db.charge_point p
+       SET lastseen = greatest(p.lastseen, t.lastseen)
+      FROM db.reference r,
+           (SELECT u.identity, to_timestamp(u.epoch)::timestamp AS lastseen, u.session
+              FROM unnest(pIdentity, pEpoch, pSession) AS u(identity, epoch, session)) t
+     WHERE r.id = p.reference
+       AND r.code = t.identity
+    RETURNING p.id, t.identity, t.session
+  LOOP
+    BEGIN
+      IF SessionIn(e.session) IS NULL THEN
+        PERFORM AuthenticateError(GetErrorMessage());
+      END IF;
+
+      PERFORM ExecuteObjectAction(e.id, nAction, null);
+    EXCEPTION
+    WHEN others THEN
+      GET STACKED DIAGNOSTICS vError = MESSAGE_TEXT;
+      PERFORM ocpp.WriteToLog(e.identity, 'Heartbeat', '{}'::jsonb, jsonb_build_object('error', vError));
+    END;
+
+    nCount := nCount + 1;
+  END LOOP;
+
+  -- Не оставлять соединению из пула сессию последней станции.
+  PERFORM SetSessionKey(null);
+  PERFORM SetUserId(null);
+
+  RETURN nCount;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
 --------------------------------------------------------------------------------
 -- ocpp.Authorize --------------------------------------------------------------
 --------------------------------------------------------------------------------
@@ -503,6 +573,59 @@ $$ LANGUAGE plpgsql
    SECURITY DEFINER
    SET search_path = kernel, pg_temp;
 
+--------------------------------------------------------------------------------
+-- ocpp.AddMeterValues ---------------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Сохраняет пакет MeterValues, принятых сервером приложений.
+ * Ошибка в одном запросе не отменяет остальные, она записывается в ocpp.log.
+ * @param {jsonb} pValues - Массив: [{"identity": text, "epoch": double precision, "request": jsonb}, ...]
+ * @param {boolean} pLog - Записать запросы в ocpp.log (false - запись делает сервер приложений)
+ * @return {integer} - Количество сохранённых значений
+ */
+CREATE OR REPLACE FUNCTION ocpp.AddMeterValues (
+  pValues       jsonb,
+  pLog          boolean DEFAULT true
+) RETURNS       integer
+AS $$
+DECLARE
+  r             record;
+
+  nCount        integer;
+  nChargePoint  numeric;
+
+  vError        text;
+BEGIN
+  nCount := 0;
+
+  FOR r IN SELECT * FROM jsonb_to_recordset(pValues) AS x(identity text, epoch double precision, request jsonb)
+  LOOP
+    BEGIN
+      nChargePoint := GetChargePoint(r.identity);
+
+      IF nChargePoint IS NOT NULL THEN
+        PERFORM AddMeterValue(nChargePoint, (r.request->>'connectorId')::integer, (r.request->>'transactionId')::numeric,
+          (r.request->'meterValue')::json, to_timestamp(r.epoch)::timestamp);
+
+        nCount := nCount + 1;
+      END IF;
+
+      IF pLog THEN
+        PERFORM ocpp.WriteToLog(r.identity, 'MeterValues', r.request, '{}'::jsonb);
+      END IF;
+    EXCEPTION
+    WHEN others THEN
+      GET STACKED DIAGNOSTICS vError = MESSAGE_TEXT;
+      PERFORM ocpp.WriteToLog(r.identity, 'MeterValues', r.request, jsonb_build_object('error', vError));
+    END;
+  END LOOP;
+
+  RETURN nCount;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
 --------------------------------------------------------------------------------
 -- ocpp.DataTransfer -----------------------------------------------------------
 --------------------------------------------------------------------------------
@@ -1,2 +1,3 @@
 CREATE SCHEMA IF NOT EXISTS ocpp AUTHORIZATION kernel;
 GRANT USAGE ON SCHEMA ocpp TO ocpp;
+GRANT USAGE ON SCHEMA ocpp TO daemon;
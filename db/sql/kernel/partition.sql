@@ -0,0 +1,211 @@
+--------------------------------------------------------------------------------
+-- PARTITION -------------------------------------------------------------------
+--------------------------------------------------------------------------------
+
+--------------------------------------------------------------------------------
+-- FUNCTION PartitionUpperBound ------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Возвращает верхнюю границу секции (NULL для секции по умолчанию).
+ * @param {oid} pPartition - Секция
+ * @return {timestamp}
+ */
+CREATE OR REPLACE FUNCTION PartitionUpperBound (
+  pPartition    oid
+) RETURNS       timestamp
+AS $$
+  SELECT substring(pg_get_expr(relpartbound, oid) FROM 'TO \(''([^'']+)''\)')::timestamp
+    FROM pg_class
+   WHERE oid = pPartition;
+$$ LANGUAGE sql STABLE
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+--------------------------------------------------------------------------------
+-- FUNCTION PartitionLowerBound ------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Возвращает нижнюю границу секции ('-infinity' для MINVALUE, NULL для секции по умолчанию).
+ * @param {oid} pPartition - Секция
+ * @return {timestamp}
+ */
+CREATE OR REPLACE FUNCTION PartitionLowerBound (
+  pPartition    oid
+) RETURNS       timestamp
+AS $$
+  SELECT CASE
+         WHEN pg_get_expr(relpartbound, oid) LIKE 'FOR VALUES FROM (MINVALUE)%' THEN '-infinity'::timestamp
+         ELSE substring(pg_get_expr(relpartbound, oid) FROM 'FROM \(''([^'']+)''\)')::timestamp
+         END
+    FROM pg_class
+   WHERE oid = pPartition;
+$$ LANGUAGE sql STABLE
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+--------------------------------------------------------------------------------
+-- FUNCTION CreatePartition ----------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Создаёт секцию таблицы на период [pFrom, pFrom + pInterval).
+ * Строки этого периода, попавшие в секцию по умолчанию, переносятся в новую секцию.
+ * @param {text} pTable - Секционированная таблица (schema.name)
+ * @param {timestamp} pFrom - Начало периода
+ * @param {interval} pInterval - Длина периода ('1 day' или '1 month')
+ * @return {text} - Имя созданной секции или NULL если период уже покрыт другой секцией
+ */
+CREATE OR REPLACE FUNCTION CreatePartition (
+  pTable        text,
+  pFrom         timestamp,
+  pInterval     interval
+) RETURNS       text
+AS $$
+DECLARE
+  nParent       oid;
+
+  vSchema       text;
+  vName         text;
+  vColumn       text;
+  vPartition    text;
+  vDefault      text;
+
+  dtTo          timestamp;
+BEGIN
+  nParent := pTable::regclass;
+
+  SELECT n.nspname, c.relname INTO vSchema, vName
+    FROM pg_class c INNER JOIN pg_namespace n ON n.oid = c.relnamespace
+   WHERE c.oid = nParent;
+
+  SELECT a.attname INTO vColumn
+    FROM pg_partitioned_table p INNER JOIN pg_attribute a ON a.attrelid = p.partrelid AND a.attnum = p.partattrs[0]
+   WHERE p.partrelid = nParent;
+
+  IF NOT FOUND THEN
+    RAISE EXCEPTION 'Table "%" is not partitioned.', pTable;
+  END IF;
+
+  vPartition := vName || '_p' || to_char(pFrom, 'YYYYMMDD');
+  dtTo := pFrom + pInterval;
+
+  PERFORM FROM pg_inherits
+   WHERE inhparent = nParent
+     AND PartitionLowerBound(inhrelid) < dtTo
+     AND PartitionUpperBound(inhrelid) > pFrom;
+
+  IF FOUND THEN
+    RETURN null;
+  END IF;
+
+  SELECT c.relname INTO vDefault
+    FROM pg_inherits i INNER JOIN pg_class c ON c.oid = i.inhrelid
+   WHERE i.inhparent = nParent
+     AND pg_get_expr(c.relpartbound, c.oid) = 'DEFAULT';
+
+  IF vDefault IS NULL THEN
+    EXECUTE format('CREATE TABLE %I.%I PARTITION OF %I.%I FOR VALUES FROM (%L) TO (%L)',
+      vSchema, vPartition, vSchema, vName, pFrom, dtTo);
+  ELSE
+    -- Секция по умолчанию не даст создать секцию, пока в ней есть строки этого периода.
+    EXECUTE format('CREATE TABLE %I.%I (LIKE %I.%I INCLUDING DEFAULTS INCLUDING CONSTRAINTS)',
+      vSchema, vPartition, vSchema, vName);
+
+    EXECUTE format('WITH moved AS (DELETE FROM %I.%I WHERE %I >= %L AND %I < %L RETURNING *) INSERT INTO %I.%I SELECT * FROM moved',
+      vSchema, vDefault, vColumn, pFrom, vColumn, dtTo, vSchema, vPartition);
+
+    EXECUTE format('ALTER TABLE %I.%I ATTACH PARTITION %I.%I FOR VALUES FROM (%L) TO (%L)',
+      vSchema, vName, vSchema, vPartition, pFrom, dtTo);
+  END IF;
+
+  RETURN vSchema || '.' || vPartition;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+--------------------------------------------------------------------------------
+-- FUNCTION DropPartitions -----------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Удаляет секции таблицы, все строки которых старше pBefore.
+ * @param {text} pTable - Секционированная таблица (schema.name)
+ * @param {timestamp} pBefore - Дата и время
+ * @return {integer} - Количество удалённых секций
+ */
+CREATE OR REPLACE FUNCTION DropPartitions (
+  pTable        text,
+  pBefore       timestamp
+) RETURNS       integer
+AS $$
+DECLARE
+  r             record;
+  nCount        integer DEFAULT 0;
+BEGIN
+  FOR r IN
+    SELECT n.nspname AS schema, c.relname AS name
+      FROM pg_inherits i INNER JOIN pg_class c ON c.oid = i.inhrelid
+                         INNER JOIN pg_namespace n ON n.oid = c.relnamespace
+     WHERE i.inhparent = pTable::regclass
+       AND PartitionUpperBound(c.oid) <= pBefore
+  LOOP
+    EXECUTE format('DROP TABLE %I.%I', r.schema, r.name);
+    nCount := nCount + 1;
+  END LOOP;
+
+  RETURN nCount;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+--------------------------------------------------------------------------------
+-- FUNCTION CheckPartitions ----------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Создаёт секции на текущий и pAhead следующих периодов и удаляет секции старше pKeep периодов.
+ * @param {text} pTable - Секционированная таблица (schema.name)
+ * @param {text} pPeriod - Период секции: day, month
+ * @param {integer} pAhead - Количество периодов, создаваемых заранее
+ * @param {integer} pKeep - Количество хранимых периодов (0 - хранить всё)
+ * @return {json} - {"table", "created", "dropped"}
+ */
+CREATE OR REPLACE FUNCTION CheckPartitions (
+  pTable        text,
+  pPeriod       text,
+  pAhead        integer DEFAULT 3,
+  pKeep         integer DEFAULT 0
+) RETURNS       json
+AS $$
+DECLARE
+  vName         text;
+  arCreated     text[];
+
+  nDropped      integer DEFAULT 0;
+
+  iPeriod       interval;
+  dtFrom        timestamp;
+BEGIN
+  IF pPeriod NOT IN ('day', 'month') THEN
+    RAISE EXCEPTION 'Invalid partition period: "%".', pPeriod;
+  END IF;
+
+  iPeriod := ('1 ' || pPeriod)::interval;
+  dtFrom := date_trunc(pPeriod, localtimestamp);
+
+  FOR i IN 0..greatest(pAhead, 0)
+  LOOP
+    vName := CreatePartition(pTable, dtFrom + iPeriod * i, iPeriod);
+    IF vName IS NOT NULL THEN
+      arCreated := array_append(arCreated, vName);
+    END IF;
+  END LOOP;
+
+  IF coalesce(pKeep, 0) > 0 THEN
+    nDropped := DropPartitions(pTable, dtFrom - iPeriod * (pKeep - 1));
+  END IF;
+
+  RETURN json_build_object('table', pTable, 'created', coalesce(arCreated, '{}'), 'dropped', nDropped);
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
@@ -1710,6 +1710,7 @@ AS $$
 BEGIN
   IF (TG_OP = 'DELETE') THEN
     DELETE FROM db.token WHERE session = OLD.key;
+    PERFORM pg_notify('session', OLD.key);
     RETURN OLD;
   ELSIF (TG_OP = 'UPDATE') THEN
     IF OLD.userid <> NEW.userid THEN
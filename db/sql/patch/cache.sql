@@ -0,0 +1,113 @@
+--------------------------------------------------------------------------------
+-- FUNCTION ft_cache_notify ----------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Сообщает серверу приложений (канал "cache"), что данные области изменились.
+ * Область передаётся аргументом триггера: object, workflow, registry, session.
+ * Одинаковые уведомления в одной транзакции PostgreSQL отправляет один раз.
+ */
+CREATE OR REPLACE FUNCTION db.ft_cache_notify()
+RETURNS trigger AS $$
+BEGIN
+  PERFORM pg_notify('cache', TG_ARGV[0]);
+  RETURN NULL;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+--------------------------------------------------------------------------------
+-- OBJECT ----------------------------------------------------------------------
+--------------------------------------------------------------------------------
+
+CREATE TRIGGER t_object_cache_notify
+  AFTER INSERT OR UPDATE OR DELETE ON db.object
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('object');
+
+--------------------------------------------------------------------------------
+-- WORKFLOW --------------------------------------------------------------------
+--------------------------------------------------------------------------------
+
+CREATE TRIGGER t_essence_cache_notify
+  AFTER INSERT OR UPDATE OR DELETE ON db.essence
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('workflow');
+
+CREATE TRIGGER t_class_tree_cache_notify
+  AFTER INSERT OR UPDATE OR DELETE ON db.class_tree
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('workflow');
+
+CREATE TRIGGER t_type_cache_notify
+  AFTER INSERT OR UPDATE OR DELETE ON db.type
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('workflow');
+
+CREATE TRIGGER t_state_type_cache_notify
+  AFTER INSERT OR UPDATE OR DELETE ON db.state_type
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('workflow');
+
+CREATE TRIGGER t_state_cache_notify
+  AFTER INSERT OR UPDATE OR DELETE ON db.state
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('workflow');
+
+CREATE TRIGGER t_action_cache_notify
+  AFTER INSERT OR UPDATE OR DELETE ON db.action
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('workflow');
+
+CREATE TRIGGER t_method_cache_notify
+  AFTER INSERT OR UPDATE OR DELETE ON db.method
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('workflow');
+
+CREATE TRIGGER t_transition_cache_notify
+  AFTER INSERT OR UPDATE OR DELETE ON db.transition
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('workflow');
+
+CREATE TRIGGER t_language_cache_notify
+  AFTER INSERT OR UPDATE OR DELETE ON db.language
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('workflow');
+
+--------------------------------------------------------------------------------
+-- REGISTRY --------------------------------------------------------------------
+--------------------------------------------------------------------------------
+
+CREATE TRIGGER t_registry_key_cache_notify
+  AFTER INSERT OR UPDATE OR DELETE ON registry.key
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('registry');
+
+CREATE TRIGGER t_registry_value_cache_notify
+  AFTER INSERT OR UPDATE OR DELETE ON registry.value
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('registry');
+
+--------------------------------------------------------------------------------
+-- SESSION ---------------------------------------------------------------------
+--------------------------------------------------------------------------------
+
+CREATE TRIGGER t_session_cache_notify
+  AFTER UPDATE OF userid, lang, area, interface, oper_date ON db.session
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('session');
+
+CREATE TRIGGER t_user_cache_notify
+  AFTER UPDATE OR DELETE ON db.user
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('session');
+
+CREATE TRIGGER t_member_area_cache_notify
+  AFTER INSERT OR UPDATE OR DELETE ON db.member_area
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('session');
+
+CREATE TRIGGER t_member_interface_cache_notify
+  AFTER INSERT OR UPDATE OR DELETE ON db.member_interface
+  FOR EACH STATEMENT
+  EXECUTE PROCEDURE db.ft_cache_notify('session');
@@ -0,0 +1,80 @@
+--------------------------------------------------------------------------------
+-- FUNCTION ft_card_notify -----------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Сообщает серверу приложений (канал "idtag"), что статус карты мог измениться.
+ */
+CREATE OR REPLACE FUNCTION db.ft_card_notify()
+RETURNS trigger AS $$
+BEGIN
+  IF (TG_OP = 'DELETE') THEN
+    PERFORM pg_notify('idtag', OLD.code);
+    RETURN OLD;
+  END IF;
+
+  PERFORM pg_notify('idtag', OLD.code);
+
+  IF NEW.code <> OLD.code THEN
+    PERFORM pg_notify('idtag', NEW.code);
+  END IF;
+
+  RETURN NEW;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+CREATE TRIGGER t_card_notify
+  AFTER UPDATE OR DELETE ON db.card
+  FOR EACH ROW
+  EXECUTE PROCEDURE db.ft_card_notify();
+
+--------------------------------------------------------------------------------
+-- FUNCTION ft_card_state_notify -----------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Смена состояния карты или её клиента: сообщает серверу приложений (канал "idtag") коды карт.
+ */
+CREATE OR REPLACE FUNCTION db.ft_card_state_notify()
+RETURNS trigger AS $$
+DECLARE
+  nObject   numeric;
+BEGIN
+  IF (TG_OP = 'DELETE') THEN
+    nObject := OLD.object;
+  ELSE
+    nObject := NEW.object;
+  END IF;
+
+  PERFORM pg_notify('idtag', code) FROM db.card WHERE id = nObject OR client = nObject;
+
+  RETURN NULL;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+CREATE TRIGGER t_card_state_notify
+  AFTER INSERT OR UPDATE OR DELETE ON db.object_state
+  FOR EACH ROW
+  EXECUTE PROCEDURE db.ft_card_state_notify();
+
+--------------------------------------------------------------------------------
+-- FUNCTION ft_transaction_notify ----------------------------------------------
+--------------------------------------------------------------------------------
+
+CREATE OR REPLACE FUNCTION db.ft_transaction_notify()
+RETURNS trigger AS $$
+BEGIN
+  -- Начало и конец транзакции меняют статус карты (ConcurrentTx), см. ocpp.GetIdTagStatus.
+  PERFORM pg_notify('idtag', code) FROM db.card WHERE id = NEW.card;
+  RETURN NULL;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+CREATE TRIGGER t_transaction_notify
+  AFTER INSERT OR UPDATE ON db.transaction
+  FOR EACH ROW
+  EXECUTE PROCEDURE db.ft_transaction_notify();
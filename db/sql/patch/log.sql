@@ -0,0 +1,167 @@
+DROP FUNCTION IF EXISTS daemon.SignFetch(text, json, text, double precision, text, text, inet, interval);
+
+--------------------------------------------------------------------------------
+-- daemon.SignFetch ------------------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Запрос данных в формате REST JSON API с проверкой подписи методом HMAC-SHA256.
+ * @param {text} pPath - Путь
+ * @param {json} pJson - Данные в JSON
+ * @param {text} pSession - Сессия
+ * @param {double precision} pNonce - Время в миллисекундах
+ * @param {text} pSignature - Подпись
+ * @param {text} pAgent - Агент
+ * @param {inet} pHost - IP адрес
+ * @param {interval} pTimeWindow - Временное окно
+ * @param {boolean} pLog - Записать запрос в api.log (false - запись делает сервер приложений, см. daemon.WriteLog)
+ * @return {SETOF json} - Записи в JSON
+ */
+CREATE OR REPLACE FUNCTION daemon.SignFetch (
+  pPath	        text,
+  pJson         json DEFAULT null,
+  pSession      text DEFAULT null,
+  pNonce        double precision DEFAULT null,
+  pSignature    text DEFAULT null,
+  pAgent        text DEFAULT null,
+  pHost         inet DEFAULT null,
+  pTimeWindow   INTERVAL DEFAULT '5 sec',
+  pLog          boolean DEFAULT true
+) RETURNS       SETOF json
+AS $$
+DECLARE
+  r             record;
+
+  Payload       jsonb;
+
+  nApiId        numeric;
+
+  dtBegin       timestamptz;
+  dtTimeStamp   timestamptz;
+
+  vMessage      text;
+
+  passed        boolean;
+BEGIN
+  IF NULLIF(pPath, '') IS NULL THEN
+    PERFORM RouteIsEmpty();
+  END IF;
+
+  pPath := lower(pPath);
+  pJson := NULLIF(pJson::text, '{}');
+
+  Payload := pJson::jsonb;
+
+  IF pTimeWindow > INTERVAL '1 min' THEN
+    pTimeWindow := INTERVAL '1 min';
+  END IF;
+
+  IF pLog THEN
+    nApiId := AddApiLog(pPath, Payload);
+  END IF;
+
+  BEGIN
+    dtTimeStamp := coalesce(to_timestamp(pNonce / 1000000), Now());
+
+    IF (dtTimeStamp < (Now() + INTERVAL '1 sec') AND (Now() - dtTimeStamp) <= pTimeWindow) THEN
+
+      SELECT (pSignature = GetSignature(pPath, pNonce, pJson, secret)) INTO passed
+        FROM db.session
+       WHERE key = pSession;
+
+      IF NOT coalesce(passed, false) THEN
+        PERFORM SignatureError();
+      END IF;
+
+      IF SessionIn(pSession, pAgent, pHost) IS NULL THEN
+        PERFORM AuthenticateError(GetErrorMessage());
+      END IF;
+
+      dtBegin := clock_timestamp();
+
+	  FOR r IN SELECT * FROM api.fetch(pPath, Payload)
+	  LOOP
+        RETURN NEXT r.fetch;
+      END LOOP;
+
+      IF pLog THEN
+        UPDATE api.log SET runtime = age(clock_timestamp(), dtBegin) WHERE id = nApiId;
+      END IF;
+
+      RETURN;
+    ELSE
+	  PERFORM NonceExpired();
+    END IF;
+  EXCEPTION
+  WHEN others THEN
+    GET STACKED DIAGNOSTICS vMessage = MESSAGE_TEXT;
+  END;
+
+  PERFORM SetErrorMessage(vMessage);
+
+  IF current_session() IS NOT NULL THEN
+    IF pLog THEN
+      UPDATE api.log SET eventid = AddEventLog('E', 5000, vMessage) WHERE id = nApiId;
+    ELSE
+      PERFORM AddEventLog('E', 5000, vMessage);
+    END IF;
+  END IF;
+
+  RETURN NEXT json_build_object('error', json_build_object('code', 5000, 'message', vMessage));
+
+  RETURN;
+EXCEPTION
+WHEN others THEN
+  GET STACKED DIAGNOSTICS vMessage = MESSAGE_TEXT;
+
+  PERFORM SetErrorMessage(vMessage);
+
+  RETURN NEXT json_build_object('error', json_build_object('code', 9000, 'message', vMessage));
+
+  RETURN;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+--------------------------------------------------------------------------------
+-- daemon.WriteLog -------------------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Пакетная запись в api.log и ocpp.log записей, собранных сервером приложений.
+ * @param {jsonb} pLog - Массив записей:
+ *   {"log": "api", "datetime": double precision, "session": text, "route": text, "json": jsonb, "runtime": double precision}
+ *   {"log": "ocpp", "datetime": double precision, "identity": text, "action": text, "request": jsonb, "response": jsonb, "runtime": double precision}
+ *   datetime - Unix time в секундах, runtime - в секундах
+ * @return {integer} - Количество записей
+ */
+CREATE OR REPLACE FUNCTION daemon.WriteLog (
+  pLog          jsonb
+) RETURNS       integer
+AS $$
+DECLARE
+  nApi          integer;
+  nOcpp         integer;
+BEGIN
+  INSERT INTO api.log (datetime, api_session, api_username, route, json, runtime)
+  SELECT to_timestamp(r.datetime)::timestamp, s.key, u.username, r.route,
+         CASE WHEN lower(r.route) = '/sign/in' THEN r.json - 'password' ELSE r.json END,
+         r.runtime * interval '1 second'
+    FROM jsonb_to_recordset(pLog) AS r(log text, datetime double precision, session text, route text, json jsonb, runtime double precision)
+         LEFT JOIN db.session s ON s.key = r.session
+         LEFT JOIN db.user u ON u.id = s.userid
+   WHERE r.log = 'api';
+
+  GET DIAGNOSTICS nApi = ROW_COUNT;
+
+  INSERT INTO ocpp.log (datetime, identity, action, request, response, runtime)
+  SELECT to_timestamp(r.datetime)::timestamp, r.identity, r.action, r.request, r.response, r.runtime * interval '1 second'
+    FROM jsonb_to_recordset(pLog) AS r(log text, datetime double precision, identity text, action text, request jsonb, response jsonb, runtime double precision)
+   WHERE r.log = 'ocpp';
+
+  GET DIAGNOSTICS nOcpp = ROW_COUNT;
+
+  RETURN nApi + nOcpp;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
@@ -0,0 +1,227 @@
+GRANT USAGE ON SCHEMA ocpp TO daemon;
+
+--------------------------------------------------------------------------------
+-- ocpp.SetSession -------------------------------------------------------------
+--------------------------------------------------------------------------------
+
+CREATE OR REPLACE FUNCTION ocpp.SetSession (
+) RETURNS	    text
+AS $$
+DECLARE
+  nUserId	    numeric;
+  nArea         numeric;
+  nInterface	numeric;
+
+  vSession	    text;
+BEGIN
+  IF session_user <> 'ocpp' THEN
+    PERFORM AccessDeniedForUser(session_user);
+  END IF;
+
+  nUserId := GetUser('ocpp');
+
+  IF nUserId IS NOT NULL THEN
+    SELECT key INTO vSession FROM db.session WHERE userid = nUserId;
+
+    IF NOT FOUND THEN
+      nArea := GetDefaultArea(nUserId);
+      nInterface := GetDefaultInterface(nUserId);
+
+      INSERT INTO db.session (userid, area, interface, host)
+      VALUES (nUserId, nArea, nInterface, null)
+      RETURNING key INTO vSession;
+    END IF;
+
+    PERFORM SetSessionKey(vSession);
+    PERFORM SetUserId(nUserId);
+  END IF;
+
+  RETURN vSession;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+--------------------------------------------------------------------------------
+-- daemon.OcppSession ----------------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Вход по сессии зарядной станции для вызова обработчика ocpp.* сервером приложений.
+ * Сервер приложений вызывает обработчики напрямую только для сессии, которую уже подтвердила база данных
+ * (/sign/in или /authorize через daemon.SignFetch).
+ * Сессия устанавливается только до конца транзакции: соединение из пула сервера приложений затем выполняет запросы
+ * других станций и клиентов.
+ * @param {text} pSession - Сессия
+ * @param {text} pAgent - Агент
+ * @param {inet} pHost - IP адрес
+ * @return {text} - Сессия
+ */
+CREATE OR REPLACE FUNCTION daemon.OcppSession (
+  pSession      text,
+  pAgent        text DEFAULT null,
+  pHost         inet DEFAULT null
+) RETURNS       text
+AS $$
+DECLARE
+  nUserId       numeric;
+BEGIN
+  IF SessionIn(pSession, pAgent, pHost) IS NULL THEN
+    PERFORM AuthenticateError(GetErrorMessage());
+  END IF;
+
+  nUserId := GetUserId();
+
+  -- SessionIn устанавливает сессию для всего соединения: сбросить её и оставить только до конца транзакции.
+  PERFORM SetSessionKey(null);
+  PERFORM SetUserId(null);
+
+  PERFORM set_config('auth.session', pSession, true);
+  PERFORM set_config('auth.user', trim(to_char(nUserId, '999999990000')), true);
+
+  RETURN pSession;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+ALTER TABLE db.charge_point ADD COLUMN IF NOT EXISTS lastSeen timestamp;
+
+COMMENT ON COLUMN db.charge_point.lastSeen IS 'Дата и время последнего Heartbeat.';
+
+--------------------------------------------------------------------------------
+-- ChargePoint -----------------------------------------------------------------
+--------------------------------------------------------------------------------
+
+CREATE OR REPLACE VIEW ChargePoint (Id, Reference, Client, ClientCode, Identity,
+  Name, Description, Model, Vendor, Version, SerialNumber, BoxSerialNumber,
+  MeterSerialNumber, iccid, imsi, LastSeen
+)
+AS
+  SELECT p.id, p.reference, p.client, c.code, r.code,
+         r.name, r.description, p.model, p.vendor, p.version, p.serialnumber,
+         p.boxserialnumber, p.meterserialnumber, p.iccid, p.imsi, p.lastseen
+    FROM db.charge_point p INNER JOIN db.reference r ON r.id = p.reference
+                            LEFT JOIN db.client c ON c.id = p.client;
+
+GRANT SELECT ON ChargePoint TO administrator;
+
+DROP FUNCTION IF EXISTS ocpp.SetLastSeen(text[], double precision[]);
+
+--------------------------------------------------------------------------------
+-- ocpp.SetLastSeen ------------------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Сохраняет время последнего Heartbeat зарядных станций (ответ на Heartbeat дан сервером приложений) и выполняет
+ * действие Heartbeat (как ocpp.Heartbeat) в сессии станции. Ошибка действия одной станции не отменяет остальные, она
+ * записывается в ocpp.log.
+ * @param {text[]} pIdentity - Идентификаторы зарядных станций
+ * @param {double precision[]} pEpoch - Время в секундах (Unix time)
+ * @param {text[]} pSession - Сессии зарядных станций (подтверждённые базой данных)
+ * @return {integer} - Количество обновлённых станций
+ */
+CREATE OR REPLACE FUNCTION ocpp.SetLastSeen (
+  pIdentity	text[],
+  pEpoch	double precision[],
+  pSession	text[]
+) RETURNS	integer
+AS $$
+DECLARE
+  e		record;
+
+  nCount	integer;
+  nAction	numeric;
+
+  vError	text;
+BEGIN
+  nCount := 0;
+  nAction := GetAction('Heartbeat');
+
+  FOR e IN
+    UPDATE db.charge_point p
+       SET lastseen = greatest(p.lastseen, t.lastseen)
+      FROM db.reference r,
+           (SELECT u.identity, to_timestamp(u.epoch)::timestamp AS lastseen, u.session
+              FROM unnest(pIdentity, pEpoch, pSession) AS u(identity, epoch, session)) t
+     WHERE r.id = p.reference
+       AND r.code = t.identity
+    RETURNING p.id, t.identity, t.session
+  LOOP
+    BEGIN
+      IF SessionIn(e.session) IS NULL THEN
+        PERFORM AuthenticateError(GetErrorMessage());
+      END IF;
+
+      PERFORM ExecuteObjectAction(e.id, nAction, null);
+    EXCEPTION
+    WHEN others THEN
+      GET STACKED DIAGNOSTICS vError = MESSAGE_TEXT;
+      PERFORM ocpp.WriteToLog(e.identity, 'Heartbeat', '{}'::jsonb, jsonb_build_object('error', vError));
+    END;
+
+    nCount := nCount + 1;
+  END LOOP;
+
+  -- Не оставлять соединению из пула сессию последней станции.
+  PERFORM SetSessionKey(null);
+  PERFORM SetUserId(null);
+
+  RETURN nCount;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+DROP FUNCTION IF EXISTS ocpp.AddMeterValues(jsonb);
+
+--------------------------------------------------------------------------------
+-- ocpp.AddMeterValues ---------------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Сохраняет пакет MeterValues, принятых сервером приложений.
+ * Ошибка в одном запросе не отменяет остальные, она записывается в ocpp.log.
+ * @param {jsonb} pValues - Массив: [{"identity": text, "epoch": double precision, "request": jsonb}, ...]
+ * @param {boolean} pLog - Записать запросы в ocpp.log (false - запись делает сервер приложений)
+ * @return {integer} - Количество сохранённых значений
+ */
+CREATE OR REPLACE FUNCTION ocpp.AddMeterValues (
+  pValues       jsonb,
+  pLog          boolean DEFAULT true
+) RETURNS       integer
+AS $$
+DECLARE
+  r             record;
+
+  nCount        integer;
+  nChargePoint  numeric;
+
+  vError        text;
+BEGIN
+  nCount := 0;
+
+  FOR r IN SELECT * FROM jsonb_to_recordset(pValues) AS x(identity text, epoch double precision, request jsonb)
+  LOOP
+    BEGIN
+      nChargePoint := GetChargePoint(r.identity);
+
+      IF nChargePoint IS NOT NULL THEN
+        PERFORM AddMeterValue(nChargePoint, (r.request->>'connectorId')::integer, (r.request->>'transactionId')::numeric,
+          (r.request->'meterValue')::json, to_timestamp(r.epoch)::timestamp);
+
+        nCount := nCount + 1;
+      END IF;
+
+      IF pLog THEN
+        PERFORM ocpp.WriteToLog(r.identity, 'MeterValues', r.request, '{}'::jsonb);
+      END IF;
+    EXCEPTION
+    WHEN others THEN
+      GET STACKED DIAGNOSTICS vError = MESSAGE_TEXT;
+      PERFORM ocpp.WriteToLog(r.identity, 'MeterValues', r.request, jsonb_build_object('error', vError));
+    END;
+  END LOOP;
+
+  RETURN nCount;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
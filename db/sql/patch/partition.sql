@@ -0,0 +1,252 @@
+\ir '../kernel/partition.sql'
+
+--------------------------------------------------------------------------------
+-- MigrateToPartitions ---------------------------------------------------------
+--------------------------------------------------------------------------------
+/**
+ * Присоединяет старую таблицу к секционированной как секцию (MINVALUE, конец текущего периода).
+ * Секция удаляется по сроку хранения, как и остальные.
+ */
+CREATE OR REPLACE FUNCTION MigrateToPartitions (
+  pTable        text,
+  pLegacy       text,
+  pColumn       text,
+  pPeriod       text
+) RETURNS       void
+AS $$
+DECLARE
+  dtMax         timestamp;
+  dtTo          timestamp;
+BEGIN
+  EXECUTE format('SELECT max(%I) FROM %s', pColumn, pLegacy) INTO dtMax;
+
+  dtTo := date_trunc(pPeriod, greatest(dtMax, localtimestamp)) + ('1 ' || pPeriod)::interval;
+
+  EXECUTE format('ALTER TABLE %s ATTACH PARTITION %s FOR VALUES FROM (MINVALUE) TO (%L)', pTable, pLegacy, dtTo);
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+--------------------------------------------------------------------------------
+-- ocpp.log --------------------------------------------------------------------
+--------------------------------------------------------------------------------
+
+-- The patch may be run again: a table that is already partitioned is left as is.
+DO $$
+BEGIN
+  IF EXISTS (SELECT FROM pg_partitioned_table WHERE partrelid = 'ocpp.log'::regclass) THEN
+    RETURN;
+  END IF;
+
+  ALTER TABLE ocpp.log RENAME TO log_legacy;
+  ALTER TABLE ocpp.log_legacy RENAME CONSTRAINT log_pkey TO log_legacy_pkey;
+
+  CREATE TABLE ocpp.log (
+      id			numeric NOT NULL DEFAULT NEXTVAL('SEQUENCE_OCPP_LOG'),
+      datetime	timestamp DEFAULT clock_timestamp() NOT NULL,
+      username	text NOT NULL DEFAULT session_user,
+      identity	text NOT NULL,
+      action		text NOT NULL,
+      request		jsonb,
+      response	jsonb,
+      runtime		interval,
+      PRIMARY KEY (id, datetime)
+  ) PARTITION BY RANGE (datetime);
+
+  COMMENT ON TABLE ocpp.log IS 'Лог OCPP.';
+
+  COMMENT ON COLUMN ocpp.log.id IS 'Идентификатор';
+  COMMENT ON COLUMN ocpp.log.datetime IS 'Дата и время';
+  COMMENT ON COLUMN ocpp.log.username IS 'Пользователь СУБД';
+  COMMENT ON COLUMN ocpp.log.identity IS 'Идентификатор зарядной станции';
+  COMMENT ON COLUMN ocpp.log.action IS 'Действие';
+  COMMENT ON COLUMN ocpp.log.request IS 'Запрос';
+  COMMENT ON COLUMN ocpp.log.response IS 'Ответ';
+  COMMENT ON COLUMN ocpp.log.runtime IS 'Время выполнения запроса';
+
+  CREATE INDEX ON ocpp.log (identity);
+  CREATE INDEX ON ocpp.log (action);
+  CREATE INDEX ON ocpp.log USING brin (datetime);
+
+  CREATE TABLE ocpp.log_default PARTITION OF ocpp.log DEFAULT;
+
+  PERFORM MigrateToPartitions('ocpp.log', 'ocpp.log_legacy', 'datetime', 'day');
+  PERFORM CheckPartitions('ocpp.log', 'day');
+END;
+$$;
+
+CREATE OR REPLACE VIEW ocppLog (Id, DateTime, UserName,
+  Identity, Action, Request, Response, RunTime)
+AS
+  SELECT id, datetime, username, identity, action, request, response,
+         round(extract(second from runtime)::numeric, 3)
+    FROM ocpp.log;
+
+CREATE OR REPLACE FUNCTION ocpp.ClearLog (
+  pDateTime	timestamp
+) RETURNS	void
+AS $$
+BEGIN
+  PERFORM DropPartitions('ocpp.log', pDateTime);
+  DELETE FROM ocpp.log WHERE datetime < pDateTime;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+--------------------------------------------------------------------------------
+-- api.log ---------------------------------------------------------------------
+--------------------------------------------------------------------------------
+
+-- The patch may be run again: a table that is already partitioned is left as is.
+DO $$
+BEGIN
+  IF EXISTS (SELECT FROM pg_partitioned_table WHERE partrelid = 'api.log'::regclass) THEN
+    RETURN;
+  END IF;
+
+  ALTER TABLE api.log RENAME TO log_legacy;
+  ALTER TABLE api.log_legacy RENAME CONSTRAINT log_pkey TO log_legacy_pkey;
+
+  CREATE TABLE api.log (
+      id			    numeric NOT NULL DEFAULT NEXTVAL('SEQUENCE_API_LOG'),
+      datetime		timestamp DEFAULT clock_timestamp() NOT NULL,
+      username		text NOT NULL DEFAULT session_user,
+      api_session		char(40),
+      api_username	varchar(50),
+      route		    text NOT NULL,
+      json		    jsonb,
+      eventid		    numeric(12),
+      runtime		    interval,
+      PRIMARY KEY (id, datetime),
+      CONSTRAINT fk_api_log_eventid FOREIGN KEY (eventid) REFERENCES db.log(id)
+  ) PARTITION BY RANGE (datetime);
+
+  COMMENT ON TABLE api.log IS 'Лог API.';
+
+  COMMENT ON COLUMN api.log.id IS 'Идентификатор';
+  COMMENT ON COLUMN api.log.datetime IS 'Дата и время';
+  COMMENT ON COLUMN api.log.username IS 'Реальный пользователь';
+  COMMENT ON COLUMN api.log.api_session IS 'Сессия';
+  COMMENT ON COLUMN api.log.api_username IS 'Эффективный пользователь';
+  COMMENT ON COLUMN api.log.route IS 'Путь';
+  COMMENT ON COLUMN api.log.json IS 'JSON';
+  COMMENT ON COLUMN api.log.runtime IS 'Время выполнения запроса';
+
+  CREATE INDEX ON api.log USING brin (datetime);
+  CREATE INDEX ON api.log (api_username);
+  CREATE INDEX ON api.log (eventid);
+
+  CREATE TABLE api.log_default PARTITION OF api.log DEFAULT;
+
+  PERFORM MigrateToPartitions('api.log', 'api.log_legacy', 'datetime', 'day');
+  PERFORM CheckPartitions('api.log', 'day');
+END;
+$$;
+
+CREATE OR REPLACE VIEW ApiLog (Id, DateTime, UserName, ApiSession, ApiUserName,
+  Path, JSON, RunTime, EventId, Error)
+AS
+  SELECT al.id, al.datetime, al.username, al.api_session, al.api_username,
+         al.route, al.json, round(extract(second from runtime)::numeric, 3), al.eventid, el.text
+    FROM api.log al LEFT JOIN db.log el ON el.id = al.eventid;
+
+CREATE OR REPLACE FUNCTION ClearApiLog (
+  pDateTime	timestamp
+) RETURNS	void
+AS $$
+BEGIN
+  PERFORM DropPartitions('api.log', pDateTime);
+  DELETE FROM api.log WHERE datetime < pDateTime;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
+
+--------------------------------------------------------------------------------
+-- db.meter_value --------------------------------------------------------------
+--------------------------------------------------------------------------------
+
+-- The patch may be run again: a table that is already partitioned is left as is.
+DO $$
+BEGIN
+  IF EXISTS (SELECT FROM pg_partitioned_table WHERE partrelid = 'db.meter_value'::regclass) THEN
+    RETURN;
+  END IF;
+
+  ALTER TABLE db.meter_value RENAME TO meter_value_legacy;
+  ALTER TABLE db.meter_value_legacy RENAME CONSTRAINT meter_value_pkey TO meter_value_legacy_pkey;
+
+  CREATE TABLE db.meter_value (
+      id			    numeric(12) NOT NULL DEFAULT NEXTVAL('SEQUENCE_OCPP_STATUS'),
+      chargePoint		numeric(12) NOT NULL,
+      connectorId		integer NOT NULL,
+      transactionId	numeric(12),
+      meterValue		json NOT NULL,
+      validFromDate	timestamp DEFAULT NOW() NOT NULL,
+      validToDate		timestamp DEFAULT TO_DATE('4433-12-31', 'YYYY-MM-DD') NOT NULL,
+      PRIMARY KEY (id, validFromDate),
+      CONSTRAINT fk_meter_value_chargePoint FOREIGN KEY (chargePoint) REFERENCES db.charge_point(id),
+      CONSTRAINT fk_meter_value_transactionId FOREIGN KEY (transactionId) REFERENCES db.transaction(id)
+  ) PARTITION BY RANGE (validFromDate);
+
+  COMMENT ON TABLE db.meter_value IS 'Meter values.';
+
+  COMMENT ON COLUMN db.meter_value.Id IS 'Идентификатор.';
+  COMMENT ON COLUMN db.meter_value.chargePoint IS 'Зарядная станция.';
+  COMMENT ON COLUMN db.meter_value.connectorId IS 'Required. The id of the connector for which the status is reported. Id "0" (zero) is used if the status is for the Charge Point main controller.';
+  COMMENT ON COLUMN db.meter_value.transactionId IS 'Optional. The transaction to which these meter samples are related.';
+  COMMENT ON COLUMN db.meter_value.meterValue IS 'Required. The sampled meter values with timestamps.';
+  COMMENT ON COLUMN db.meter_value.validFromDate IS 'Дата начала периода действия';
+  COMMENT ON COLUMN db.meter_value.validToDate IS 'Дата окончания периода действия.';
+
+  CREATE INDEX ON db.meter_value (chargePoint);
+  CREATE INDEX ON db.meter_value (connectorId);
+  CREATE INDEX ON db.meter_value (transactionId);
+  CREATE INDEX ON db.meter_value (chargePoint, validFromDate, validToDate);
+
+  CREATE UNIQUE INDEX ON db.meter_value (chargePoint, connectorId, validFromDate, validToDate);
+
+  CREATE INDEX ON db.meter_value USING brin (validFromDate);
+
+  CREATE TABLE db.meter_value_default PARTITION OF db.meter_value DEFAULT;
+
+  PERFORM MigrateToPartitions('db.meter_value', 'db.meter_value_legacy', 'validfromdate', 'month');
+  PERFORM CheckPartitions('db.meter_value', 'month');
+END;
+$$;
+
+CREATE OR REPLACE VIEW MeterValue
+AS
+  SELECT * FROM db.meter_value;
+
+GRANT SELECT ON MeterValue TO administrator;
+
+DROP FUNCTION MigrateToPartitions(text, text, text, text);
+
+--------------------------------------------------------------------------------
+-- daemon.CheckPartitions ------------------------------------------------------
+--------------------------------------------------------------------------------
+
+CREATE OR REPLACE FUNCTION daemon.CheckPartitions (
+  pTables       jsonb
+) RETURNS       SETOF json
+AS $$
+DECLARE
+  r             record;
+BEGIN
+  FOR r IN SELECT * FROM jsonb_to_recordset(pTables) AS x("table" text, period text, ahead integer, keep integer)
+  LOOP
+    IF r.table NOT IN ('ocpp.log', 'api.log', 'db.meter_value') THEN
+      RAISE EXCEPTION 'Partition maintenance is not allowed for table "%".', r.table;
+    END IF;
+
+    RETURN NEXT CheckPartitions(r.table, r.period, coalesce(r.ahead, 3), coalesce(r.keep, 0));
+  END LOOP;
+
+  RETURN;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
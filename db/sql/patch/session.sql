@@ -0,0 +1,22 @@
+--------------------------------------------------------------------------------
+-- FUNCTION ft_session_after ---------------------------------------------------
+--------------------------------------------------------------------------------
+
+CREATE OR REPLACE FUNCTION db.ft_session_after()
+RETURNS TRIGGER
+AS $$
+BEGIN
+  IF (TG_OP = 'DELETE') THEN
+    DELETE FROM db.token WHERE session = OLD.key;
+    PERFORM pg_notify('session', OLD.key);
+    RETURN OLD;
+  ELSIF (TG_OP = 'UPDATE') THEN
+    IF OLD.userid <> NEW.userid THEN
+      PERFORM SetUserId(NEW.userid);
+    END IF;
+    RETURN NEW;
+  END IF;
+END;
+$$ LANGUAGE plpgsql
+   SECURITY DEFINER
+   SET search_path = kernel, pg_temp;
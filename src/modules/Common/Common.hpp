@@ -0,0 +1,36 @@
+/*++
+
+Library name:
+
+  apostol-core
+
+Module Name:
+
+  Common.hpp
+
+Notices:
+
+  Add-ons: Common
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_COMMON_HPP
+#define APOSTOL_COMMON_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "SharedMemory/SharedMemory.hpp"
+#include "SlotTable/SlotTable.hpp"
+#include "KeySegment/KeySegment.hpp"
+#include "PQListener/PQListener.hpp"
+#include "WorkerChannel/WorkerChannel.hpp"
+#include "LogRing/LogRing.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+#endif //APOSTOL_COMMON_HPP
@@ -0,0 +1,151 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  KeySegment.hpp
+
+Notices:
+
+  Common: Provider keys shared between the helper and the workers
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_KEYSEGMENT_HPP
+#define APOSTOL_KEYSEGMENT_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <cstring>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define KEY_SEGMENT_TAG      "keys"
+#define KEY_SEGMENT_CAPACITY (256 * 1024)
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Common {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CKeySegment -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Public keys of the authorization providers. The certificate downloader publishes them, the workers
+         * pick them up when the sequence changes.
+         *
+         * Layout: for each provider with keys, "provider\0", then each key line followed by "\0", then "\0".
+         */
+        class CKeySegment {
+        private:
+
+            CSharedSnapshot m_Snapshot;
+
+        public:
+
+            CKeySegment() = default;
+
+            void Open() { m_Snapshot.Open(KEY_SEGMENT_TAG, KEY_SEGMENT_CAPACITY); }
+
+            bool Active() const { return m_Snapshot.Active(); }
+
+            uint64_t Sequence() const { return m_Snapshot.Sequence(); }
+
+            // The downloader has gone away and removed the segment, the next one is opened anew.
+            bool Retired() const { return m_Snapshot.Retired(); }
+            void Retire() { m_Snapshot.Retire(); }
+
+            template<class TAuthParams>
+            bool Publish(const TAuthParams &Params) {
+                std::string Data;
+
+                for (int i = 0; i < Params.Count(); i++) {
+                    const auto& Param = Params[i].Value();
+                    if (Param.Keys.Count() == 0)
+                        continue;
+
+                    Data.append(Param.Provider.c_str());
+                    Data.push_back('\0');
+
+                    for (int l = 0; l < Param.Keys.Count(); l++) {
+                        const auto& Line = Param.Keys[l];
+                        if (!Line.IsEmpty()) {
+                            Data.append(Line.c_str());
+                            Data.push_back('\0');
+                        }
+                    }
+
+                    Data.push_back('\0');
+                }
+
+                return m_Snapshot.Write(Data);
+            }
+
+            /**
+             * Copies the keys into Params if the segment has changed since Sequence.
+             * @return true if Params and Sequence were updated.
+             */
+            template<class TAuthParams>
+            bool Load(TAuthParams &Params, uint64_t &Sequence) {
+                if (m_Snapshot.Sequence() == Sequence)
+                    return false;
+
+                std::string Data;
+                uint64_t Current = 0;
+
+                if (!m_Snapshot.Read(Data, Current) || Current == Sequence)
+                    return false;
+
+                const char *P = Data.data();
+                const char *End = P + Data.size();
+
+                while (P < End) {
+                    const CString Provider(P);
+                    P += strlen(P) + 1;
+
+                    int Index = -1;
+                    for (int i = 0; i < Params.Count(); i++) {
+                        if (Params[i].Value().Provider == Provider) {
+                            Index = i;
+                            break;
+                        }
+                    }
+
+                    if (Index != -1)
+                        Params[Index].Value().Keys.Clear();
+
+                    while (P < End && *P != '\0') {
+                        if (Index != -1)
+                            Params[Index].Value().Keys << P;
+                        P += strlen(P) + 1;
+                    }
+
+                    P++;
+                }
+
+                Sequence = Current;
+
+                return true;
+            }
+
+        };
+
+    }
+}
+
+using namespace Apostol::Common;
+}
+#endif //APOSTOL_KEYSEGMENT_HPP
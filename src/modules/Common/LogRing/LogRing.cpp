@@ -0,0 +1,203 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  LogRing.cpp
+
+Notices:
+
+  Common: Log records queue between processes
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "LogRing.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <sched.h>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define LOG_RING_EMPTY        0
+#define LOG_RING_INITIALIZING 1
+#define LOG_RING_READY        2
+
+#define LOG_RING_OPEN_ATTEMPTS 1000
+#define LOG_RING_STALL_TIMEOUT 1000 // ms
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Common {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CLogRing --------------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        CLogRingSlot *CLogRing::Slot(uint64_t Position) const {
+            const auto pHeader = Header();
+            const auto Index = Position % pHeader->Capacity;
+            return (CLogRingSlot *) ((char *) m_Memory.Data() + sizeof(CLogRingHeader) +
+                Index * (sizeof(CLogRingSlot) + pHeader->SlotSize));
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CLogRing::Open(uint32_t Capacity, uint32_t SlotSize) {
+            if (Capacity == 0 || SlotSize == 0)
+                throw ExceptionFrm(_T("Log ring: invalid size (%u x %u)."), Capacity, SlotSize);
+
+            // Keep every slot header 8-byte aligned.
+            SlotSize = (SlotSize + 7) & ~7U;
+
+            m_Memory.Open(LOG_RING_TAG, sizeof(CLogRingHeader) + (size_t) Capacity * (sizeof(CLogRingSlot) + SlotSize));
+
+            auto pHeader = Header();
+
+            uint32_t State = LOG_RING_EMPTY;
+            if (__atomic_compare_exchange_n(&pHeader->State, &State, LOG_RING_INITIALIZING, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                pHeader->Capacity = Capacity;
+                pHeader->SlotSize = SlotSize;
+                pHeader->Head = 0;
+                pHeader->Tail = 0;
+                pHeader->Dropped = 0;
+
+                for (uint64_t i = 0; i < Capacity; ++i) {
+                    auto pSlot = Slot(i);
+                    pSlot->Sequence = i;
+                    pSlot->Length = 0;
+                }
+
+                __atomic_store_n(&pHeader->State, (uint32_t) LOG_RING_READY, __ATOMIC_RELEASE);
+            } else {
+                int Attempt = 0;
+                while (__atomic_load_n(&pHeader->State, __ATOMIC_ACQUIRE) != LOG_RING_READY && Attempt++ < LOG_RING_OPEN_ATTEMPTS)
+                    sched_yield();
+
+                if (__atomic_load_n(&pHeader->State, __ATOMIC_ACQUIRE) != LOG_RING_READY) {
+                    Close();
+                    throw ExceptionFrm(_T("Log ring \"%s\" is not initialized."), CSharedMemory::MakeName(LOG_RING_TAG).c_str());
+                }
+            }
+
+            if (pHeader->Capacity != Capacity || pHeader->SlotSize != SlotSize) {
+                const auto OldCapacity = pHeader->Capacity;
+                const auto OldSlotSize = pHeader->SlotSize;
+                Close();
+                throw ExceptionFrm(_T("Log ring was created as %u x %u, not %u x %u (stop the server and remove /dev/shm%s to resize it)."),
+                                   OldCapacity, OldSlotSize, Capacity, SlotSize, CSharedMemory::MakeName(LOG_RING_TAG).c_str());
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        size_t CLogRing::Count() const {
+            if (!Active())
+                return 0;
+
+            const auto Head = __atomic_load_n(&Header()->Head, __ATOMIC_RELAXED);
+            const auto Tail = __atomic_load_n(&Header()->Tail, __ATOMIC_RELAXED);
+
+            return Head > Tail ? (size_t) (Head - Tail) : 0;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        uint64_t CLogRing::Dropped() const {
+            if (!Active())
+                return 0;
+            return __atomic_load_n(&Header()->Dropped, __ATOMIC_RELAXED);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CLogRing::Push(const char *Data, size_t Length) {
+            if (!Active())
+                return false;
+
+            auto pHeader = Header();
+
+            if (Length > pHeader->SlotSize)
+                return false;
+
+            auto Position = __atomic_load_n(&pHeader->Head, __ATOMIC_RELAXED);
+
+            for (;;) {
+                auto pSlot = Slot(Position);
+
+                const auto Sequence = __atomic_load_n(&pSlot->Sequence, __ATOMIC_ACQUIRE);
+                const auto Difference = (int64_t) (Sequence - Position);
+
+                if (Difference == 0) {
+                    if (__atomic_compare_exchange_n(&pHeader->Head, &Position, Position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                        memcpy((char *) pSlot + sizeof(CLogRingSlot), Data, Length);
+                        pSlot->Length = (uint32_t) Length;
+                        __atomic_store_n(&pSlot->Sequence, Position + 1, __ATOMIC_RELEASE);
+                        return true;
+                    }
+                } else if (Difference < 0) {
+                    return false; // full
+                } else {
+                    Position = __atomic_load_n(&pHeader->Head, __ATOMIC_RELAXED);
+                }
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CLogRing::Pop(std::string &Record, uint64_t Now) {
+            if (!Active())
+                return false;
+
+            auto pHeader = Header();
+
+            for (;;) {
+                const auto Position = __atomic_load_n(&pHeader->Tail, __ATOMIC_RELAXED);
+                auto pSlot = Slot(Position);
+
+                const auto Sequence = __atomic_load_n(&pSlot->Sequence, __ATOMIC_ACQUIRE);
+
+                if (Sequence == Position + 1) {
+                    Record.assign((char *) pSlot + sizeof(CLogRingSlot), pSlot->Length);
+                    __atomic_store_n(&pSlot->Sequence, Position + pHeader->Capacity, __ATOMIC_RELEASE);
+                    __atomic_store_n(&pHeader->Tail, Position + 1, __ATOMIC_RELAXED);
+                    m_StalledSince = 0;
+                    return true;
+                }
+
+                // Nothing reserved: the queue is empty.
+                if (__atomic_load_n(&pHeader->Head, __ATOMIC_RELAXED) <= Position) {
+                    m_StalledSince = 0;
+                    return false;
+                }
+
+                // Reserved but not published yet. Give up on it if its producer does not finish in time.
+                if (m_StalledSince == 0) {
+                    m_StalledSince = Now;
+                    return false;
+                }
+
+                if (Now - m_StalledSince < LOG_RING_STALL_TIMEOUT)
+                    return false;
+
+                __atomic_store_n(&pSlot->Sequence, Position + pHeader->Capacity, __ATOMIC_RELEASE);
+                __atomic_store_n(&pHeader->Tail, Position + 1, __ATOMIC_RELAXED);
+                __atomic_add_fetch(&pHeader->Dropped, 1, __ATOMIC_RELAXED);
+
+                m_StalledSince = 0;
+            }
+        }
+
+    }
+}
+}
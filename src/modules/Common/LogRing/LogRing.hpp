@@ -0,0 +1,110 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  LogRing.hpp
+
+Notices:
+
+  Common: Log records queue between processes
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_LOGRING_HPP
+#define APOSTOL_LOGRING_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <cstdint>
+#include <string>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define LOG_RING_TAG "log"
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Common {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CLogRing --------------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct log_ring_header_s {
+            uint32_t State;
+            uint32_t Capacity;
+            uint32_t SlotSize;
+            uint32_t Reserved;
+            uint64_t Head;
+            uint64_t Tail;
+            uint64_t Dropped;
+        } CLogRingHeader;
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct log_ring_slot_s {
+            uint64_t Sequence;
+            uint32_t Length;
+            uint32_t Reserved;
+        } CLogRingSlot;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Bounded queue of text records in shared memory: any number of producers (the workers), one consumer
+         * (the helper). Lock-free: a producer reserves a slot by moving Head, fills it and publishes it through the
+         * slot sequence. Records that do not fit into a slot or into a full queue are refused.
+         *
+         * A slot reserved by a process that died before publishing it is skipped by the consumer after a timeout.
+         */
+        class CLogRing {
+        private:
+
+            CSharedMemory m_Memory;
+
+            uint64_t m_StalledSince;
+
+            CLogRingHeader *Header() const { return (CLogRingHeader *) m_Memory.Data(); }
+            CLogRingSlot *Slot(uint64_t Position) const;
+
+        public:
+
+            CLogRing(): m_StalledSince(0) {
+
+            };
+
+            void Open(uint32_t Capacity, uint32_t SlotSize);
+            void Close() { m_Memory.Close(); }
+
+            bool Active() const { return m_Memory.Active(); }
+
+            uint32_t Capacity() const { return Active() ? Header()->Capacity : 0; }
+            uint32_t SlotSize() const { return Active() ? Header()->SlotSize : 0; }
+
+            size_t Count() const;
+            uint64_t Dropped() const;
+
+            bool Push(const char *Data, size_t Length);
+            bool Push(const CString &Record) { return Push(Record.c_str(), Record.Length()); }
+
+            bool Pop(std::string &Record, uint64_t Now);
+
+        };
+
+    }
+}
+
+using namespace Apostol::Common;
+}
+#endif //APOSTOL_LOGRING_HPP
@@ -0,0 +1,220 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  PQListener.cpp
+
+Notices:
+
+  Common: PostgreSQL LISTEN/NOTIFY connection
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "PQListener.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define PQ_LISTENER_MAX_BACKOFF 60
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Common {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CPQListener -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        CPQListener::~CPQListener() {
+            if (m_pConnection != nullptr)
+                PQfinish(m_pConnection);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CPQListener::Param(const CString &Keyword, const CString &Value) {
+            m_Params.emplace_back(Keyword.c_str(), Value.c_str());
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CPQListener::Listen(const CString &Channel) {
+            m_Channels.emplace_back(Channel.c_str());
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CPQListener::Connect() {
+            std::vector<const char *> Keywords;
+            std::vector<const char *> Values;
+
+            for (const auto& Param : m_Params) {
+                Keywords.push_back(Param.first.c_str());
+                Values.push_back(Param.second.c_str());
+            }
+
+            Keywords.push_back(nullptr);
+            Values.push_back(nullptr);
+
+            m_pConnection = PQconnectStartParams(Keywords.data(), Values.data(), 1);
+
+            if (m_pConnection == nullptr) {
+                Disconnect("out of memory");
+                return;
+            }
+
+            if (PQstatus(m_pConnection) == CONNECTION_BAD) {
+                Disconnect(PQerrorMessage(m_pConnection));
+                return;
+            }
+
+            m_Status = lsConnecting;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CPQListener::Disconnect(const char *Reason) {
+            Log()->Error(APP_LOG_WARN, 0, _T("[LISTEN] Connection lost: %s"), Reason);
+
+            if (m_pConnection != nullptr) {
+                PQfinish(m_pConnection);
+                m_pConnection = nullptr;
+            }
+
+            m_Status = lsDisconnected;
+
+            const int Backoff = 1 << std::min(m_Failures, 6);
+            m_Failures++;
+
+            m_NextConnect = time(nullptr) + std::min(Backoff, PQ_LISTENER_MAX_BACKOFF);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CPQListener::SendListen() {
+            std::string SQL;
+
+            for (const auto& Channel : m_Channels) {
+                auto Identifier = PQescapeIdentifier(m_pConnection, Channel.c_str(), Channel.size());
+                if (Identifier == nullptr)
+                    return false;
+
+                SQL.append("LISTEN ");
+                SQL.append(Identifier);
+                SQL.append(";");
+
+                PQfreemem(Identifier);
+            }
+
+            return PQsendQuery(m_pConnection, SQL.c_str()) == 1;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CPQListener::ConsumeResults() {
+            if (PQconsumeInput(m_pConnection) == 0 || PQflush(m_pConnection) == -1)
+                return false;
+
+            while (PQisBusy(m_pConnection) == 0) {
+                auto Result = PQgetResult(m_pConnection);
+
+                if (Result == nullptr) {
+                    m_Status = lsReady;
+                    m_Failures = 0;
+
+                    Log()->Message(_T("[LISTEN] Listening on %d channel(s)."), (int) m_Channels.size());
+
+                    if (m_OnConnected != nullptr)
+                        m_OnConnected();
+
+                    return true;
+                }
+
+                const auto Status = PQresultStatus(Result);
+                PQclear(Result);
+
+                if (Status != PGRES_COMMAND_OK)
+                    return false;
+            }
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CPQListener::DoNotify() {
+            PGnotify *Notify;
+
+            while ((Notify = PQnotifies(m_pConnection)) != nullptr) {
+                if (m_OnNotify != nullptr) {
+                    try {
+                        m_OnNotify(Notify->relname, Notify->extra);
+                    } catch (std::exception &e) {
+                        Log()->Error(APP_LOG_EMERG, 0, e.what());
+                    }
+                }
+                PQfreemem(Notify);
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CPQListener::Poll() {
+            if (!Active())
+                return;
+
+            switch (m_Status) {
+                case lsDisconnected:
+                    if (time(nullptr) >= m_NextConnect)
+                        Connect();
+                    break;
+
+                case lsConnecting:
+                    switch (PQconnectPoll(m_pConnection)) {
+                        case PGRES_POLLING_FAILED:
+                            Disconnect(PQerrorMessage(m_pConnection));
+                            break;
+
+                        case PGRES_POLLING_OK:
+                            PQsetnonblocking(m_pConnection, 1);
+                            if (SendListen()) {
+                                m_Status = lsListening;
+                            } else {
+                                Disconnect(PQerrorMessage(m_pConnection));
+                            }
+                            break;
+
+                        default:
+                            break;
+                    }
+                    break;
+
+                case lsListening:
+                    if (!ConsumeResults())
+                        Disconnect(PQerrorMessage(m_pConnection));
+                    break;
+
+                case lsReady:
+                    if (PQconsumeInput(m_pConnection) == 0) {
+                        Disconnect(PQerrorMessage(m_pConnection));
+                        break;
+                    }
+                    DoNotify();
+                    break;
+            }
+        }
+
+    }
+}
+}
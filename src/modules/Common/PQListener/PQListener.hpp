@@ -0,0 +1,120 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  PQListener.hpp
+
+Notices:
+
+  Common: PostgreSQL LISTEN/NOTIFY connection
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_PQLISTENER_HPP
+#define APOSTOL_PQLISTENER_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <libpq-fe.h>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Common {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CPQListener -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef std::function<void (const CString &Channel, const CString &Payload)> COnPQListenerNotify;
+        typedef std::function<void ()> COnPQListenerConnected;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * A dedicated non-blocking libpq connection that LISTENs on a set of channels. The pool cannot be used:
+         * its connections are shared between queries and never wait for notifications.
+         *
+         * Poll() never blocks, call it from Heartbeat(). OnConnected fires after every (re)connect and LISTEN:
+         * notifications sent while the connection was down are lost, so caches must be dropped there.
+         */
+        class CPQListener {
+        private:
+
+            typedef enum listener_status_e {
+                lsDisconnected = 0, lsConnecting, lsListening, lsReady
+            } CListenerStatus;
+
+            PGconn *m_pConnection;
+
+            CListenerStatus m_Status;
+
+            std::vector<std::pair<std::string, std::string>> m_Params;
+            std::vector<std::string> m_Channels;
+
+            time_t m_NextConnect;
+            int m_Failures;
+
+            COnPQListenerNotify m_OnNotify;
+            COnPQListenerConnected m_OnConnected;
+
+            void Connect();
+            void Disconnect(const char *Reason);
+
+            bool SendListen();
+            bool ConsumeResults();
+
+            void DoNotify();
+
+        public:
+
+            CPQListener(): m_pConnection(nullptr), m_Status(lsDisconnected), m_NextConnect(0), m_Failures(0) {
+
+            };
+
+            CPQListener(const CPQListener &) = delete;
+            CPQListener &operator=(const CPQListener &) = delete;
+
+            ~CPQListener();
+
+            void Param(const CString &Keyword, const CString &Value);
+            void Listen(const CString &Channel);
+
+            bool Active() const { return !m_Channels.empty() && !m_Params.empty(); }
+            bool Ready() const { return m_Status == lsReady; }
+
+            void Poll();
+
+            const COnPQListenerNotify &OnNotify() const { return m_OnNotify; }
+            void OnNotify(COnPQListenerNotify && Value) { m_OnNotify = Value; }
+
+            const COnPQListenerConnected &OnConnected() const { return m_OnConnected; }
+            void OnConnected(COnPQListenerConnected && Value) { m_OnConnected = Value; }
+
+        };
+
+    }
+}
+
+using namespace Apostol::Common;
+}
+#endif //APOSTOL_PQLISTENER_HPP
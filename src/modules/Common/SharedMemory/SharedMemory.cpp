@@ -0,0 +1,204 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  SharedMemory.cpp
+
+Notices:
+
+  Common: Shared memory between processes
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "SharedMemory.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <climits>
+#include <functional>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define SNAPSHOT_READ_ATTEMPTS 1000
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Common {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CSharedMemory ---------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        CSharedMemory::~CSharedMemory() {
+            Close();
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CString CSharedMemory::MakeName(LPCTSTR Tag) {
+            TCHAR szName[NAME_MAX] = {0};
+            const auto Hash = std::hash<std::string>()(std::string(Config()->Prefix().c_str()));
+            snprintf(szName, sizeof(szName), "/apostol.%u.%zx.%s", (unsigned) getuid(), Hash, Tag);
+            return CString(szName);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CSharedMemory::Open(LPCTSTR Tag, size_t Size) {
+            Close();
+
+            m_Name = MakeName(Tag);
+
+            m_Handle = shm_open(m_Name.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+            if (m_Handle == -1)
+                throw ExceptionFrm(_T("Could not open shared memory \"%s\": %s"), m_Name.c_str(), strerror(errno));
+
+            struct stat Stat = {};
+            if (fstat(m_Handle, &Stat) == -1 || ((size_t) Stat.st_size < Size && ftruncate(m_Handle, (off_t) Size) == -1)) {
+                const auto Error = errno;
+                Close();
+                throw ExceptionFrm(_T("Could not resize shared memory \"%s\": %s"), m_Name.c_str(), strerror(Error));
+            }
+
+            auto pData = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, m_Handle, 0);
+            if (pData == MAP_FAILED) {
+                const auto Error = errno;
+                Close();
+                throw ExceptionFrm(_T("Could not map shared memory \"%s\": %s"), m_Name.c_str(), strerror(Error));
+            }
+
+            m_pData = pData;
+            m_Size = Size;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CSharedMemory::Close() {
+            if (m_pData != nullptr) {
+                munmap(m_pData, m_Size);
+                m_pData = nullptr;
+            }
+
+            if (m_Handle != -1) {
+                close(m_Handle);
+                m_Handle = -1;
+            }
+
+            m_Size = 0;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CSharedMemory::Unlink() {
+            if (!m_Name.IsEmpty())
+                shm_unlink(m_Name.c_str());
+        }
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CSharedSnapshot -------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CSharedSnapshot::Open(LPCTSTR Tag, size_t Capacity) {
+            m_Memory.Open(Tag, sizeof(CSharedSnapshotHeader) + Capacity);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        uint64_t CSharedSnapshot::Sequence() const {
+            if (!Active())
+                return 0;
+            return __atomic_load_n(&Header()->Sequence, __ATOMIC_ACQUIRE);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CSharedSnapshot::Retired() const {
+            if (!Active())
+                return false;
+            return __atomic_load_n(&Header()->Retired, __ATOMIC_ACQUIRE) != 0;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CSharedSnapshot::Retire() {
+            if (!Active())
+                return;
+
+            // A writer that has opened the same memory in the meantime moves on to a new one as well.
+            __atomic_store_n(&Header()->Retired, (uint64_t) 1, __ATOMIC_RELEASE);
+
+            m_Memory.Unlink();
+            m_Memory.Close();
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CSharedSnapshot::Write(const std::string &Data) {
+            if (!Active() || Data.size() > Capacity())
+                return false;
+
+            auto pHeader = Header();
+
+            auto Sequence = __atomic_load_n(&pHeader->Sequence, __ATOMIC_RELAXED);
+            if (Sequence & 1) // the previous writer died in the middle of a write
+                Sequence++;
+
+            __atomic_store_n(&pHeader->Sequence, Sequence + 1, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+
+            memcpy(Body(), Data.data(), Data.size());
+            __atomic_store_n(&pHeader->Length, (uint64_t) Data.size(), __ATOMIC_RELAXED);
+
+            __atomic_store_n(&pHeader->Sequence, Sequence + 2, __ATOMIC_RELEASE);
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CSharedSnapshot::Read(std::string &Data, uint64_t &Sequence) const {
+            if (!Active())
+                return false;
+
+            const auto pHeader = Header();
+
+            for (int Attempt = 0; Attempt < SNAPSHOT_READ_ATTEMPTS; ++Attempt) {
+                const auto Begin = __atomic_load_n(&pHeader->Sequence, __ATOMIC_ACQUIRE);
+
+                if (Begin & 1) {
+                    sched_yield();
+                    continue;
+                }
+
+                const auto Length = __atomic_load_n(&pHeader->Length, __ATOMIC_RELAXED);
+                if (Length <= Capacity())
+                    Data.assign(Body(), Length);
+
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+                if (Length <= Capacity() && __atomic_load_n(&pHeader->Sequence, __ATOMIC_RELAXED) == Begin) {
+                    Sequence = Begin;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    }
+}
+}
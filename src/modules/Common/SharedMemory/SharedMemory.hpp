@@ -0,0 +1,140 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  SharedMemory.hpp
+
+Notices:
+
+  Common: Shared memory between processes
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_SHAREDMEMORY_HPP
+#define APOSTOL_SHAREDMEMORY_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <cstdint>
+#include <string>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Common {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CSharedMemory ---------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * POSIX shared memory object mapped into the process. All processes of one instance (same prefix) that
+         * open the same tag share the same memory.
+         */
+        class CSharedMemory {
+        private:
+
+            CString m_Name;
+
+            size_t m_Size;
+
+            int m_Handle;
+            void *m_pData;
+
+        public:
+
+            CSharedMemory(): m_Size(0), m_Handle(-1), m_pData(nullptr) {
+
+            };
+
+            CSharedMemory(const CSharedMemory &) = delete;
+            CSharedMemory &operator=(const CSharedMemory &) = delete;
+
+            ~CSharedMemory();
+
+            void Open(LPCTSTR Tag, size_t Size);
+            void Close();
+
+            // Removes the name, processes that have the memory open keep it until they close it.
+            void Unlink();
+
+            bool Active() const { return m_pData != nullptr; }
+
+            const CString &Name() const { return m_Name; }
+
+            size_t Size() const { return m_Size; }
+
+            void *Data() const { return m_pData; }
+
+            static CString MakeName(LPCTSTR Tag);
+
+        };
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CSharedSnapshot -------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct shared_snapshot_header_s {
+            uint64_t Sequence;
+            uint64_t Length;
+            uint64_t Retired;     // the name has been removed, readers must open it again
+        } CSharedSnapshotHeader;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * A blob published by one writer and copied out by any number of readers without locks (seqlock).
+         * Sequence is odd while a write is in progress, zero until the first write.
+         */
+        class CSharedSnapshot {
+        private:
+
+            CSharedMemory m_Memory;
+
+            CSharedSnapshotHeader *Header() const { return (CSharedSnapshotHeader *) m_Memory.Data(); }
+            char *Body() const { return (char *) m_Memory.Data() + sizeof(CSharedSnapshotHeader); }
+
+        public:
+
+            CSharedSnapshot() = default;
+
+            void Open(LPCTSTR Tag, size_t Capacity);
+            void Close() { m_Memory.Close(); }
+
+            bool Active() const { return m_Memory.Active(); }
+
+            size_t Capacity() const { return Active() ? m_Memory.Size() - sizeof(CSharedSnapshotHeader) : 0; }
+
+            uint64_t Sequence() const;
+
+            bool Retired() const;
+
+            // Marks the snapshot as retired and removes its name (the writer is going away).
+            void Retire();
+
+            bool Write(const std::string &Data);
+            bool Read(std::string &Data, uint64_t &Sequence) const;
+
+        };
+
+    }
+}
+
+using namespace Apostol::Common;
+}
+#endif //APOSTOL_SHAREDMEMORY_HPP
@@ -0,0 +1,191 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  SlotTable.cpp
+
+Notices:
+
+  Common: Fixed size records in shared memory
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "SlotTable.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <csignal>
+#include <sched.h>
+#include <unistd.h>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define SLOT_LOCK_ATTEMPTS 100000
+#define SLOT_READ_ATTEMPTS 1000
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Common {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CSlotTable ------------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CSlotTable::Open(LPCTSTR Tag, size_t Count, size_t RecordSize) {
+            m_RecordSize = RecordSize < sizeof(CSharedSlot) ? sizeof(CSharedSlot) : RecordSize;
+            m_Memory.Open(Tag, (Count == 0 ? 1 : Count) * m_RecordSize);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CSharedSlot *CSlotTable::Find(uint32_t KeyHash, size_t Probes,
+                const std::function<bool (const CSharedSlot *Slot)> &Match) const {
+
+            const auto Records = Count();
+
+            for (size_t i = 0; i < Probes && i < Records; ++i) {
+                auto Slot = Probe(KeyHash, i);
+
+                if (__atomic_load_n(&Slot->Hash, __ATOMIC_ACQUIRE) != KeyHash)
+                    continue;
+
+                if (Match(Slot))
+                    return Slot;
+            }
+
+            return nullptr;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CSharedSlot *CSlotTable::Vacant(uint32_t KeyHash, size_t Probes,
+                const std::function<bool (const CSharedSlot *Slot, uint64_t &Order)> &Order, bool &Evicted) const {
+
+            const auto Records = Count();
+
+            CSharedSlot *Oldest = nullptr;
+            uint64_t OldestOrder = 0;
+
+            Evicted = false;
+
+            for (size_t i = 0; i < Probes && i < Records; ++i) {
+                auto Slot = Probe(KeyHash, i);
+
+                if (__atomic_load_n(&Slot->Hash, __ATOMIC_ACQUIRE) == 0)
+                    return Slot;
+
+                uint64_t Value = 0;
+                if (!Order(Slot, Value))
+                    continue;
+
+                if (Value == 0)
+                    return Slot;
+
+                if (Oldest == nullptr || Value < OldestOrder) {
+                    Oldest = Slot;
+                    OldestOrder = Value;
+                }
+            }
+
+            Evicted = Oldest != nullptr;
+
+            return Oldest;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        uint32_t CSlotTable::Hash(const void *Data, size_t Length, uint32_t Basis) {
+            uint32_t Result = Basis;
+            for (size_t i = 0; i < Length; ++i) {
+                Result ^= ((const unsigned char *) Data)[i];
+                Result *= 16777619u;
+            }
+            return Result == 0 ? 1 : Result;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CSlotTable::Lock(CSharedSlot *Slot) {
+            const auto Self = (uint32_t) getpid();
+
+            for (int Attempt = 0; Attempt < SLOT_LOCK_ATTEMPTS; ++Attempt) {
+                uint32_t Owner = 0;
+
+                if (__atomic_compare_exchange_n(&Slot->Lock, &Owner, Self, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                    return true;
+
+                if (kill((pid_t) Owner, 0) == -1 && errno == ESRCH) {
+                    if (__atomic_compare_exchange_n(&Slot->Lock, &Owner, Self, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                        // The owner died in the middle of a write.
+                        if (__atomic_load_n(&Slot->Sequence, __ATOMIC_RELAXED) & 1)
+                            EndWrite(Slot);
+                        return true;
+                    }
+                    continue;
+                }
+
+                sched_yield();
+            }
+
+            return false;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CSlotTable::Unlock(CSharedSlot *Slot) {
+            __atomic_store_n(&Slot->Lock, 0, __ATOMIC_RELEASE);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CSlotTable::BeginWrite(CSharedSlot *Slot) {
+            const auto Sequence = __atomic_load_n(&Slot->Sequence, __ATOMIC_RELAXED);
+            __atomic_store_n(&Slot->Sequence, Sequence + 1, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CSlotTable::EndWrite(CSharedSlot *Slot) {
+            const auto Sequence = __atomic_load_n(&Slot->Sequence, __ATOMIC_RELAXED);
+            __atomic_store_n(&Slot->Sequence, Sequence + 1, __ATOMIC_RELEASE);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CSlotTable::Read(const CSharedSlot *Slot, const std::function<void ()> &Copy) {
+            for (int Attempt = 0; Attempt < SLOT_READ_ATTEMPTS; ++Attempt) {
+                const auto Begin = __atomic_load_n(&Slot->Sequence, __ATOMIC_ACQUIRE);
+
+                if (Begin & 1) {
+                    sched_yield();
+                    continue;
+                }
+
+                Copy();
+
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+                if (__atomic_load_n(&Slot->Sequence, __ATOMIC_RELAXED) == Begin)
+                    return true;
+            }
+
+            return false;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CSlotTable::Read(const CSharedSlot *Slot, void *Copy, size_t Size) {
+            return Read(Slot, [Slot, Copy, Size]() { memcpy(Copy, Slot, Size); });
+        }
+
+    }
+}
+}
@@ -0,0 +1,124 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  SlotTable.hpp
+
+Notices:
+
+  Common: Fixed size records in shared memory
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_SLOTTABLE_HPP
+#define APOSTOL_SLOTTABLE_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <cstdint>
+#include <functional>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define SLOT_HASH_BASIS 2166136261u
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Common {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CSlotTable ------------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct shared_slot_s {
+            uint32_t Lock;        // pid of the writer, 0 - free
+            uint32_t Sequence;    // odd while the slot is being written
+            uint32_t Hash;        // of the key, 0 - empty slot
+        } CSharedSlot;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Records of RecordSize bytes in shared memory, each one starting with a CSharedSlot. Readers copy a record
+         * under its seqlock and never lock, writers take a per-record lock (a lock held by a dead process is taken
+         * over). A key starts its probe sequence at its hash; how far it goes and which record gives way is up to
+         * the table.
+         */
+        class CSlotTable {
+        private:
+
+            CSharedMemory m_Memory;
+
+            size_t m_RecordSize;
+
+        public:
+
+            CSlotTable(): m_RecordSize(sizeof(CSharedSlot)) {
+
+            };
+
+            void Open(LPCTSTR Tag, size_t Count, size_t RecordSize);
+            void Close() { m_Memory.Close(); }
+
+            bool Active() const { return m_Memory.Active(); }
+
+            size_t RecordSize() const { return m_RecordSize; }
+
+            size_t Count() const { return Active() ? m_Memory.Size() / m_RecordSize : 0; }
+
+            CSharedSlot *Slot(size_t Index) const {
+                return (CSharedSlot *) ((char *) m_Memory.Data() + Index * m_RecordSize);
+            }
+
+            // The Index-th record of the probe sequence of KeyHash.
+            CSharedSlot *Probe(uint32_t KeyHash, size_t Index) const {
+                return Slot(((size_t) KeyHash % Count() + Index) % Count());
+            }
+
+            /**
+             * The record of the key within Probes records of its hash, an empty record does not end the search.
+             * @param Match Tells whether a record with the same hash holds the key.
+             */
+            CSharedSlot *Find(uint32_t KeyHash, size_t Probes, const std::function<bool (const CSharedSlot *Slot)> &Match) const;
+
+            /**
+             * A record for a new key within Probes records of its hash: an empty one, one that is free by Order
+             * (0), or else the one with the smallest Order, in which case Evicted is set.
+             * @param Order Tells the order of a taken record, false if it could not be read.
+             */
+            CSharedSlot *Vacant(uint32_t KeyHash, size_t Probes,
+                const std::function<bool (const CSharedSlot *Slot, uint64_t &Order)> &Order, bool &Evicted) const;
+
+            // FNV-1a, never 0 (the hash of an empty record). Basis chains the hashes of the parts of a key.
+            static uint32_t Hash(const void *Data, size_t Length, uint32_t Basis = SLOT_HASH_BASIS);
+
+            static bool Lock(CSharedSlot *Slot);
+            static void Unlock(CSharedSlot *Slot);
+
+            static void BeginWrite(CSharedSlot *Slot);
+            static void EndWrite(CSharedSlot *Slot);
+
+            // Runs Copy until it has seen the record between two writes.
+            static bool Read(const CSharedSlot *Slot, const std::function<void ()> &Copy);
+            static bool Read(const CSharedSlot *Slot, void *Copy, size_t Size);
+
+        };
+
+    }
+}
+
+using namespace Apostol::Common;
+}
+#endif //APOSTOL_SLOTTABLE_HPP
@@ -0,0 +1,125 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  WorkerChannel.cpp
+
+Notices:
+
+  Common: Messages between worker processes
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "WorkerChannel.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstddef>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Common {
+
+        static socklen_t ChannelAddress(pid_t Process, struct sockaddr_un &Address) {
+            TCHAR szTag[32] = {0};
+            snprintf(szTag, sizeof(szTag), "channel.%d", (int) Process);
+
+            const auto& Name = CSharedMemory::MakeName(szTag);
+
+            memset(&Address, 0, sizeof(Address));
+            Address.sun_family = AF_UNIX;
+
+            // Abstract namespace: sun_path starts with a zero byte.
+            const auto Length = std::min(Name.Length(), sizeof(Address.sun_path) - 1);
+            memcpy(Address.sun_path + 1, Name.c_str(), Length);
+
+            return (socklen_t) (offsetof(struct sockaddr_un, sun_path) + 1 + Length);
+        }
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CWorkerChannel --------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        CWorkerChannel::~CWorkerChannel() {
+            Close();
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWorkerChannel::Open() {
+            Close();
+
+            m_Handle = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (m_Handle == -1)
+                throw ExceptionFrm(_T("Could not create worker channel: %s"), strerror(errno));
+
+            struct sockaddr_un Address = {};
+            const auto Length = ChannelAddress(getpid(), Address);
+
+            if (bind(m_Handle, (struct sockaddr *) &Address, Length) == -1) {
+                const auto Error = errno;
+                Close();
+                throw ExceptionFrm(_T("Could not bind worker channel: %s"), strerror(Error));
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWorkerChannel::Close() {
+            if (m_Handle != -1) {
+                close(m_Handle);
+                m_Handle = -1;
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CWorkerChannel::Send(pid_t Process, const CString &Message) const {
+            if (!Active() || Message.Length() > WORKER_CHANNEL_MESSAGE_MAX)
+                return false;
+
+            struct sockaddr_un Address = {};
+            const auto Length = ChannelAddress(Process, Address);
+
+            return sendto(m_Handle, Message.c_str(), Message.Length(), MSG_DONTWAIT, (struct sockaddr *) &Address, Length) != -1;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CWorkerChannel::Receive(CString &Message) const {
+            if (!Active())
+                return false;
+
+            char Buffer[WORKER_CHANNEL_MESSAGE_MAX];
+
+            const auto Count = recv(m_Handle, Buffer, sizeof(Buffer), MSG_DONTWAIT);
+            if (Count <= 0)
+                return false;
+
+            Message.SetLength(Count);
+            memcpy((char *) Message.Data(), Buffer, Count);
+
+            return true;
+        }
+
+    }
+}
+}
@@ -0,0 +1,80 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  WorkerChannel.hpp
+
+Notices:
+
+  Common: Messages between worker processes
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WORKERCHANNEL_HPP
+#define APOSTOL_WORKERCHANNEL_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <sys/types.h>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define WORKER_CHANNEL_MESSAGE_MAX (64 * 1024)
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Common {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CWorkerChannel --------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Non-blocking datagram socket per process, addressed by pid (abstract unix socket, nothing on disk).
+         * A message is one datagram of at most WORKER_CHANNEL_MESSAGE_MAX bytes.
+         */
+        class CWorkerChannel {
+        private:
+
+            int m_Handle;
+
+        public:
+
+            CWorkerChannel(): m_Handle(-1) {
+
+            };
+
+            CWorkerChannel(const CWorkerChannel &) = delete;
+            CWorkerChannel &operator=(const CWorkerChannel &) = delete;
+
+            ~CWorkerChannel();
+
+            void Open();
+            void Close();
+
+            bool Active() const { return m_Handle != -1; }
+
+            bool Send(pid_t Process, const CString &Message) const;
+            bool Receive(CString &Message) const;
+
+        };
+
+    }
+}
+
+using namespace Apostol::Common;
+}
+#endif //APOSTOL_WORKERCHANNEL_HPP
@@ -25,12 +25,69 @@ Author:
 #include "CertificateDownloader.hpp"
 //----------------------------------------------------------------------------------------------------------------------
 
+#include <algorithm>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define JWKS_CONNECT_TIMEOUT 10L
+#define JWKS_TIMEOUT         30L
+#define JWKS_MIN_MAX_AGE     60
+#define JWKS_BACKOFF         5
+
 extern "C++" {
 
 namespace Apostol {
 
     namespace Helpers {
+#ifdef WITH_CURL
+        static size_t JwksWriteCallback(char *ptr, size_t size, size_t nmemb, void *userdata) {
+            auto Fetch = static_cast<CJwksFetch *>(userdata);
+            Fetch->Body.append(ptr, size * nmemb);
+            return size * nmemb;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        static size_t JwksHeaderCallback(char *buffer, size_t size, size_t nitems, void *userdata) {
+            auto Fetch = static_cast<CJwksFetch *>(userdata);
+
+            const size_t Length = size * nitems;
+            const std::string Line(buffer, Length);
+
+            // A new status line: the previous headers belonged to a redirect.
+            if (Line.compare(0, 5, "HTTP/") == 0) {
+                Fetch->ResponseETag.clear();
+                Fetch->MaxAge = -1;
+                return Length;
+            }
+
+            const auto Colon = Line.find(':');
+            if (Colon == std::string::npos)
+                return Length;
 
+            std::string Name(Line, 0, Colon);
+            std::transform(Name.begin(), Name.end(), Name.begin(), ::tolower);
+
+            const auto First = Line.find_first_not_of(" \t", Colon + 1);
+            const auto Last = Line.find_last_not_of(" \t\r\n");
+            const std::string Value = First == std::string::npos || Last < First ? std::string() : Line.substr(First, Last - First + 1);
+
+            if (Name == "etag") {
+                Fetch->ResponseETag = Value;
+            } else if (Name == "cache-control") {
+                std::string Lower(Value);
+                std::transform(Lower.begin(), Lower.end(), Lower.begin(), ::tolower);
+                if (Lower.find("no-cache") != std::string::npos || Lower.find("no-store") != std::string::npos) {
+                    Fetch->MaxAge = 0;
+                } else {
+                    const auto Pos = Lower.find("max-age=");
+                    if (Pos != std::string::npos)
+                        Fetch->MaxAge = (int) strtol(Lower.c_str() + Pos + 8, nullptr, 10);
+                }
+            }
+
+            return Length;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+#endif
         //--------------------------------------------------------------------------------------------------------------
 
         //-- CCertificateDownloader ------------------------------------------------------------------------------------
@@ -39,10 +96,29 @@ namespace Apostol {
 
         CCertificateDownloader::CCertificateDownloader(CModuleProcess *AProcess) : CApostolModule(AProcess, "certificate downloader") {
             m_SyncPeriod = 30;
+#ifdef WITH_CURL
+            m_Multi = curl_multi_init();
+#endif
             CCertificateDownloader::InitMethods();
         }
         //--------------------------------------------------------------------------------------------------------------
 
+        CCertificateDownloader::~CCertificateDownloader() {
+            m_KeySegment.Retire();
+#ifdef WITH_CURL
+            for (auto& Item : m_Fetches) {
+                auto& Fetch = Item.second;
+                if (Fetch.Handle != nullptr) {
+                    curl_multi_remove_handle(m_Multi, Fetch.Handle);
+                    curl_easy_cleanup(Fetch.Handle);
+                }
+                curl_slist_free_all(Fetch.Headers);
+            }
+            curl_multi_cleanup(m_Multi);
+#endif
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
         void CCertificateDownloader::InitMethods() {
 #if defined(_GLIBCXX_RELEASE) && (_GLIBCXX_RELEASE >= 9)
             m_pMethods->AddObject(_T("OPTIONS"), (CObject *) new CMethodHandler(true , [this](auto && Connection) { DoOptions(Connection); }));
@@ -86,34 +162,161 @@ namespace Apostol {
 #ifdef WITH_CURL
             const auto& URI = Key.CertURI();
 
+            auto& Fetch = m_Fetches[Key.Provider.c_str()];
+
             if (URI.IsEmpty()) {
                 Log()->Error(APP_LOG_WARN, 0, _T("Certificate URI is empty."));
+                Fetch.NextTime = Now() + (CDateTime) (m_SyncPeriod * 60 / 86400);
+                return;
+            }
+
+            if (Fetch.Handle != nullptr) {
+                Key.Status = CAuthParam::ksFetching;
                 return;
             }
 
             Log()->Debug(0, _T("Trying to fetch public keys from: %s"), URI.c_str());
 
-            CString jsonString;
+            Fetch.Provider = Key.Provider.c_str();
+            Fetch.Body.clear();
+            Fetch.ResponseETag.clear();
+            Fetch.MaxAge = -1;
 
-            try {
-                m_Curl.Reset();
-                m_Curl.Send(URI, jsonString);
+            Fetch.Handle = curl_easy_init();
+            if (Fetch.Handle == nullptr) {
+                Log()->Error(APP_LOG_EMERG, 0, _T("[CURL] Could not create handle (%s)."), URI.c_str());
+                return;
+            }
+
+            Fetch.Headers = curl_slist_append(nullptr, "Accept: application/json");
+            if (!Fetch.ETag.empty())
+                Fetch.Headers = curl_slist_append(Fetch.Headers, ("If-None-Match: " + Fetch.ETag).c_str());
+
+            curl_easy_setopt(Fetch.Handle, CURLOPT_URL, URI.c_str());
+            curl_easy_setopt(Fetch.Handle, CURLOPT_HTTPHEADER, Fetch.Headers);
+            curl_easy_setopt(Fetch.Handle, CURLOPT_FOLLOWLOCATION, 1L);
+            curl_easy_setopt(Fetch.Handle, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(Fetch.Handle, CURLOPT_CONNECTTIMEOUT, JWKS_CONNECT_TIMEOUT);
+            curl_easy_setopt(Fetch.Handle, CURLOPT_TIMEOUT, JWKS_TIMEOUT);
+            curl_easy_setopt(Fetch.Handle, CURLOPT_ACCEPT_ENCODING, "");
+            curl_easy_setopt(Fetch.Handle, CURLOPT_WRITEFUNCTION, JwksWriteCallback);
+            curl_easy_setopt(Fetch.Handle, CURLOPT_WRITEDATA, &Fetch);
+            curl_easy_setopt(Fetch.Handle, CURLOPT_HEADERFUNCTION, JwksHeaderCallback);
+            curl_easy_setopt(Fetch.Handle, CURLOPT_HEADERDATA, &Fetch);
+            curl_easy_setopt(Fetch.Handle, CURLOPT_PRIVATE, &Fetch);
+
+            const auto Code = curl_multi_add_handle(m_Multi, Fetch.Handle);
+            if (Code != CURLM_OK) {
+                Log()->Error(APP_LOG_EMERG, 0, _T("[CURL] Failed: %s (%s)."), curl_multi_strerror(Code), URI.c_str());
+                curl_easy_cleanup(Fetch.Handle);
+                curl_slist_free_all(Fetch.Headers);
+                Fetch.Handle = nullptr;
+                Fetch.Headers = nullptr;
+                return;
+            }
+
+            Key.Status = CAuthParam::ksFetching;
+#endif
+        }
+        //--------------------------------------------------------------------------------------------------------------
+#ifdef WITH_CURL
+        void CCertificateDownloader::PerformFetches() {
+            int Running = 0;
+
+            const auto Code = curl_multi_perform(m_Multi, &Running);
+            if (Code != CURLM_OK) {
+                Log()->Error(APP_LOG_EMERG, 0, _T("[CURL] Failed: %s."), curl_multi_strerror(Code));
+                return;
+            }
+
+            CURLMsg *Msg;
+            int Left = 0;
+
+            while ((Msg = curl_multi_info_read(m_Multi, &Left)) != nullptr) {
+                if (Msg->msg != CURLMSG_DONE)
+                    continue;
+
+                auto Handle = Msg->easy_handle;
+                const auto Result = Msg->data.result;
+
+                CJwksFetch *Fetch = nullptr;
+                long Status = 0;
+
+                curl_easy_getinfo(Handle, CURLINFO_PRIVATE, (char **) &Fetch);
+                curl_easy_getinfo(Handle, CURLINFO_RESPONSE_CODE, &Status);
+
+                curl_multi_remove_handle(m_Multi, Handle);
+                curl_easy_cleanup(Handle);
+
+                if (Fetch != nullptr) {
+                    curl_slist_free_all(Fetch->Headers);
+                    Fetch->Handle = nullptr;
+                    Fetch->Headers = nullptr;
+
+                    DoneFetch(*Fetch, Result, Status);
+                }
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CCertificateDownloader::DoneFetch(CJwksFetch &Fetch, CURLcode Result, long Code) {
+            auto& Params = Server().AuthParams();
+
+            for (int i = 0; i < Params.Count(); i++) {
+                auto& Key = Params[i].Value();
+
+                if (Fetch.Provider != Key.Provider.c_str())
+                    continue;
+
+                const auto SyncPeriod = (int) (m_SyncPeriod * 60);
 
                 Key.StatusTime = Now();
 
-                /* Check for errors */
-                if (m_Curl.Code() == CURLE_OK) {
-                    if (!jsonString.IsEmpty()) {
-                        Key.Keys << jsonString;
+                if (Result == CURLE_OK && (Code == 200 || Code == 304)) {
+                    int Period = Fetch.MaxAge < 0 ? SyncPeriod : std::max(Fetch.MaxAge, JWKS_MIN_MAX_AGE);
+                    Period = std::min(Period, SyncPeriod);
+
+                    Fetch.Failures = 0;
+                    Fetch.NextTime = Now() + (CDateTime) Period / 86400;
+
+                    if (Code == 304) {
+                        // The keys already published to the workers are still current.
+                        Key.Status = CAuthParam::ksSaved;
+                    } else if (!Fetch.Body.empty()) {
+                        Key.Keys.Clear();
+                        Key.Keys << Fetch.Body.c_str();
                         Key.Status = CAuthParam::ksSuccess;
+                        Fetch.ETag = Fetch.ResponseETag;
+                    } else {
+                        Key.Status = CAuthParam::ksError;
                     }
                 } else {
-                    Log()->Error(APP_LOG_EMERG, 0, _T("[CURL] Failed: %s (%s)."), m_Curl.GetErrorMessage().c_str(), URI.c_str());
+                    if (Result != CURLE_OK) {
+                        Log()->Error(APP_LOG_EMERG, 0, _T("[CURL] Failed: %s (%s)."), curl_easy_strerror(Result), Key.CertURI().c_str());
+                    } else {
+                        Log()->Error(APP_LOG_EMERG, 0, _T("[CURL] Failed: HTTP %ld (%s)."), Code, Key.CertURI().c_str());
+                    }
+
+                    const int Backoff = JWKS_BACKOFF << std::min(Fetch.Failures, 10);
+                    Fetch.Failures++;
+                    Fetch.NextTime = Now() + (CDateTime) std::min(Backoff, SyncPeriod) / 86400;
+
+                    Key.Status = CAuthParam::ksError;
                 }
-            } catch (Delphi::Exception::Exception &e) {
-                Log()->Error(APP_LOG_EMERG, 0, _T("[CURL] Error: %s"), e.what());
+
+                Fetch.Body.clear();
+                break;
             }
+        }
+        //--------------------------------------------------------------------------------------------------------------
 #endif
+        CDateTime CCertificateDownloader::NextTime(const CAuthParam &Key) const {
+#ifdef WITH_CURL
+            const auto it = m_Fetches.find(Key.Provider.c_str());
+            if (it != m_Fetches.end())
+                return it->second.NextTime;
+#endif
+            return Key.StatusTime + (CDateTime) (m_SyncPeriod * 60 / 86400);
         }
         //--------------------------------------------------------------------------------------------------------------
 
@@ -132,15 +335,24 @@ namespace Apostol {
 
         void CCertificateDownloader::CheckProviders() {
             auto& Params = Server().AuthParams();
+
+            // Another downloader has retired the segment this one opened: publish the keys into a new one.
+            bool Changed = m_KeySegment.Retired();
+            for (int i = 0; i < Params.Count(); i++) {
+                if (Params[i].Value().Status == CAuthParam::ksSuccess)
+                    Changed = true;
+            }
+
+            const auto Published = Changed && PublishKeys();
+
             for (int i = 0; i < Params.Count(); i++) {
                 auto& Key = Params[i].Value();
                 if (Key.Status == CAuthParam::ksSuccess) {
                     Key.StatusTime = Now();
-                    Key.Status = CAuthParam::ksSaved;
-                    SaveKeys(Key);
+                    Key.Status = Published ? CAuthParam::ksSaved : CAuthParam::ksError;
                 }
 
-                if (Key.Status != CAuthParam::ksUnknown && (Now() - Key.StatusTime >= (CDateTime) (m_SyncPeriod * 60 / 86400))) {
+                if (Key.Status != CAuthParam::ksUnknown && Key.Status != CAuthParam::ksFetching && Now() >= NextTime(Key)) {
                     Key.StatusTime = Now();
                     Key.Status = CAuthParam::ksUnknown;
                 }
@@ -148,23 +360,28 @@ namespace Apostol {
         }
         //--------------------------------------------------------------------------------------------------------------
 
-        void CCertificateDownloader::SaveKeys(const CAuthParam &Key) {
-            const CString pathCerts = Config()->Prefix() + _T("certs/");
-            const CString lockFile = pathCerts + "lock";
-            if (!FileExists(lockFile.c_str())) {
-                CFile Lock(lockFile.c_str(), FILE_CREATE_OR_OPEN);
-                Lock.Open();
-                Key.Keys.SaveToFile(CString(pathCerts + Key.Provider).c_str());
-                Lock.Close(true);
-                if (unlink(lockFile.c_str()) == FILE_ERROR) {
-                    Log()->Error(APP_LOG_ALERT, errno, _T("Could not delete file: \"%s\" error: "), lockFile.c_str());
-                }
+        bool CCertificateDownloader::PublishKeys() {
+            try {
+                if (!m_KeySegment.Active() || m_KeySegment.Retired())
+                    m_KeySegment.Open();
+
+                if (m_KeySegment.Publish(Server().AuthParams()))
+                    return true;
+
+                Log()->Error(APP_LOG_ALERT, 0, _T("Provider keys do not fit into shared memory (%d bytes)."), KEY_SEGMENT_CAPACITY);
+            } catch (std::exception &e) {
+                Log()->Error(APP_LOG_ALERT, 0, e.what());
             }
+
+            return false;
         }
         //--------------------------------------------------------------------------------------------------------------
 
         void CCertificateDownloader::Heartbeat() {
             FetchProviders();
+#ifdef WITH_CURL
+            PerformFetches();
+#endif
             CheckProviders();
         }
         //--------------------------------------------------------------------------------------------------------------
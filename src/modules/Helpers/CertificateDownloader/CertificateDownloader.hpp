@@ -25,6 +25,14 @@ Author:
 #define APOSTOL_CERTIFICATEDOWNLOADER_HPP
 //----------------------------------------------------------------------------------------------------------------------
 
+#include <map>
+#include <string>
+//----------------------------------------------------------------------------------------------------------------------
+#ifdef WITH_CURL
+#include <curl/curl.h>
+//----------------------------------------------------------------------------------------------------------------------
+#endif
+
 extern "C++" {
 
 namespace Apostol {
@@ -36,20 +44,46 @@ namespace Apostol {
         //-- CCertificateDownloader ------------------------------------------------------------------------------------
 
         //--------------------------------------------------------------------------------------------------------------
+#ifdef WITH_CURL
+        typedef struct jwks_fetch_s {
+            CURL *Handle = nullptr;
+            struct curl_slist *Headers = nullptr;
+
+            std::string Provider;
+            std::string Body;
+
+            std::string ETag;
+            std::string ResponseETag;
 
+            int MaxAge = -1;
+            int Failures = 0;
+
+            CDateTime NextTime = 0;
+        } CJwksFetch;
+        //--------------------------------------------------------------------------------------------------------------
+#endif
         class CCertificateDownloader: public CApostolModule {
         private:
 #ifdef WITH_CURL
-            CCurlApi m_Curl;
+            CURLM *m_Multi;
+
+            std::map<std::string, CJwksFetch> m_Fetches;
+
+            void PerformFetches();
+            void DoneFetch(CJwksFetch &Fetch, CURLcode Result, long Code);
 #endif
             CDateTime m_SyncPeriod;
 
+            CKeySegment m_KeySegment;
+
+            CDateTime NextTime(const CAuthParam &Key) const;
+
             void FetchCerts(CAuthParam &Key);
 
             void FetchProviders();
             void CheckProviders();
 
-            static void SaveKeys(const CAuthParam &Key);
+            bool PublishKeys();
 
             void InitMethods() override;
 
@@ -62,7 +96,7 @@ namespace Apostol {
 
             explicit CCertificateDownloader(CModuleProcess *AProcess);
 
-            ~CCertificateDownloader() override = default;
+            ~CCertificateDownloader() override;
 
             static class CCertificateDownloader *CreateModule(CModuleProcess *AProcess) {
                 return new CCertificateDownloader(AProcess);
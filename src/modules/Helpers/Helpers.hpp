@@ -26,10 +26,14 @@ Author:
 //----------------------------------------------------------------------------------------------------------------------
 
 #include "CertificateDownloader/CertificateDownloader.hpp"
+#include "LogWriter/LogWriter.hpp"
+#include "PartitionManager/PartitionManager.hpp"
 //----------------------------------------------------------------------------------------------------------------------
 
 static inline void CreateHelpers(CModuleProcess *AProcess) {
     CCertificateDownloader::CreateModule(AProcess);
+    CLogWriter::CreateModule(AProcess);
+    CPartitionManager::CreateModule(AProcess);
 }
 
 #endif //APOSTOL_HELPERS_HPP
@@ -0,0 +1,217 @@
+/*++
+
+Library name:
+
+  apostol-core
+
+Module Name:
+
+  LogWriter.cpp
+
+Notices:
+
+  Apostol application
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#include "Core.hpp"
+#include "LogWriter.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Helpers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CLogWriter ------------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        CLogWriter::CLogWriter(CModuleProcess *AProcess) : CApostolModule(AProcess, "log writer") {
+            m_Configured = false;
+            m_Async = false;
+            m_Size = 16384;
+            m_RecordSize = 4096;
+            m_BatchCount = 1000;
+            m_Attempts = 0;
+            m_InFlight = false;
+
+            CLogWriter::InitMethods();
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CLogWriter::InitMethods() {
+#if defined(_GLIBCXX_RELEASE) && (_GLIBCXX_RELEASE >= 9)
+            m_pMethods->AddObject(_T("OPTIONS"), (CObject *) new CMethodHandler(true , [this](auto && Connection) { DoOptions(Connection); }));
+            m_pMethods->AddObject(_T("HEAD")   , (CObject *) new CMethodHandler(true , [this](auto && Connection) { DoHead(Connection); }));
+            m_pMethods->AddObject(_T("GET")    , (CObject *) new CMethodHandler(false, [this](auto && Connection) { DoGet(Connection); }));
+            m_pMethods->AddObject(_T("POST")   , (CObject *) new CMethodHandler(false, [this](auto && Connection) { MethodNotAllowed(Connection); }));
+            m_pMethods->AddObject(_T("PUT")    , (CObject *) new CMethodHandler(false, [this](auto && Connection) { MethodNotAllowed(Connection); }));
+            m_pMethods->AddObject(_T("DELETE") , (CObject *) new CMethodHandler(false, [this](auto && Connection) { MethodNotAllowed(Connection); }));
+            m_pMethods->AddObject(_T("TRACE")  , (CObject *) new CMethodHandler(false, [this](auto && Connection) { MethodNotAllowed(Connection); }));
+            m_pMethods->AddObject(_T("PATCH")  , (CObject *) new CMethodHandler(false, [this](auto && Connection) { MethodNotAllowed(Connection); }));
+            m_pMethods->AddObject(_T("CONNECT"), (CObject *) new CMethodHandler(false, [this](auto && Connection) { MethodNotAllowed(Connection); }));
+#else
+            m_pMethods->AddObject(_T("OPTIONS"), (CObject *) new CMethodHandler(true, std::bind(&CLogWriter::DoOptions, this, _1)));
+            m_pMethods->AddObject(_T("HEAD"), (CObject *) new CMethodHandler(true, std::bind(&CLogWriter::DoHead, this, _1)));
+            m_pMethods->AddObject(_T("GET"), (CObject *) new CMethodHandler(false, std::bind(&CLogWriter::DoGet, this, _1)));
+            m_pMethods->AddObject(_T("POST"), (CObject *) new CMethodHandler(false, std::bind(&CLogWriter::MethodNotAllowed, this, _1)));
+            m_pMethods->AddObject(_T("PUT"), (CObject *) new CMethodHandler(false, std::bind(&CLogWriter::MethodNotAllowed, this, _1)));
+            m_pMethods->AddObject(_T("DELETE"), (CObject *) new CMethodHandler(false, std::bind(&CLogWriter::MethodNotAllowed, this, _1)));
+            m_pMethods->AddObject(_T("TRACE"), (CObject *) new CMethodHandler(false, std::bind(&CLogWriter::MethodNotAllowed, this, _1)));
+            m_pMethods->AddObject(_T("PATCH"), (CObject *) new CMethodHandler(false, std::bind(&CLogWriter::MethodNotAllowed, this, _1)));
+            m_pMethods->AddObject(_T("CONNECT"), (CObject *) new CMethodHandler(false, std::bind(&CLogWriter::MethodNotAllowed, this, _1)));
+#endif
+        }
+        //--------------------------------------------------------------------------------------------------------------
+#ifdef WITH_POSTGRESQL
+        void CLogWriter::DoPostgresQueryExecuted(CPQPollQuery *APollQuery) {
+
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CLogWriter::DoPostgresQueryException(CPQPollQuery *APollQuery, Delphi::Exception::Exception *AException) {
+
+        }
+        //--------------------------------------------------------------------------------------------------------------
+#endif
+        void CLogWriter::Open() {
+            CIniFile IniFile(Config()->ConfFile().c_str());
+
+            m_Async = IniFile.ReadBool(_T("postgres/log"), _T("async"), false);
+            m_Size = (uint32_t) IniFile.ReadInteger(_T("postgres/log"), _T("size"), (int) m_Size);
+            m_RecordSize = (uint32_t) IniFile.ReadInteger(_T("postgres/log"), _T("record"), (int) m_RecordSize);
+            m_BatchCount = IniFile.ReadInteger(_T("postgres/log"), _T("batch"), m_BatchCount);
+
+            if (!m_Async)
+                return;
+
+            try {
+                m_Ring.Open(m_Size, m_RecordSize);
+            } catch (std::exception &e) {
+                Log()->Error(APP_LOG_ALERT, 0, e.what());
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CLogWriter::Reject() {
+            m_Attempts = 0;
+
+            if (m_Batch.size() > 1) {
+                const auto Half = m_Batch.size() / 2;
+
+                m_Held.insert(m_Held.begin(), m_Batch.begin() + (long) Half, m_Batch.end());
+                m_Batch.resize(Half);
+
+                Log()->Error(APP_LOG_WARN, 0, "[LogWriter] Batch rejected %d times, split into %d and %d records.",
+                             LOG_WRITER_ATTEMPTS, (int) m_Batch.size(), (int) m_Held.size());
+                return;
+            }
+
+            if (!m_Batch.empty()) {
+                Log()->Error(APP_LOG_ALERT, 0, "[LogWriter] Record rejected %d times, dropped: %.256s",
+                             LOG_WRITER_ATTEMPTS, m_Batch.front().c_str());
+                m_Batch.clear();
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CLogWriter::Flush() {
+
+            if (m_InFlight)
+                return;
+
+            if (m_Batch.empty()) {
+                const auto Count = m_Held.size() < (size_t) m_BatchCount ? m_Held.size() : (size_t) m_BatchCount;
+
+                m_Batch.assign(m_Held.begin(), m_Held.begin() + (long) Count);
+                m_Held.erase(m_Held.begin(), m_Held.begin() + (long) Count);
+
+                std::string Record;
+                while (m_Batch.size() < (size_t) m_BatchCount && m_Ring.Pop(Record, MsEpoch()))
+                    m_Batch.push_back(Record);
+
+                if (m_Batch.empty())
+                    return;
+
+                m_Attempts = 0;
+            }
+
+            auto OnExecuted = [this](CPQPollQuery *APollQuery) {
+                m_InFlight = false;
+
+                auto LResult = APollQuery->Results(0);
+                if (LResult->ExecStatus() != PGRES_TUPLES_OK) {
+                    Log()->Error(APP_LOG_WARN, 0, LResult->GetErrorMessage());
+                    // Only a rejected batch counts: while the database is away the batch waits for it.
+                    if (++m_Attempts >= LOG_WRITER_ATTEMPTS)
+                        Reject();
+                    return;
+                }
+
+                m_Batch.clear();
+                m_Attempts = 0;
+
+                Flush();
+            };
+
+            auto OnException = [this](CPQPollQuery *APollQuery, Delphi::Exception::Exception *AException) {
+                m_InFlight = false;
+                Log()->Error(APP_LOG_WARN, 0, AException->what());
+            };
+
+            CString Batch(_T("["));
+            for (size_t i = 0; i < m_Batch.size(); ++i) {
+                if (i > 0)
+                    Batch.Append(',');
+                Batch << m_Batch[i].c_str();
+            }
+            Batch.Append(']');
+
+            CStringList SQL;
+
+            SQL.Add(CString("SELECT daemon.WriteLog(") << PQQuoteLiteral(Batch) << "::jsonb);");
+
+            try {
+                m_InFlight = ExecSQL(SQL, nullptr, OnExecuted, OnException);
+            } catch (std::exception &e) {
+                Log()->Error(APP_LOG_WARN, 0, e.what());
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CLogWriter::Heartbeat() {
+            if (!m_Configured) {
+                m_Configured = true;
+                Open();
+            }
+
+            if (m_Ring.Active())
+                Flush();
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CLogWriter::IsEnabled() {
+            if (m_ModuleStatus == msUnknown)
+                m_ModuleStatus = msEnabled;
+            return m_ModuleStatus == msEnabled;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CLogWriter::CheckUserAgent(const CString& Value) {
+            return IsEnabled();
+        }
+    }
+}
+
+}
@@ -0,0 +1,104 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  LogWriter.hpp
+
+Notices:
+
+  Module Log Writer
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_LOGWRITER_HPP
+#define APOSTOL_LOGWRITER_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define LOG_WRITER_ATTEMPTS 3
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Helpers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CLogWriter ------------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Moves the api.log and ocpp.log records queued by the workers (see [postgres/log]) into the database with
+         * daemon.WriteLog, one batch at a time. A failed batch is retried before anything else is taken; a batch the
+         * database rejects LOG_WRITER_ATTEMPTS times is split in halves, until the record it refuses is dropped alone.
+         */
+        class CLogWriter: public CApostolModule {
+        private:
+
+            CLogRing m_Ring;
+
+            bool m_Configured;
+            bool m_Async;
+
+            uint32_t m_Size;
+            uint32_t m_RecordSize;
+
+            int m_BatchCount;
+
+            std::vector<std::string> m_Batch;
+            std::vector<std::string> m_Held;    // the rest of a split batch, written before the queue
+
+            int m_Attempts;
+
+            bool m_InFlight;
+
+            void Open();
+            void Flush();
+            void Reject();
+
+            void InitMethods() override;
+
+        protected:
+#ifdef WITH_POSTGRESQL
+            void DoPostgresQueryExecuted(CPQPollQuery *APollQuery) override;
+            void DoPostgresQueryException(CPQPollQuery *APollQuery, Delphi::Exception::Exception *AException) override;
+#endif
+        public:
+
+            explicit CLogWriter(CModuleProcess *AProcess);
+
+            ~CLogWriter() override = default;
+
+            static class CLogWriter *CreateModule(CModuleProcess *AProcess) {
+                return new CLogWriter(AProcess);
+            }
+
+            void Heartbeat() override;
+
+            bool IsEnabled() override;
+            bool CheckUserAgent(const CString& Value) override;
+
+        };
+
+    }
+}
+
+using namespace Apostol::Helpers;
+}
+#endif //APOSTOL_LOGWRITER_HPP
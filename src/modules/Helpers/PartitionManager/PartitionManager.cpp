@@ -0,0 +1,176 @@
+/*++
+
+Library name:
+
+  apostol-core
+
+Module Name:
+
+  PartitionManager.cpp
+
+Notices:
+
+  Apostol application
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#include "Core.hpp"
+#include "PartitionManager.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Helpers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CPartitionManager -----------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        CPartitionManager::CPartitionManager(CModuleProcess *AProcess) : CApostolModule(AProcess, "partition manager") {
+            m_Configured = false;
+            m_Enabled = true;
+            m_Interval = 60;
+            m_Ahead = 3;
+            m_OcppLogKeep = 0;
+            m_ApiLogKeep = 0;
+            m_MeterValueKeep = 0;
+            m_NextTime = 0;
+            m_InFlight = false;
+
+            CPartitionManager::InitMethods();
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CPartitionManager::InitMethods() {
+#if defined(_GLIBCXX_RELEASE) && (_GLIBCXX_RELEASE >= 9)
+            m_pMethods->AddObject(_T("OPTIONS"), (CObject *) new CMethodHandler(true , [this](auto && Connection) { DoOptions(Connection); }));
+            m_pMethods->AddObject(_T("HEAD")   , (CObject *) new CMethodHandler(true , [this](auto && Connection) { DoHead(Connection); }));
+            m_pMethods->AddObject(_T("GET")    , (CObject *) new CMethodHandler(false, [this](auto && Connection) { DoGet(Connection); }));
+            m_pMethods->AddObject(_T("POST")   , (CObject *) new CMethodHandler(false, [this](auto && Connection) { MethodNotAllowed(Connection); }));
+            m_pMethods->AddObject(_T("PUT")    , (CObject *) new CMethodHandler(false, [this](auto && Connection) { MethodNotAllowed(Connection); }));
+            m_pMethods->AddObject(_T("DELETE") , (CObject *) new CMethodHandler(false, [this](auto && Connection) { MethodNotAllowed(Connection); }));
+            m_pMethods->AddObject(_T("TRACE")  , (CObject *) new CMethodHandler(false, [this](auto && Connection) { MethodNotAllowed(Connection); }));
+            m_pMethods->AddObject(_T("PATCH")  , (CObject *) new CMethodHandler(false, [this](auto && Connection) { MethodNotAllowed(Connection); }));
+            m_pMethods->AddObject(_T("CONNECT"), (CObject *) new CMethodHandler(false, [this](auto && Connection) { MethodNotAllowed(Connection); }));
+#else
+            m_pMethods->AddObject(_T("OPTIONS"), (CObject *) new CMethodHandler(true, std::bind(&CPartitionManager::DoOptions, this, _1)));
+            m_pMethods->AddObject(_T("HEAD"), (CObject *) new CMethodHandler(true, std::bind(&CPartitionManager::DoHead, this, _1)));
+            m_pMethods->AddObject(_T("GET"), (CObject *) new CMethodHandler(false, std::bind(&CPartitionManager::DoGet, this, _1)));
+            m_pMethods->AddObject(_T("POST"), (CObject *) new CMethodHandler(false, std::bind(&CPartitionManager::MethodNotAllowed, this, _1)));
+            m_pMethods->AddObject(_T("PUT"), (CObject *) new CMethodHandler(false, std::bind(&CPartitionManager::MethodNotAllowed, this, _1)));
+            m_pMethods->AddObject(_T("DELETE"), (CObject *) new CMethodHandler(false, std::bind(&CPartitionManager::MethodNotAllowed, this, _1)));
+            m_pMethods->AddObject(_T("TRACE"), (CObject *) new CMethodHandler(false, std::bind(&CPartitionManager::MethodNotAllowed, this, _1)));
+            m_pMethods->AddObject(_T("PATCH"), (CObject *) new CMethodHandler(false, std::bind(&CPartitionManager::MethodNotAllowed, this, _1)));
+            m_pMethods->AddObject(_T("CONNECT"), (CObject *) new CMethodHandler(false, std::bind(&CPartitionManager::MethodNotAllowed, this, _1)));
+#endif
+        }
+        //--------------------------------------------------------------------------------------------------------------
+#ifdef WITH_POSTGRESQL
+        void CPartitionManager::DoPostgresQueryExecuted(CPQPollQuery *APollQuery) {
+
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CPartitionManager::DoPostgresQueryException(CPQPollQuery *APollQuery, Delphi::Exception::Exception *AException) {
+
+        }
+        //--------------------------------------------------------------------------------------------------------------
+#endif
+        void CPartitionManager::Open() {
+            CIniFile IniFile(Config()->ConfFile().c_str());
+
+            m_Enabled = IniFile.ReadBool(_T("postgres/partition"), _T("enable"), true);
+            m_Interval = IniFile.ReadInteger(_T("postgres/partition"), _T("interval"), m_Interval);
+            m_Ahead = IniFile.ReadInteger(_T("postgres/partition"), _T("ahead"), m_Ahead);
+            m_OcppLogKeep = IniFile.ReadInteger(_T("postgres/partition"), _T("ocpp_log"), m_OcppLogKeep);
+            m_ApiLogKeep = IniFile.ReadInteger(_T("postgres/partition"), _T("api_log"), m_ApiLogKeep);
+            m_MeterValueKeep = IniFile.ReadInteger(_T("postgres/partition"), _T("meter_value"), m_MeterValueKeep);
+
+            if (m_Interval < 1)
+                m_Interval = 1;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CPartitionManager::Check() {
+
+            auto OnExecuted = [this](CPQPollQuery *APollQuery) {
+                m_InFlight = false;
+
+                auto LResult = APollQuery->Results(0);
+                if (LResult->ExecStatus() != PGRES_TUPLES_OK) {
+                    Log()->Error(APP_LOG_WARN, 0, LResult->GetErrorMessage());
+                    return;
+                }
+
+                for (int Row = 0; Row < LResult->nTuples(); ++Row) {
+                    Log()->Error(APP_LOG_INFO, 0, "[Partition] %s", LResult->GetValue(Row, 0));
+                }
+            };
+
+            auto OnException = [this](CPQPollQuery *APollQuery, Delphi::Exception::Exception *AException) {
+                m_InFlight = false;
+                Log()->Error(APP_LOG_WARN, 0, AException->what());
+            };
+
+            CString Tables;
+
+            Tables.Format(R"([{"table": "ocpp.log", "period": "day", "ahead": %d, "keep": %d}, )"
+                          R"({"table": "api.log", "period": "day", "ahead": %d, "keep": %d}, )"
+                          R"({"table": "db.meter_value", "period": "month", "ahead": 1, "keep": %d}])",
+                          m_Ahead, m_OcppLogKeep, m_Ahead, m_ApiLogKeep, m_MeterValueKeep);
+
+            CStringList SQL;
+
+            SQL.Add(CString("SELECT * FROM daemon.CheckPartitions(") << PQQuoteLiteral(Tables) << "::jsonb);");
+
+            try {
+                m_InFlight = ExecSQL(SQL, nullptr, OnExecuted, OnException);
+            } catch (std::exception &e) {
+                Log()->Error(APP_LOG_WARN, 0, e.what());
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CPartitionManager::Heartbeat() {
+            if (!m_Configured) {
+                m_Configured = true;
+                Open();
+            }
+
+            if (!m_Enabled || m_InFlight)
+                return;
+
+            const auto now = Now();
+
+            if (now >= m_NextTime) {
+                m_NextTime = now + (CDateTime) m_Interval * 60 / 86400;
+                Check();
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CPartitionManager::IsEnabled() {
+            if (m_ModuleStatus == msUnknown)
+                m_ModuleStatus = msEnabled;
+            return m_ModuleStatus == msEnabled;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CPartitionManager::CheckUserAgent(const CString& Value) {
+            return IsEnabled();
+        }
+    }
+}
+
+}
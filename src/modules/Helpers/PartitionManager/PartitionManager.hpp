@@ -0,0 +1,93 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  PartitionManager.hpp
+
+Notices:
+
+  Module Partition Manager
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_PARTITIONMANAGER_HPP
+#define APOSTOL_PARTITIONMANAGER_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Helpers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CPartitionManager -----------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Keeps the partitions of ocpp.log, api.log (by day) and db.meter_value (by month) in shape: creates the
+         * next ones in advance and drops the expired ones with daemon.CheckPartitions (see [postgres/partition]).
+         */
+        class CPartitionManager: public CApostolModule {
+        private:
+
+            bool m_Configured;
+            bool m_Enabled;
+
+            int m_Interval;
+            int m_Ahead;
+
+            int m_OcppLogKeep;
+            int m_ApiLogKeep;
+            int m_MeterValueKeep;
+
+            CDateTime m_NextTime;
+
+            bool m_InFlight;
+
+            void Open();
+            void Check();
+
+            void InitMethods() override;
+
+        protected:
+#ifdef WITH_POSTGRESQL
+            void DoPostgresQueryExecuted(CPQPollQuery *APollQuery) override;
+            void DoPostgresQueryException(CPQPollQuery *APollQuery, Delphi::Exception::Exception *AException) override;
+#endif
+        public:
+
+            explicit CPartitionManager(CModuleProcess *AProcess);
+
+            ~CPartitionManager() override = default;
+
+            static class CPartitionManager *CreateModule(CModuleProcess *AProcess) {
+                return new CPartitionManager(AProcess);
+            }
+
+            void Heartbeat() override;
+
+            bool IsEnabled() override;
+            bool CheckUserAgent(const CString& Value) override;
+
+        };
+
+    }
+}
+
+using namespace Apostol::Helpers;
+}
+#endif //APOSTOL_PARTITIONMANAGER_HPP
@@ -25,6 +25,7 @@ Author:
 #define APOSTOL_MODULES_HPP
 //----------------------------------------------------------------------------------------------------------------------
 
+#include "Common/Common.hpp"
 #include "Workers/Workers.hpp"
 #include "Helpers/Helpers.hpp"
 //----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,127 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  BootQueue.cpp
+
+Notices:
+
+  Module WebService: BootNotification admission queue
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "BootQueue.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CBootQueue ------------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CBootQueue::Acquire() {
+            // Waiting boots go first.
+            if (m_Running >= m_Limit || !m_Queue.empty())
+                return false;
+
+            m_Running++;
+            m_Admitted++;
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CBootQueue::Release() {
+            if (m_Running > 0)
+                m_Running--;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CBootQueue::Push(const CBootRequest &Request) {
+            if (m_Queue.size() >= m_MaxCount) {
+                m_Deferred++;
+                return false;
+            }
+
+            m_Queue.push_back(Request);
+
+            if (m_Queue.size() > m_Peak)
+                m_Peak = m_Queue.size();
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CBootQueue::Next(CBootRequest &Request, uint64_t Now) {
+            if (m_Running >= m_Limit || m_Queue.empty())
+                return false;
+
+            if (Now - m_Queue.front().Epoch >= m_Wait)
+                return false;
+
+            Request = m_Queue.front();
+            m_Queue.pop_front();
+
+            m_Running++;
+            m_Admitted++;
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CBootQueue::Expired(CBootRequest &Request, uint64_t Now) {
+            if (m_Queue.empty() || Now - m_Queue.front().Epoch < m_Wait)
+                return false;
+
+            Request = m_Queue.front();
+            m_Queue.pop_front();
+
+            m_Deferred++;
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CBootQueue::Remove(CHTTPServerConnection *AConnection) {
+            for (auto it = m_Queue.begin(); it != m_Queue.end();) {
+                if (it->Connection == AConnection) {
+                    it = m_Queue.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        int CBootQueue::RetryInterval() {
+            if (m_Jitter == 0)
+                return m_Retry;
+
+            std::uniform_int_distribution<> Jitter(0, m_Jitter);
+
+            return m_Retry + Jitter(m_Random);
+        }
+
+    }
+}
+}
@@ -0,0 +1,131 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  BootQueue.hpp
+
+Notices:
+
+  Module WebService: BootNotification admission queue
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_BOOTQUEUE_HPP
+#define APOSTOL_WEBSERVICE_BOOTQUEUE_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <deque>
+#include <random>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CBootQueue ------------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct boot_request_s {
+            CHTTPServerConnection *Connection;
+            CWSMessage Request;
+            CString Identity;
+            CString Payload;
+            uint64_t Epoch;
+        } CBootRequest;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Admission control for BootNotification. At most Limit boots run in the database at a time, up to MaxCount
+         * more wait here for no longer than Wait ms. The rest get a "Pending" answer and retry in Retry + [0, Jitter]
+         * seconds, so that a site coming back after an outage does not take the whole connection pool.
+         */
+        class CBootQueue {
+        private:
+
+            std::deque<CBootRequest> m_Queue;
+
+            std::mt19937 m_Random;
+
+            bool m_Enabled;
+
+            size_t m_Limit;
+            size_t m_MaxCount;
+
+            uint64_t m_Wait;
+
+            int m_Retry;
+            int m_Jitter;
+
+            size_t m_Running;
+            size_t m_Peak;
+
+            size_t m_Admitted;
+            size_t m_Deferred;
+
+        public:
+
+            CBootQueue(): m_Random(std::random_device()()), m_Enabled(true), m_Limit(4), m_MaxCount(64), m_Wait(10000),
+                m_Retry(30), m_Jitter(90), m_Running(0), m_Peak(0), m_Admitted(0), m_Deferred(0) {
+
+            };
+
+            size_t Count() const { return m_Queue.size(); }
+            size_t Running() const { return m_Running; }
+            size_t Peak() const { return m_Peak; }
+
+            size_t Admitted() const { return m_Admitted; }
+            size_t Deferred() const { return m_Deferred; }
+
+            bool Enabled() const { return m_Enabled; }
+            void Enabled(bool Value) { m_Enabled = Value; }
+
+            size_t Limit() const { return m_Limit; }
+            void Limit(size_t Value) { m_Limit = Value == 0 ? 1 : Value; }
+
+            size_t MaxCount() const { return m_MaxCount; }
+            void MaxCount(size_t Value) { m_MaxCount = Value; }
+
+            uint64_t Wait() const { return m_Wait; }
+            void Wait(uint64_t Value) { m_Wait = Value; }
+
+            int Retry() const { return m_Retry; }
+            void Retry(int Value) { m_Retry = Value < 1 ? 1 : Value; }
+
+            int Jitter() const { return m_Jitter; }
+            void Jitter(int Value) { m_Jitter = Value < 0 ? 0 : Value; }
+
+            bool Acquire();
+            void Release();
+
+            bool Push(const CBootRequest &Request);
+            bool Next(CBootRequest &Request, uint64_t Now);
+            bool Expired(CBootRequest &Request, uint64_t Now);
+
+            void Remove(CHTTPServerConnection *AConnection);
+
+            int RetryInterval();
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_BOOTQUEUE_HPP
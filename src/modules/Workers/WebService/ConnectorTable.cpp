@@ -0,0 +1,200 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  ConnectorTable.cpp
+
+Notices:
+
+  Module WebService: Current connector status shared by workers
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "ConnectorTable.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        static void CopyString(char *Dest, size_t Size, const CString &Source) {
+            // A status text may be cut, it is only shown.
+            const auto Length = Source.Length() < Size ? Source.Length() : Size - 1;
+            memcpy(Dest, Source.c_str(), Length);
+            Dest[Length] = '\0';
+        }
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CConnectorTable -------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        uint32_t CConnectorTable::Hash(const CString &Identity, int ConnectorId) {
+            const auto Id = (uint32_t) ConnectorId;
+            return CSlotTable::Hash(&Id, sizeof(Id), CSlotTable::Hash(Identity.c_str(), Identity.Length()));
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CConnectorTable::Read(const CConnectorSlot *Slot, CConnectorStatus &Status) {
+            CConnectorSlot Copy;
+
+            if (!CSlotTable::Read(Slot, &Copy, sizeof(CConnectorSlot)))
+                return false;
+
+            Copy.Identity[CONNECTOR_IDENTITY_SIZE - 1] = '\0';
+            Copy.Status[CONNECTOR_STATUS_SIZE - 1] = '\0';
+            Copy.ErrorCode[CONNECTOR_ERROR_SIZE - 1] = '\0';
+            Copy.Info[CONNECTOR_INFO_SIZE - 1] = '\0';
+            Copy.VendorId[CONNECTOR_VENDOR_SIZE - 1] = '\0';
+            Copy.VendorErrorCode[CONNECTOR_VENDOR_SIZE - 1] = '\0';
+            Copy.Timestamp[CONNECTOR_TIMESTAMP_SIZE - 1] = '\0';
+
+            Status.Identity = Copy.Identity;
+            Status.ConnectorId = Copy.ConnectorId;
+            Status.Status = Copy.Status;
+            Status.ErrorCode = Copy.ErrorCode;
+            Status.Info = Copy.Info;
+            Status.VendorId = Copy.VendorId;
+            Status.VendorErrorCode = Copy.VendorErrorCode;
+            Status.Timestamp = Copy.Timestamp;
+            Status.Updated = Copy.Updated;
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CConnectorTable::IsKey(const CString &Identity, int ConnectorId) const {
+            return Active() && !Identity.IsEmpty() && Identity.Length() < CONNECTOR_IDENTITY_SIZE && IsConnectorId(ConnectorId);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CConnectorSlot *CConnectorTable::Lookup(const CString &Identity, int ConnectorId, uint32_t KeyHash) const {
+            CConnectorStatus Status;
+
+            return (CConnectorSlot *) m_Table.Find(KeyHash, CONNECTOR_TABLE_PROBES, [&](const CSharedSlot *Slot) {
+                return Read((const CConnectorSlot *) Slot, Status) && Status.ConnectorId == ConnectorId &&
+                       Identity == Status.Identity;
+            });
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CConnectorTable::Open() {
+            m_Table.Open(CONNECTOR_TABLE_TAG, m_Capacity, sizeof(CConnectorSlot));
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CConnectorTable::Update(const CConnectorStatus &Status) {
+            if (!IsKey(Status.Identity, Status.ConnectorId))
+                return false;
+
+            const auto KeyHash = Hash(Status.Identity, Status.ConnectorId);
+
+            auto Target = Lookup(Status.Identity, Status.ConnectorId, KeyHash);
+
+            if (Target == nullptr) {
+                CConnectorStatus Current;
+                bool Evicted;
+
+                Target = (CConnectorSlot *) m_Table.Vacant(KeyHash, CONNECTOR_TABLE_PROBES,
+                        [&Current](const CSharedSlot *Slot, uint64_t &Order) {
+                    if (!Read((const CConnectorSlot *) Slot, Current))
+                        return false;
+                    Order = Current.Updated;
+                    return true;
+                }, Evicted);
+
+                if (Target == nullptr)
+                    return false;
+
+                if (Evicted)
+                    m_Evicted++;
+            }
+
+            // Two workers may pick the same slot at once, the later write wins: the table is bounded, not exact.
+            if (!CSlotTable::Lock(Target))
+                return false;
+
+            const auto Same = __atomic_load_n(&Target->Hash, __ATOMIC_RELAXED) == KeyHash &&
+                    Target->ConnectorId == Status.ConnectorId && Status.Identity == Target->Identity;
+
+            // A station that reconnected to another worker may race with its old connection.
+            if (!Same || Status.Updated >= Target->Updated) {
+                CSlotTable::BeginWrite(Target);
+                if (!Same) {
+                    __atomic_store_n(&Target->Hash, 0, __ATOMIC_RELAXED);
+                    CopyString(Target->Identity, CONNECTOR_IDENTITY_SIZE, Status.Identity);
+                    Target->ConnectorId = Status.ConnectorId;
+                }
+                CopyString(Target->Status, CONNECTOR_STATUS_SIZE, Status.Status);
+                CopyString(Target->ErrorCode, CONNECTOR_ERROR_SIZE, Status.ErrorCode);
+                CopyString(Target->Info, CONNECTOR_INFO_SIZE, Status.Info);
+                CopyString(Target->VendorId, CONNECTOR_VENDOR_SIZE, Status.VendorId);
+                CopyString(Target->VendorErrorCode, CONNECTOR_VENDOR_SIZE, Status.VendorErrorCode);
+                CopyString(Target->Timestamp, CONNECTOR_TIMESTAMP_SIZE, Status.Timestamp);
+                Target->Updated = Status.Updated;
+                __atomic_store_n(&Target->Hash, KeyHash, __ATOMIC_RELAXED);
+                CSlotTable::EndWrite(Target);
+            }
+
+            CSlotTable::Unlock(Target);
+
+            m_Updated++;
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CConnectorTable::Find(const CString &Identity, int ConnectorId, CConnectorStatus &Status) const {
+            if (!IsKey(Identity, ConnectorId))
+                return false;
+
+            const auto Slot = Lookup(Identity, ConnectorId, Hash(Identity, ConnectorId));
+
+            // The slot may have been given to another connector since the lookup.
+            return Slot != nullptr && Read(Slot, Status) && Status.ConnectorId == ConnectorId && Identity == Status.Identity;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        size_t CConnectorTable::List(const CString &Identity, std::vector<CConnectorStatus> &List) const {
+            const auto Capacity = m_Table.Count();
+
+            CConnectorStatus Status;
+
+            for (size_t i = 0; i < Capacity; ++i) {
+                const auto Slot = (const CConnectorSlot *) m_Table.Slot(i);
+
+                if (__atomic_load_n(&Slot->Hash, __ATOMIC_ACQUIRE) == 0)
+                    continue;
+
+                if (!Read(Slot, Status) || Status.Updated == 0)
+                    continue;
+
+                if (!Identity.IsEmpty() && Identity != Status.Identity)
+                    continue;
+
+                List.push_back(Status);
+            }
+
+            return List.size();
+        }
+
+    }
+}
+}
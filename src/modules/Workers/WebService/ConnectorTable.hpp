@@ -0,0 +1,137 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  ConnectorTable.hpp
+
+Notices:
+
+  Module WebService: Current connector status shared by workers
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_CONNECTORTABLE_HPP
+#define APOSTOL_WEBSERVICE_CONNECTORTABLE_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <cstdint>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define CONNECTOR_TABLE_TAG "connectors"
+
+#define CONNECTOR_IDENTITY_SIZE   64
+#define CONNECTOR_STATUS_SIZE     24
+#define CONNECTOR_ERROR_SIZE      32
+#define CONNECTOR_INFO_SIZE       64
+#define CONNECTOR_VENDOR_SIZE     64
+#define CONNECTOR_TIMESTAMP_SIZE  32
+
+#define CONNECTOR_TABLE_PROBES    16
+#define CONNECTOR_ID_MAX          64
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CConnectorTable -------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct connector_slot_s: public CSharedSlot {
+            int32_t ConnectorId;
+            uint64_t Updated;     // ms
+            char Identity[CONNECTOR_IDENTITY_SIZE];
+            char Status[CONNECTOR_STATUS_SIZE];
+            char ErrorCode[CONNECTOR_ERROR_SIZE];
+            char Info[CONNECTOR_INFO_SIZE];
+            char VendorId[CONNECTOR_VENDOR_SIZE];
+            char VendorErrorCode[CONNECTOR_VENDOR_SIZE];
+            char Timestamp[CONNECTOR_TIMESTAMP_SIZE];
+        } CConnectorSlot;
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct connector_status_s {
+            CString Identity;
+            int ConnectorId;
+            CString Status;
+            CString ErrorCode;
+            CString Info;
+            CString VendorId;
+            CString VendorErrorCode;
+            CString Timestamp;
+            uint64_t Updated;
+        } CConnectorStatus;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Last StatusNotification of every (charge point identity, connectorId) in a CSlotTable, visible to all
+         * workers. A key may only live in the CONNECTOR_TABLE_PROBES slots after its hash: when they are all taken,
+         * the connector updated longest ago (a station that is gone) gives its slot away. db.status_notification
+         * keeps the history, this table only the current state.
+         */
+        class CConnectorTable {
+        private:
+
+            CSlotTable m_Table;
+
+            size_t m_Capacity;
+
+            size_t m_Updated;
+            size_t m_Evicted;
+
+            bool IsKey(const CString &Identity, int ConnectorId) const;
+
+            static uint32_t Hash(const CString &Identity, int ConnectorId);
+
+            static bool Read(const CConnectorSlot *Slot, CConnectorStatus &Status);
+
+            CConnectorSlot *Lookup(const CString &Identity, int ConnectorId, uint32_t KeyHash) const;
+
+        public:
+
+            CConnectorTable(): m_Capacity(32768), m_Updated(0), m_Evicted(0) {
+
+            };
+
+            void Open();
+
+            bool Active() const { return m_Table.Active(); }
+
+            size_t Capacity() const { return m_Capacity; }
+            void Capacity(size_t Value) { m_Capacity = Value; }
+
+            size_t Updated() const { return m_Updated; }
+            size_t Evicted() const { return m_Evicted; }
+
+            static bool IsConnectorId(int ConnectorId) { return ConnectorId >= 0 && ConnectorId <= CONNECTOR_ID_MAX; }
+
+            bool Update(const CConnectorStatus &Status);
+
+            bool Find(const CString &Identity, int ConnectorId, CConnectorStatus &Status) const;
+
+            size_t List(const CString &Identity, std::vector<CConnectorStatus> &List) const;
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_CONNECTORTABLE_HPP
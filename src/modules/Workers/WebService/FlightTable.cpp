@@ -0,0 +1,133 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  FlightTable.cpp
+
+Notices:
+
+  Module WebService: Coalescing of identical API reads
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "FlightTable.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstring>
+#include <openssl/sha.h>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        static const char HexDigits[] = "0123456789abcdef";
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CFlightTable ----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CFlightTable::IsRead(const CString &Route) {
+            if (Route == _T("/whoami") || strncmp(Route.c_str(), "/current/", 9) == 0)
+                return true;
+
+            const auto Slash = strrchr(Route.c_str(), '/');
+            if (Slash == nullptr)
+                return false;
+
+            // The last segment of the typical reads of api.fetch (see api.route).
+            const auto Action = Slash + 1;
+
+            for (const auto Read : {"get", "list", "count", "method", "type"}) {
+                if (strcmp(Action, Read) == 0)
+                    return true;
+            }
+
+            return false;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CString CFlightTable::Key(const CString &Owner, const CString &Route, const CString &Payload) {
+            // The owner may be a password, only its digest is kept in the connection data.
+            CString Data(Owner);
+
+            Data.Append('\n');
+            Data << Route;
+            Data.Append('\n');
+            Data << (Payload.IsEmpty() ? _T("{}") : Payload.c_str());
+
+            unsigned char digest[SHA256_DIGEST_LENGTH];
+            ::SHA256((const unsigned char *) Data.data(), Data.length(), digest);
+
+            CString Result;
+            for (const auto ch : digest) {
+                Result.Append(HexDigits[ch >> 4]);
+                Result.Append(HexDigits[ch & 0x0F]);
+            }
+
+            return Result;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CFlightTable::Join(const CString &Key, CHTTPServerConnection *AConnection) {
+            const auto it = m_Flights.find(std::string(Key.c_str()));
+            if (it == m_Flights.end() || it->second.size() >= m_MaxWaiters)
+                return false;
+
+            it->second.push_back(AConnection);
+            m_Joined++;
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CFlightTable::Start(const CString &Key) {
+            // A request that found the flight full runs its query on its own, the flight keeps the key.
+            if (!m_Flights.emplace(std::string(Key.c_str()), std::vector<CHTTPServerConnection *>()).second)
+                return false;
+
+            m_Started++;
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CFlightTable::Land(const CString &Key, std::vector<CHTTPServerConnection *> &Waiters) {
+            const auto it = m_Flights.find(std::string(Key.c_str()));
+            if (it == m_Flights.end())
+                return;
+
+            Waiters.swap(it->second);
+            m_Flights.erase(it);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CFlightTable::Remove(CHTTPServerConnection *AConnection) {
+            for (auto& Flight : m_Flights) {
+                auto& Waiters = Flight.second;
+                Waiters.erase(std::remove(Waiters.begin(), Waiters.end(), AConnection), Waiters.end());
+            }
+        }
+
+    }
+}
+}
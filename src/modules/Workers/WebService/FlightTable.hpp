@@ -0,0 +1,97 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  FlightTable.hpp
+
+Notices:
+
+  Module WebService: Coalescing of identical API reads
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_FLIGHTTABLE_HPP
+#define APOSTOL_WEBSERVICE_FLIGHTTABLE_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CFlightTable ----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Read queries on their way to the database. The first request with a given key (credential, route, payload)
+         * runs the query, identical requests that come while it runs wait here for its reply instead of taking a
+         * connection of the pool. At most MaxWaiters requests wait for one query, the next ones run their own.
+         */
+        class CFlightTable {
+        private:
+
+            std::unordered_map<std::string, std::vector<CHTTPServerConnection *>> m_Flights;
+
+            bool m_Enabled;
+
+            size_t m_MaxWaiters;
+
+            size_t m_Started;
+            size_t m_Joined;
+
+        public:
+
+            CFlightTable(): m_Enabled(true), m_MaxWaiters(64), m_Started(0), m_Joined(0) {
+
+            };
+
+            size_t Count() const { return m_Flights.size(); }
+
+            size_t Started() const { return m_Started; }
+            size_t Joined() const { return m_Joined; }
+
+            bool Enabled() const { return m_Enabled; }
+            void Enabled(bool Value) { m_Enabled = Value; }
+
+            size_t MaxWaiters() const { return m_MaxWaiters; }
+            void MaxWaiters(size_t Value) { m_MaxWaiters = Value; }
+
+            static bool IsRead(const CString &Route);
+
+            static CString Key(const CString &Owner, const CString &Route, const CString &Payload);
+
+            bool Join(const CString &Key, CHTTPServerConnection *AConnection);
+            bool Start(const CString &Key);
+            void Land(const CString &Key, std::vector<CHTTPServerConnection *> &Waiters);
+
+            // A waiter that went away must not get a reply.
+            void Remove(CHTTPServerConnection *AConnection);
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_FLIGHTTABLE_HPP
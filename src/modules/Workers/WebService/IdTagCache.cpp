@@ -0,0 +1,101 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  IdTagCache.cpp
+
+Notices:
+
+  Module WebService: OCPP idTag authorization cache
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "IdTagCache.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CIdTagCache -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CIdTagCache::IsRequest(const CJSON &Payload) {
+            if (!Payload.IsObject() || Payload.Count() != 1 || !Payload.HasOwnProperty(_T("idTag")))
+                return false;
+
+            const auto& IdTag = Payload[_T("idTag")];
+            if (IdTag.ValueType() != jvtString)
+                return false;
+
+            const auto& Value = IdTag.AsString();
+            return !Value.IsEmpty() && Value.Length() <= 20;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CIdTagCache::Add(const CString &Identity, const CString &IdTag, const CString &Status) {
+            if (Identity.IsEmpty() || Status.IsEmpty() || !Enabled())
+                return;
+
+            if (Status == _T("ConcurrentTx"))
+                return;
+
+            const auto Stations = m_Items.Put(IdTag);
+            if (Stations == nullptr)
+                return;
+
+            auto& Item = (*Stations)[std::string(Identity.c_str())];
+
+            Item.Status = Status;
+            Item.Expires = time(nullptr) + m_Items.TimeToLive();
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CIdTagCache::Find(const CString &Identity, const CString &IdTag, CString &Status) {
+            const auto Stations = m_Items.Find(IdTag);
+            if (Stations == nullptr) {
+                m_Misses++;
+                return false;
+            }
+
+            const auto it = Stations->find(std::string(Identity.c_str()));
+            if (it == Stations->end()) {
+                m_Misses++;
+                return false;
+            }
+
+            if (it->second.Expires <= time(nullptr)) {
+                Stations->erase(it);
+                m_Misses++;
+                return false;
+            }
+
+            m_Hits++;
+
+            Status = it->second.Status;
+
+            return true;
+        }
+
+    }
+}
+}
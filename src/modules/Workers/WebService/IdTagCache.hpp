@@ -0,0 +1,108 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  IdTagCache.hpp
+
+Notices:
+
+  Module WebService: OCPP idTag authorization cache
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_IDTAGCACHE_HPP
+#define APOSTOL_WEBSERVICE_IDTAGCACHE_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <string>
+#include <unordered_map>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CIdTagCache -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * idTag statuses (idTagInfo.status) that ocpp.Authorize has recently returned to a charge point, like its Local
+         * Authorization List. Lets repeated Authorize calls be answered without asking the database. A status is kept
+         * per charge point, since the database may answer differently for another one; an idTag goes at every charge
+         * point on StartTransaction/StopTransaction and on "idtag" notices from the database (card, card state,
+         * client state or transaction changes).
+         */
+        class CIdTagCache {
+        private:
+
+            typedef struct id_tag_status_s {
+                CString Status;
+                time_t Expires;
+            } CIdTagStatus;
+
+            // charge point identity -> status
+            typedef std::unordered_map<std::string, CIdTagStatus> CIdTagStations;
+
+            // idTag -> statuses, an idTag lives while any of its statuses does
+            CTimedCache<CIdTagStations> m_Items;
+
+            bool m_Enabled;
+
+            size_t m_Hits;
+            size_t m_Misses;
+
+        public:
+
+            CIdTagCache(): m_Items(100000, 300), m_Enabled(true), m_Hits(0), m_Misses(0) {
+
+            };
+
+            size_t Count() const { return m_Items.Count(); }
+
+            size_t Hits() const { return m_Hits; }
+            size_t Misses() const { return m_Misses; }
+
+            bool Enabled() const { return m_Enabled && m_Items.Enabled(); }
+            void Enabled(bool Value) { m_Enabled = Value; }
+
+            size_t MaxCount() const { return m_Items.MaxCount(); }
+            void MaxCount(size_t Value) { m_Items.MaxCount(Value); }
+
+            time_t TimeToLive() const { return m_Items.TimeToLive(); }
+            void TimeToLive(time_t Value) { m_Items.TimeToLive(Value); }
+
+            // The Authorize payload may be cached when it holds nothing but an idTag (IdToken, CiString20Type).
+            static bool IsRequest(const CJSON &Payload);
+
+            // ConcurrentTx is about a transaction, not the idTag, and is never kept.
+            void Add(const CString &Identity, const CString &IdTag, const CString &Status);
+            void Delete(const CString &IdTag) { m_Items.Delete(IdTag); }
+
+            bool Find(const CString &Identity, const CString &IdTag, CString &Status);
+
+            void Clear() { m_Items.Clear(); }
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_IDTAGCACHE_HPP
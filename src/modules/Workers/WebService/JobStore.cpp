@@ -0,0 +1,228 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  JobStore.cpp
+
+Notices:
+
+  Module WebService: Results of asynchronous API jobs
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "JobStore.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CJobStore -------------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CJobStore::Read(const CJobSlot *Slot, char *Identity, CString *Content, uint64_t &Expires) const {
+            CJobSlot Copy;
+            std::string Data;
+
+            const auto Done = CSlotTable::Read(Slot, [this, Slot, Content, &Copy, &Data]() {
+                memcpy(&Copy, Slot, sizeof(CJobSlot));
+                if (Content != nullptr && Copy.Length <= MaxLength())
+                    Data.assign((const char *) (Slot + 1), Copy.Length);
+            });
+
+            if (!Done || Copy.Length > MaxLength())
+                return false;
+
+            Copy.Identity[JOB_IDENTITY_SIZE - 1] = '\0';
+            memcpy(Identity, Copy.Identity, JOB_IDENTITY_SIZE);
+
+            Expires = Copy.Expires;
+
+            if (Content != nullptr)
+                *Content = Data.c_str();
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CJobSlot *CJobStore::Lookup(const CString &Identity, uint32_t KeyHash) const {
+            char SlotIdentity[JOB_IDENTITY_SIZE];
+            uint64_t Expires;
+
+            return (CJobSlot *) m_Table.Find(KeyHash, JOB_STORE_PROBES, [&](const CSharedSlot *Slot) {
+                return Read((const CJobSlot *) Slot, SlotIdentity, nullptr, Expires) && Identity == SlotIdentity;
+            });
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CJobStore::Open() {
+            m_Table.Open(JOB_STORE_TAG, m_Capacity, m_RecordSize);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CJobStore::Add(const CString &Identity, const CString &Content, uint64_t Now) {
+            if (!Active() || Identity.IsEmpty() || Identity.Length() >= JOB_IDENTITY_SIZE)
+                return false;
+
+            // A larger reply stays with the worker that ran the job.
+            if (Content.Length() > MaxLength())
+                return false;
+
+            const auto KeyHash = Hash(Identity);
+
+            auto Target = Lookup(Identity, KeyHash);
+
+            if (Target == nullptr) {
+                char SlotIdentity[JOB_IDENTITY_SIZE];
+                bool Evicted;
+
+                // An expired record is free, otherwise the one that expires first is given away.
+                Target = (CJobSlot *) m_Table.Vacant(KeyHash, JOB_STORE_PROBES,
+                        [this, Now, &SlotIdentity](const CSharedSlot *Slot, uint64_t &Order) {
+                    uint64_t Expires;
+                    if (!Read((const CJobSlot *) Slot, SlotIdentity, nullptr, Expires))
+                        return false;
+                    Order = Expires <= Now ? 0 : Expires;
+                    return true;
+                }, Evicted);
+
+                if (Target == nullptr)
+                    return false;
+
+                if (Evicted)
+                    m_Evicted++;
+            }
+
+            // Two workers may pick the same record at once, the later write wins: the store is bounded, not exact.
+            if (!CSlotTable::Lock(Target))
+                return false;
+
+            CSlotTable::BeginWrite(Target);
+            __atomic_store_n(&Target->Hash, 0, __ATOMIC_RELAXED);
+            memset(Target->Identity, 0, JOB_IDENTITY_SIZE);
+            memcpy(Target->Identity, Identity.c_str(), Identity.Length());
+            memcpy((char *) (Target + 1), Content.c_str(), Content.Length());
+            Target->Length = (uint32_t) Content.Length();
+            Target->Expires = Now + (uint64_t) m_TimeToLive * 1000;
+            __atomic_store_n(&Target->Hash, KeyHash, __ATOMIC_RELAXED);
+            CSlotTable::EndWrite(Target);
+
+            CSlotTable::Unlock(Target);
+
+            m_Stored++;
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CJobStore::Find(const CString &Identity, CString &Content, uint64_t Now) const {
+            if (!Active() || Identity.IsEmpty() || Identity.Length() >= JOB_IDENTITY_SIZE)
+                return false;
+
+            const auto Slot = Lookup(Identity, Hash(Identity));
+            if (Slot == nullptr)
+                return false;
+
+            char SlotIdentity[JOB_IDENTITY_SIZE];
+            uint64_t Expires;
+
+            // The record may have been given to another job since the lookup.
+            return Read(Slot, SlotIdentity, &Content, Expires) && Identity == SlotIdentity && Expires > Now;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CJobStore::Delete(const CString &Identity) {
+            if (!Active() || Identity.IsEmpty() || Identity.Length() >= JOB_IDENTITY_SIZE)
+                return;
+
+            const auto Slot = Lookup(Identity, Hash(Identity));
+            if (Slot == nullptr || !CSlotTable::Lock(Slot))
+                return;
+
+            if (Identity == Slot->Identity) {
+                CSlotTable::BeginWrite(Slot);
+                __atomic_store_n(&Slot->Hash, 0, __ATOMIC_RELAXED);
+                Slot->Length = 0;
+                Slot->Expires = 0;
+                CSlotTable::EndWrite(Slot);
+
+                m_Claimed++;
+            }
+
+            CSlotTable::Unlock(Slot);
+        }
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CJobWaiters -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CJobWaiters::Add(const CJobWaiter &Waiter) {
+            if (m_List.size() >= m_MaxCount)
+                return false;
+
+            m_List.push_back(Waiter);
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CJobWaiters::Remove(CHTTPServerConnection *AConnection) {
+            for (auto it = m_List.begin(); it != m_List.end();) {
+                if (it->Connection == AConnection) {
+                    it = m_List.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CJobWaiters::Flush(const CString &Identity,
+                const std::function<bool (const CJobWaiter &Waiter)> &Handler) {
+
+            Flush([&Identity, &Handler](const CJobWaiter &Waiter) {
+                return Waiter.Identity == Identity && Handler(Waiter);
+            });
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CJobWaiters::Flush(const std::function<bool (const CJobWaiter &Waiter)> &Handler) {
+            // A handler sends replies, which may add or remove waiters, so it walks over a list of its own.
+            std::list<CJobWaiter> List;
+            List.swap(m_List);
+
+            for (auto it = List.begin(); it != List.end();) {
+                if (Handler(*it)) {
+                    it = List.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            m_List.splice(m_List.begin(), List);
+        }
+
+    }
+}
+}
@@ -0,0 +1,167 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  JobStore.hpp
+
+Notices:
+
+  Module WebService: Results of asynchronous API jobs
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_JOBSTORE_HPP
+#define APOSTOL_WEBSERVICE_JOBSTORE_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <cstdint>
+#include <functional>
+#include <list>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define JOB_STORE_TAG "jobs"
+
+#define JOB_IDENTITY_SIZE 64
+#define JOB_STORE_PROBES  8
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CJobStore -------------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct job_slot_s: public CSharedSlot {
+            uint32_t Length;      // of the reply that follows the slot header
+            uint64_t Expires;     // ms
+            char Identity[JOB_IDENTITY_SIZE];
+        } CJobSlot;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Replies of finished jobs in a CSlotTable, so that any worker can hand out a job run by another one and a
+         * restarted worker still finds them. Records have a fixed size (Capacity records of RecordSize bytes, the
+         * memory never grows). A job id may only live in the few records after its hash, so a lookup reads at most
+         * JOB_STORE_PROBES records; when they are all taken the one that expires first is given away.
+         */
+        class CJobStore {
+        private:
+
+            CSlotTable m_Table;
+
+            size_t m_Capacity;
+            size_t m_RecordSize;
+
+            time_t m_TimeToLive;
+
+            size_t m_Stored;
+            size_t m_Claimed;
+            size_t m_Evicted;
+
+            static uint32_t Hash(const CString &Identity) { return CSlotTable::Hash(Identity.c_str(), Identity.Length()); }
+
+            bool Read(const CJobSlot *Slot, char *Identity, CString *Content, uint64_t &Expires) const;
+
+            CJobSlot *Lookup(const CString &Identity, uint32_t KeyHash) const;
+
+        public:
+
+            CJobStore(): m_Capacity(256), m_RecordSize(65536), m_TimeToLive(300), m_Stored(0), m_Claimed(0),
+                m_Evicted(0) {
+
+            };
+
+            void Open();
+
+            bool Active() const { return m_Table.Active(); }
+
+            size_t Capacity() const { return m_Capacity; }
+            void Capacity(size_t Value) { m_Capacity = Value == 0 ? 1 : Value; }
+
+            size_t RecordSize() const { return m_RecordSize; }
+            void RecordSize(size_t Value) { m_RecordSize = Value < 1024 ? 1024 : Value; }
+
+            // The largest reply that fits into a record.
+            size_t MaxLength() const { return m_RecordSize - sizeof(CJobSlot); }
+
+            time_t TimeToLive() const { return m_TimeToLive; }
+            void TimeToLive(time_t Value) { m_TimeToLive = Value; }
+
+            size_t Stored() const { return m_Stored; }
+            size_t Claimed() const { return m_Claimed; }
+            size_t Evicted() const { return m_Evicted; }
+
+            bool Add(const CString &Identity, const CString &Content, uint64_t Now);
+            bool Find(const CString &Identity, CString &Content, uint64_t Now) const;
+            void Delete(const CString &Identity);
+
+        };
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CJobWaiters -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct job_waiter_s {
+            CHTTPServerConnection *Connection;
+            CString Identity;
+            CWSMessage Request;   // the call of a WebSocket waiter, empty for HTTP
+            uint64_t Deadline;    // ms
+        } CJobWaiter;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Requests waiting for the reply of a job (long polling over HTTP or a call over WebSocket). A job run by
+         * this worker wakes its waiters at once, the others look into the job store on every heartbeat.
+         */
+        class CJobWaiters {
+        private:
+
+            std::list<CJobWaiter> m_List;
+
+            size_t m_MaxCount;
+
+        public:
+
+            CJobWaiters(): m_MaxCount(1024) {
+
+            };
+
+            size_t Count() const { return m_List.size(); }
+
+            size_t MaxCount() const { return m_MaxCount; }
+            void MaxCount(size_t Value) { m_MaxCount = Value; }
+
+            bool Add(const CJobWaiter &Waiter);
+
+            void Remove(CHTTPServerConnection *AConnection);
+
+            // The handler answers the waiter and returns true, or returns false to keep it waiting.
+            void Flush(const CString &Identity, const std::function<bool (const CJobWaiter &Waiter)> &Handler);
+            void Flush(const std::function<bool (const CJobWaiter &Waiter)> &Handler);
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_JOBSTORE_HPP
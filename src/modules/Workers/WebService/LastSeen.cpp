@@ -0,0 +1,120 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  LastSeen.cpp
+
+Notices:
+
+  Module WebService: Charge point last-seen times
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "LastSeen.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        static void AppendQuoted(CString &Array, const std::string &Value) {
+            Array.Append('"');
+            for (const auto ch : Value) {
+                if (ch == '"' || ch == '\\')
+                    Array.Append('\\');
+                Array.Append(ch);
+            }
+            Array.Append('"');
+        }
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CLastSeen -------------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CLastSeen::Touch(const CString &Identity, const CString &Session) {
+            auto& Item = m_Pending[std::string(Identity.c_str())];
+
+            Item.Time = time(nullptr);
+            Item.Session = Session.c_str();
+
+            m_Answered++;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CLastSeen::Ready(time_t Now) const {
+            return m_Flushing.empty() && !m_Pending.empty() && Now >= m_NextFlush;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CLastSeen::Take(CStringList &Params, time_t Now) {
+            CString Identities;
+            CString Times;
+            CString Sessions;
+
+            m_Flushing.swap(m_Pending);
+            m_NextFlush = Now + m_Period;
+
+            // Array literals: every identity and session is quoted, '"' and '\' are escaped.
+            Identities = _T("{");
+            Times = _T("{");
+            Sessions = _T("{");
+
+            for (auto it = m_Flushing.begin(); it != m_Flushing.end(); ++it) {
+                if (it != m_Flushing.begin()) {
+                    Identities.Append(',');
+                    Times.Append(',');
+                    Sessions.Append(',');
+                }
+
+                AppendQuoted(Identities, it->first);
+                AppendQuoted(Sessions, it->second.Session);
+
+                Times << CString().Format("%ld", (long) it->second.Time);
+            }
+
+            Identities.Append('}');
+            Times.Append('}');
+            Sessions.Append('}');
+
+            Params.Add(Identities);
+            Params.Add(Times);
+            Params.Add(Sessions);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CLastSeen::Done(bool Success) {
+            if (Success) {
+                m_Flushed += m_Flushing.size();
+            } else {
+                // Keep the newer time of the stations that were seen again while the flush was in flight.
+                for (const auto& Item : m_Flushing) {
+                    auto it = m_Pending.find(Item.first);
+                    if (it == m_Pending.end())
+                        m_Pending.insert(Item);
+                }
+            }
+
+            m_Flushing.clear();
+        }
+
+    }
+}
+}
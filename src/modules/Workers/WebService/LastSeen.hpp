@@ -0,0 +1,100 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  LastSeen.hpp
+
+Notices:
+
+  Module WebService: Charge point last-seen times
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_LASTSEEN_HPP
+#define APOSTOL_WEBSERVICE_LASTSEEN_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <string>
+#include <unordered_map>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CLastSeen -------------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct last_seen_s {
+            time_t Time;
+            std::string Session;  // the Heartbeat action runs in it
+        } CLastSeenItem;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Time of the last Heartbeat of each charge point answered by the worker. Written to db.charge_point with
+         * one call of ocpp.SetLastSeen per period, which also runs the Heartbeat action of every station in it, in the
+         * session of the station (once per period, not once per Heartbeat); only one flush is in flight at a time.
+         */
+        class CLastSeen {
+        private:
+
+            std::unordered_map<std::string, CLastSeenItem> m_Pending;
+            std::unordered_map<std::string, CLastSeenItem> m_Flushing;
+
+            bool m_Enabled;
+
+            time_t m_Period;
+            time_t m_NextFlush;
+
+            size_t m_Answered;
+            size_t m_Flushed;
+
+        public:
+
+            CLastSeen(): m_Enabled(true), m_Period(10), m_NextFlush(0), m_Answered(0), m_Flushed(0) {
+
+            };
+
+            size_t Count() const { return m_Pending.size() + m_Flushing.size(); }
+
+            size_t Answered() const { return m_Answered; }
+            size_t Flushed() const { return m_Flushed; }
+
+            bool Enabled() const { return m_Enabled; }
+            void Enabled(bool Value) { m_Enabled = Value; }
+
+            time_t Period() const { return m_Period; }
+            void Period(time_t Value) { m_Period = Value; }
+
+            void Touch(const CString &Identity, const CString &Session);
+
+            bool Ready(time_t Now) const;
+
+            void Take(CStringList &Params, time_t Now);
+            void Done(bool Success);
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_LASTSEEN_HPP
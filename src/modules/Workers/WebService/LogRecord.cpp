@@ -0,0 +1,92 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  LogRecord.cpp
+
+Notices:
+
+  Module WebService: api.log and ocpp.log records
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "LogRecord.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CLogRecord ------------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CLogRecord::AppendString(CString &Json, const CString &Value) {
+            Json.Append('"');
+            for (const auto ch : Value) {
+                if (ch == '"' || ch == '\\') {
+                    Json.Append('\\');
+                    Json.Append(ch);
+                } else if ((unsigned char) ch < 0x20) {
+                    Json << CString().Format("\\u%04x", (int) ch);
+                } else {
+                    Json.Append(ch);
+                }
+            }
+            Json.Append('"');
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CString CLogRecord::Api(uint64_t Time, const CString &Session, const CString &Route, const CString &Payload,
+                uint64_t Runtime) {
+
+            CString Result;
+
+            Result << CString().Format("{\"log\": \"api\", \"datetime\": %.3f, \"session\": ", (double) Time / 1000);
+            AppendString(Result, Session);
+            Result << ", \"route\": ";
+            AppendString(Result, Route.Lower());
+            Result << ", \"json\": " << ((Payload.IsEmpty() || Payload == _T("{}")) ? _T("null") : Payload.c_str());
+            Result << CString().Format(", \"runtime\": %.3f}", (double) Runtime / 1000);
+
+            return Result;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CString CLogRecord::Ocpp(uint64_t Time, const CString &Identity, const CString &Action, const CString &Request,
+                const CString &Response, uint64_t Runtime) {
+
+            CString Result;
+
+            Result << CString().Format("{\"log\": \"ocpp\", \"datetime\": %.3f, \"identity\": ", (double) Time / 1000);
+            AppendString(Result, Identity);
+            Result << ", \"action\": ";
+            AppendString(Result, Action);
+            Result << ", \"request\": " << (Request.IsEmpty() ? _T("null") : Request.c_str());
+            Result << ", \"response\": " << (Response.IsEmpty() ? _T("null") : Response.c_str());
+            Result << CString().Format(", \"runtime\": %.3f}", (double) Runtime / 1000);
+
+            return Result;
+        }
+
+    }
+}
+}
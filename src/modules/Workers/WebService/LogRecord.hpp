@@ -0,0 +1,62 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  LogRecord.hpp
+
+Notices:
+
+  Module WebService: api.log and ocpp.log records
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_LOGRECORD_HPP
+#define APOSTOL_WEBSERVICE_LOGRECORD_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CLogRecord ------------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * JSON records for daemon.WriteLog. Times are in milliseconds since the epoch, Request/Response/Payload are
+         * JSON texts (empty - null).
+         */
+        class CLogRecord {
+        public:
+
+            static void AppendString(CString &Json, const CString &Value);
+
+            static CString Api(uint64_t Time, const CString &Session, const CString &Route, const CString &Payload,
+                uint64_t Runtime);
+
+            static CString Ocpp(uint64_t Time, const CString &Identity, const CString &Action, const CString &Request,
+                const CString &Response, uint64_t Runtime);
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_LOGRECORD_HPP
@@ -0,0 +1,117 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  MeterBuffer.cpp
+
+Notices:
+
+  Module WebService: MeterValues ingestion buffer
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "LogRecord.hpp"
+#include "MeterBuffer.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CMeterBuffer ----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CMeterBuffer::Add(const CString &Identity, const CString &Payload, uint64_t Epoch) {
+            if (m_Size >= m_MaxSize) {
+                m_Rejected++;
+                return false;
+            }
+
+            if (m_Queue.empty())
+                m_NextFlush = Epoch + m_Interval;
+
+            CMeterValue Value;
+
+            Value.Identity = Identity;
+            Value.Payload = Payload;
+            Value.Epoch = Epoch;
+
+            m_Size += SizeOf(Value);
+            m_Queue.push_back(Value);
+
+            m_Accepted++;
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CMeterBuffer::Ready(uint64_t Now) const {
+            if (!m_Flushing.empty() || m_Queue.empty())
+                return false;
+            return m_Queue.size() >= m_BatchCount || Now >= m_NextFlush;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CString CMeterBuffer::Take(uint64_t Now) {
+            CString Result;
+
+            Result = _T("[");
+
+            while (!m_Queue.empty() && m_Flushing.size() < m_BatchCount) {
+                const auto& Value = m_Queue.front();
+
+                if (!m_Flushing.empty())
+                    Result.Append(',');
+
+                Result << "{\"identity\": ";
+                CLogRecord::AppendString(Result, Value.Identity);
+                Result << CString().Format(", \"epoch\": %.3f, \"request\": ", (double) Value.Epoch / 1000);
+                Result << Value.Payload;
+                Result.Append('}');
+
+                m_Flushing.push_back(Value);
+                m_Queue.pop_front();
+            }
+
+            Result.Append(']');
+
+            m_NextFlush = Now + m_Interval;
+
+            return Result;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CMeterBuffer::Done(bool Success) {
+            if (Success) {
+                for (const auto& Value : m_Flushing)
+                    m_Size -= SizeOf(Value);
+                m_Flushed += m_Flushing.size();
+            } else {
+                m_Queue.insert(m_Queue.begin(), m_Flushing.begin(), m_Flushing.end());
+            }
+
+            m_Flushing.clear();
+        }
+
+    }
+}
+}
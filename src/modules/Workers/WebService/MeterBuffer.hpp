@@ -0,0 +1,119 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  MeterBuffer.hpp
+
+Notices:
+
+  Module WebService: MeterValues ingestion buffer
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_METERBUFFER_HPP
+#define APOSTOL_WEBSERVICE_METERBUFFER_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <deque>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CMeterBuffer ----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct meter_value_s {
+            CString Identity;
+            CString Payload;
+            uint64_t Epoch;
+        } CMeterValue;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * MeterValues acknowledged to the stations and not yet written to the database. Flushed in batches of up to
+         * BatchCount values, one batch in flight at a time. A failed batch is put back in front of the queue.
+         * New values are refused while the buffer holds MaxSize bytes or more.
+         */
+        class CMeterBuffer {
+        private:
+
+            std::deque<CMeterValue> m_Queue;
+            std::vector<CMeterValue> m_Flushing;
+
+            bool m_Enabled;
+
+            size_t m_Size;
+            size_t m_MaxSize;
+            size_t m_BatchCount;
+
+            uint64_t m_Interval;
+            uint64_t m_NextFlush;
+
+            size_t m_Accepted;
+            size_t m_Rejected;
+            size_t m_Flushed;
+
+            static size_t SizeOf(const CMeterValue &Value) {
+                return Value.Identity.Length() + Value.Payload.Length() + sizeof(CMeterValue);
+            }
+
+        public:
+
+            CMeterBuffer(): m_Enabled(true), m_Size(0), m_MaxSize(16 * 1024 * 1024), m_BatchCount(500),
+                m_Interval(250), m_NextFlush(0), m_Accepted(0), m_Rejected(0), m_Flushed(0) {
+
+            };
+
+            size_t Count() const { return m_Queue.size() + m_Flushing.size(); }
+            size_t Size() const { return m_Size; }
+
+            size_t Accepted() const { return m_Accepted; }
+            size_t Rejected() const { return m_Rejected; }
+            size_t Flushed() const { return m_Flushed; }
+
+            bool Enabled() const { return m_Enabled; }
+            void Enabled(bool Value) { m_Enabled = Value; }
+
+            size_t MaxSize() const { return m_MaxSize; }
+            void MaxSize(size_t Value) { m_MaxSize = Value; }
+
+            size_t BatchCount() const { return m_BatchCount; }
+            void BatchCount(size_t Value) { m_BatchCount = Value == 0 ? 1 : Value; }
+
+            uint64_t Interval() const { return m_Interval; }
+            void Interval(uint64_t Value) { m_Interval = Value; }
+
+            bool Add(const CString &Identity, const CString &Payload, uint64_t Epoch);
+
+            bool Ready(uint64_t Now) const;
+
+            CString Take(uint64_t Now);
+            void Done(bool Success);
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_METERBUFFER_HPP
@@ -0,0 +1,78 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  NonceStore.cpp
+
+Notices:
+
+  Module WebService: Nonce replay protection
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "NonceStore.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CNonceStore -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        CNonceStore::CNonceStore(): m_Accepted(0), m_Rejected(0) {
+            for (auto& Bucket : m_Buckets)
+                Bucket.Second = 0;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CNonceStore::Add(const CString &Session, const CString &Nonce, double Time) {
+
+            // Time - nonce in microseconds, already checked against the receive window by the caller.
+            const auto second = (time_t) (Time / 1000000);
+            auto& Bucket = m_Buckets[second % NONCE_STORE_BUCKETS];
+
+            if (Bucket.Second != second) {
+                for (const auto& Key : Bucket.Keys)
+                    m_Keys.erase(Key);
+                Bucket.Keys.clear();
+                Bucket.Second = second;
+            }
+
+            std::string Key(Session.c_str());
+            Key.append(1, ':');
+            Key.append(Nonce.c_str());
+
+            if (!m_Keys.insert(Key).second) {
+                m_Rejected++;
+                return false;
+            }
+
+            Bucket.Keys.push_back(std::move(Key));
+            m_Accepted++;
+
+            return true;
+        }
+
+    }
+}
+}
@@ -0,0 +1,86 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  NonceStore.hpp
+
+Notices:
+
+  Module WebService: Nonce replay protection
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_NONCESTORE_HPP
+#define APOSTOL_WEBSERVICE_NONCESTORE_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define NONCE_STORE_BUCKETS 64
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CNonceStore -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct nonce_bucket_s {
+            time_t Second;
+            std::vector<std::string> Keys;
+        } CNonceBucket;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Nonces seen per session. Keys are grouped in one-second buckets by nonce time, a bucket is reused
+         * (and its keys forgotten) once its second falls out of the largest receive window.
+         */
+        class CNonceStore {
+        private:
+
+            std::unordered_set<std::string> m_Keys;
+
+            CNonceBucket m_Buckets[NONCE_STORE_BUCKETS];
+
+            size_t m_Accepted;
+            size_t m_Rejected;
+
+        public:
+
+            CNonceStore();
+
+            size_t Count() const { return m_Keys.size(); }
+
+            size_t Accepted() const { return m_Accepted; }
+            size_t Rejected() const { return m_Rejected; }
+
+            bool Add(const CString &Session, const CString &Nonce, double Time);
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_NONCESTORE_HPP
@@ -0,0 +1,88 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  OcppRouter.cpp
+
+Notices:
+
+  Module WebService: OCPP 1.6-J message router
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "Statement.hpp"
+#include "OcppRouter.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- COcppRouter -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        COcppRouter::COcppRouter(): m_Enabled(true), m_Routed(0), m_Failed(0) {
+            m_Routes["Heartbeat"] = psOcppHeartbeat;
+            m_Routes["Authorize"] = psOcppAuthorize;
+            m_Routes["BootNotification"] = psOcppBootNotification;
+            m_Routes["StatusNotification"] = psOcppStatusNotification;
+            m_Routes["StartTransaction"] = psOcppStartTransaction;
+            m_Routes["StopTransaction"] = psOcppStopTransaction;
+            m_Routes["MeterValues"] = psOcppMeterValues;
+            m_Routes["DataTransfer"] = psOcppDataTransfer;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool COcppRouter::Find(const CString &Action, CPQStatementId &Id) const {
+            if (!m_Enabled)
+                return false;
+
+            const auto it = m_Routes.find(std::string(Action.c_str()));
+            if (it == m_Routes.end())
+                return false;
+
+            Id = it->second;
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CString COcppRouter::Bind(CPQStatementId Id, const CString &Identity, const CString &Payload,
+                const CString &Session, const CString &Agent, const CString &Host, bool WriteLog) {
+
+            CStringList Params;
+
+            Params.Add(Identity);
+            Params.Add(Payload.IsEmpty() ? _T("{}") : Payload.c_str());
+            Params.Add(WriteLog ? _T("true") : _T("false"));
+            Params.Add(Session);
+            Params.Add(Agent);
+            Params.Add(Host);
+
+            m_Routed++;
+
+            return CPQStatement::Get(Id).Bind(Params);
+        }
+
+    }
+}
+}
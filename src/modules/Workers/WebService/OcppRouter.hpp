@@ -0,0 +1,84 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  OcppRouter.hpp
+
+Notices:
+
+  Module WebService: OCPP 1.6-J message router
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_OCPPROUTER_HPP
+#define APOSTOL_WEBSERVICE_OCPPROUTER_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <string>
+#include <unordered_map>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- COcppRouter -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Maps the action of an OCPP CALL received from a charge point to the statement calling its ocpp.* handler.
+         * Actions without a handler go the generic way (daemon.SignFetch).
+         */
+        class COcppRouter {
+        private:
+
+            std::unordered_map<std::string, CPQStatementId> m_Routes;
+
+            bool m_Enabled;
+
+            size_t m_Routed;
+            size_t m_Failed;
+
+        public:
+
+            COcppRouter();
+
+            size_t Count() const { return m_Routes.size(); }
+
+            size_t Routed() const { return m_Routed; }
+            size_t Failed() const { return m_Failed; }
+
+            bool Enabled() const { return m_Enabled; }
+            void Enabled(bool Value) { m_Enabled = Value; }
+
+            bool Find(const CString &Action, CPQStatementId &Id) const;
+
+            CString Bind(CPQStatementId Id, const CString &Identity, const CString &Payload, const CString &Session,
+                const CString &Agent, const CString &Host, bool WriteLog);
+
+            void Fail() { m_Failed++; }
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_OCPPROUTER_HPP
@@ -0,0 +1,249 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  ResponseCache.cpp
+
+Notices:
+
+  Module WebService: API response cache
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "ResponseCache.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <cstring>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define RESPONSE_CACHE_RULES "/whoami=60@session, /current/*=60@session, /method/get=300@workflow, " \
+    "/essence=300@workflow, /class=300@workflow, /action=300@workflow, /state/type=300@workflow, " \
+    "/state=300@workflow, /type=300@workflow, /language=300@workflow"
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        static CString Trimmed(const CString &Value) {
+            const auto Data = Value.c_str();
+
+            size_t Begin = 0;
+            size_t End = Value.Length();
+
+            while (Begin < End && Data[Begin] == ' ')
+                Begin++;
+            while (End > Begin && Data[End - 1] == ' ')
+                End--;
+
+            return Value.SubString(Begin, End - Begin);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        static unsigned ScopeFromString(const CString &Value) {
+            if (Value == _T("object"))
+                return RESPONSE_SCOPE_OBJECT;
+            if (Value == _T("workflow"))
+                return RESPONSE_SCOPE_WORKFLOW;
+            if (Value == _T("registry"))
+                return RESPONSE_SCOPE_REGISTRY;
+            if (Value == _T("session"))
+                return RESPONSE_SCOPE_SESSION;
+            return 0;
+        }
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CResponseCache --------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        CResponseCache::CResponseCache(): m_Enabled(false), m_MaxCount(10000), m_Hits(0), m_Misses(0) {
+            Rules(RESPONSE_CACHE_RULES);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CResponseCache::Purge(time_t Now) {
+            for (auto it = m_Items.begin(); it != m_Items.end();) {
+                if (it->second.Expires <= Now) {
+                    it = m_Items.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CResponseCache::Rules(const CString &Value) {
+            // route=ttl[@scope[|scope]], ...
+            CStringList Items;
+            SplitColumns(Value, Items, ',');
+
+            m_Rules.clear();
+
+            for (int i = 0; i < Items.Count(); ++i) {
+                const auto& Item = Trimmed(Items[i]);
+
+                const auto Equal = Item.Find('=');
+                if (Equal == CString::npos || Equal == 0)
+                    continue;
+
+                CResponseRule Rule;
+
+                Rule.Route = Trimmed(Item.SubString(0, Equal)).Lower();
+
+                const auto& Rest = Item.SubString(Equal + 1, Item.Length() - Equal - 1);
+                const auto At = Rest.Find('@');
+
+                Rule.TimeToLive = StrToIntDef(Trimmed(At == CString::npos ? Rest : Rest.SubString(0, At)).c_str(), 0);
+                Rule.Scopes = 0;
+
+                if (At == CString::npos) {
+                    Rule.Scopes = RESPONSE_SCOPE_ALL;
+                } else {
+                    CStringList Scopes;
+                    SplitColumns(Rest.SubString(At + 1, Rest.Length() - At - 1), Scopes, '|');
+                    for (int j = 0; j < Scopes.Count(); ++j)
+                        Rule.Scopes |= ScopeFromString(Trimmed(Scopes[j]).Lower());
+                }
+
+                if (Rule.TimeToLive > 0 && Rule.Scopes != 0)
+                    m_Rules.push_back(Rule);
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        const CResponseRule *CResponseCache::FindRule(const CString &Route) const {
+            for (const auto &Rule : m_Rules) {
+                if (Rule.Route.back() == '*') {
+                    const auto Prefix = Rule.Route.Length() - 1;
+                    if (Route.Length() > Prefix && strncmp(Route.c_str(), Rule.Route.c_str(), Prefix) == 0)
+                        return &Rule;
+                } else if (Route == Rule.Route) {
+                    return &Rule;
+                }
+            }
+            return nullptr;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CResponseCache::ChangesSession(const CString &Route) {
+            if (Route == _T("/su") || Route == _T("/sign/out"))
+                return true;
+            return Route.Length() > 4 && Route.SubString(Route.Length() - 4, 4) == _T("/set");
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CString CResponseCache::Key(const CString &Owner, const CString &Route, const CString &Payload) {
+            CString Result(Owner);
+
+            Result.Append('\n');
+            Result << Route;
+            Result.Append('\n');
+
+            // The same request written with other spaces is the same request.
+            try {
+                const CJSON Json(Payload.IsEmpty() ? _T("{}") : Payload);
+                Result << Json.ToString();
+            } catch (...) {
+                return CString();
+            }
+
+            return Result;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CResponseCache::Find(const CString &Key, CString &Content) {
+            const auto it = m_Items.find(std::string(Key.c_str()));
+            if (it == m_Items.end()) {
+                m_Misses++;
+                return false;
+            }
+
+            if (it->second.Expires <= time(nullptr)) {
+                m_Items.erase(it);
+                m_Misses++;
+                return false;
+            }
+
+            m_Hits++;
+
+            Content = it->second.Content;
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CResponseCache::Add(const CString &Key, const CString &Owner, const CString &Route,
+                const CString &Content) {
+
+            if (!m_Enabled || Key.IsEmpty())
+                return;
+
+            // Errors come back as rows too, they must not stick.
+            if (Content.IsEmpty() || Content.Find(_T("\"error\"")) != CString::npos)
+                return;
+
+            const auto Rule = FindRule(Route);
+            if (Rule == nullptr)
+                return;
+
+            const auto now = time(nullptr);
+
+            if (m_Items.size() >= m_MaxCount) {
+                Purge(now);
+                if (m_Items.size() >= m_MaxCount)
+                    m_Items.erase(m_Items.begin());
+            }
+
+            auto& Item = m_Items[std::string(Key.c_str())];
+
+            Item.Content = Content;
+            Item.Owner = Owner;
+            Item.Expires = now + Rule->TimeToLive;
+            Item.Scopes = Rule->Scopes;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CResponseCache::Delete(const CString &Owner) {
+            for (auto it = m_Items.begin(); it != m_Items.end();) {
+                if (it->second.Owner == Owner) {
+                    it = m_Items.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CResponseCache::Invalidate(const CString &Scope) {
+            // An unknown scope drops everything rather than serve something stale.
+            const auto Mask = ScopeFromString(Scope);
+
+            for (auto it = m_Items.begin(); it != m_Items.end();) {
+                if (Mask == 0 || (it->second.Scopes & Mask) != 0) {
+                    it = m_Items.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+    }
+}
+}
@@ -0,0 +1,127 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  ResponseCache.hpp
+
+Notices:
+
+  Module WebService: API response cache
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_RESPONSECACHE_HPP
+#define APOSTOL_WEBSERVICE_RESPONSECACHE_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define RESPONSE_SCOPE_OBJECT    0x01
+#define RESPONSE_SCOPE_WORKFLOW  0x02
+#define RESPONSE_SCOPE_REGISTRY  0x04
+#define RESPONSE_SCOPE_SESSION   0x08
+#define RESPONSE_SCOPE_ALL       0x0F
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CResponseCache --------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct response_rule_s {
+            CString Route;       // "/current/*" - any route starting with "/current/"
+            time_t TimeToLive;
+            unsigned Scopes;     // RESPONSE_SCOPE_*: which "cache" notices drop the entries
+        } CResponseRule;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Replies of read-only API routes (whoami, current values, methods, reference lookups) per session. Only
+         * signed requests whose signature is verified in the worker are served from here; bearer tokens are not,
+         * the worker would not learn that a token was revoked. The key is (session, route, payload as parsed and
+         * written back), the session already fixes the user, area, interface and language. Entries go when their time is up, when the
+         * same credential changes its session ("/area/set" and alike, "/su", "/sign/out") and on "cache" notices
+         * from the database, whose payload is the scope that changed: object, workflow, registry or session.
+         */
+        class CResponseCache {
+        private:
+
+            typedef struct response_entry_s {
+                CString Content;
+                CString Owner;
+                time_t Expires;
+                unsigned Scopes;
+            } CResponseEntry;
+
+            std::unordered_map<std::string, CResponseEntry> m_Items;
+
+            std::vector<CResponseRule> m_Rules;
+
+            bool m_Enabled;
+
+            size_t m_MaxCount;
+
+            size_t m_Hits;
+            size_t m_Misses;
+
+            void Purge(time_t Now);
+
+        public:
+
+            CResponseCache();
+
+            size_t Count() const { return m_Items.size(); }
+
+            size_t Hits() const { return m_Hits; }
+            size_t Misses() const { return m_Misses; }
+
+            bool Enabled() const { return m_Enabled; }
+            void Enabled(bool Value) { m_Enabled = Value; }
+
+            size_t MaxCount() const { return m_MaxCount; }
+            void MaxCount(size_t Value) { m_MaxCount = Value; }
+
+            void Rules(const CString &Value);
+
+            const CResponseRule *FindRule(const CString &Route) const;
+
+            static bool ChangesSession(const CString &Route);
+
+            static CString Key(const CString &Owner, const CString &Route, const CString &Payload);
+
+            bool Find(const CString &Key, CString &Content);
+            void Add(const CString &Key, const CString &Owner, const CString &Route, const CString &Content);
+
+            void Delete(const CString &Owner);
+            void Invalidate(const CString &Scope);
+
+            void Clear() { m_Items.clear(); }
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_RESPONSECACHE_HPP
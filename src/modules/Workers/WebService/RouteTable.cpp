@@ -0,0 +1,232 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  RouteTable.cpp
+
+Notices:
+
+  Module WebService: HTTP route table
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "RouteTable.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <cctype>
+#include <strings.h>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        typedef struct route_s {
+            CRouteId Id;
+            unsigned Methods;
+            const char *Segments[ROUTE_MAX_SEGMENTS];
+        } CRoute;
+        //--------------------------------------------------------------------------------------------------------------
+
+        // The first matching row wins.
+        static const CRoute Routes[] = {
+            {rtSession,    rmGet,  {"session", "{}"}},
+            {rtOAuth2,     rmGet,  {"oauth2", "{}"}},
+            {rtOAuth2,     rmGet,  {"oauth2", "{}", "{}"}},
+            {rtPing,       rmGet,  {"api", "{version}", "ping"}},
+            {rtTime,       rmGet,  {"api", "{version}", "time"}},
+            {rtMetrics,    rmGet,  {"api", "{version}", "metrics"}},
+            {rtConnectors, rmGet,  {"api", "{version}", "connectors"}},
+            {rtJob,        rmGet,  {"api", "v2", "{}"}},
+            {rtWhoAmI,     rmGet,  {"api", "{version}", "whoami"}},
+            {rtCurrent,    rmGet,  {"api", "{version}", "current", "{}"}},
+            {rtMethod,     rmGet,  {"api", "{version}", "method"}},
+            {rtMethodGet,  rmGet,  {"api", "{version}", "method", "get"}},
+            {rtObject,     rmGet,  {"api", "{version}", "{client|contract|address}"}},
+            {rtObject,     rmGet,  {"api", "{version}", "{client|contract|address}", "{}"}},
+            {rtStation,    rmPost, {"api", "{version}", "station", "{}"}},
+            {rtSignIn,     rmPost, {"api", "{version}", "sign", "in"}},
+            {rtSignUp,     rmPost, {"api", "{version}", "sign", "up"}},
+            {rtFetch,      rmPost, {"api", "{version}", "**"}}
+        };
+        //--------------------------------------------------------------------------------------------------------------
+
+        static bool SameSegment(const CRouteValue &Segment, const char *Literal, size_t Length) {
+            return Segment.Length == Length && strncasecmp(Segment.Data, Literal, Length) == 0;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        static bool MatchSegment(const CRouteValue &Segment, const char *Pattern, CRouteMatch &Match) {
+            const auto Length = strlen(Pattern);
+
+            if (Length < 2 || Pattern[0] != '{' || Pattern[Length - 1] != '}')
+                return SameSegment(Segment, Pattern, Length);
+
+            if (SameSegment({Pattern, Length}, "{version}", 9)) {
+                if (SameSegment(Segment, "v1", 2)) {
+                    Match.Version = 1;
+                } else if (SameSegment(Segment, "v2", 2)) {
+                    Match.Version = 2;
+                } else {
+                    return false;
+                }
+                return true;
+            }
+
+            // "{}" - any segment, "{a|b|c}" - one of the words.
+            if (Length > 2) {
+                const auto End = Pattern + Length - 1;
+                auto Word = Pattern + 1;
+                auto Found = false;
+
+                while (Word < End && !Found) {
+                    auto Next = Word;
+                    while (Next < End && *Next != '|')
+                        Next++;
+                    Found = SameSegment(Segment, Word, (size_t) (Next - Word));
+                    Word = Next + 1;
+                }
+
+                if (!Found)
+                    return false;
+            }
+
+            if (Match.Count == ROUTE_MAX_VALUES)
+                return false;
+
+            Match.Values[Match.Count++] = Segment;
+
+            return true;
+        }
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CRouteTable -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        CRouteMatch CRouteTable::Match(const CString &Path, CRouteMethod Method) {
+            CRouteMatch Result = {};
+            Result.Status = rsOther;
+
+            CRouteValue Segments[ROUTE_MAX_SEGMENTS];
+            int Count = 0;
+            bool Overflow = false;
+
+            const char *Begin = Path.c_str();
+            const char *End = Begin + Path.Length();
+
+            while (End > Begin && *(End - 1) == '/')
+                End--;
+
+            for (auto Current = Begin; Current < End;) {
+                while (Current < End && *Current == '/')
+                    Current++;
+
+                const auto Start = Current;
+                while (Current < End && *Current != '/')
+                    Current++;
+
+                if (Current == Start)
+                    break;
+
+                if (Count == ROUTE_MAX_SEGMENTS) {
+                    Overflow = true;
+                    break;
+                }
+
+                Segments[Count++] = {Start, (size_t) (Current - Start)};
+            }
+
+            if (Count == 0)
+                return Result;
+
+            for (const auto &Route : Routes) {
+                CRouteMatch Match = {};
+                bool Matched = true;
+                bool Rest = false;
+                int Index = 0;
+
+                for (; Index < ROUTE_MAX_SEGMENTS && Route.Segments[Index] != nullptr; ++Index) {
+                    const auto Pattern = Route.Segments[Index];
+
+                    if (strcmp(Pattern, "**") == 0) {
+                        Matched = Index < Count;
+                        Rest = true;
+                        Index = Count;
+                        break;
+                    }
+
+                    if (Index >= Count || !MatchSegment(Segments[Index], Pattern, Match)) {
+                        Matched = false;
+                        break;
+                    }
+
+                    // The rest of the path after the version is the route of the database.
+                    if (Match.Version != 0 && Match.Tail.Data == nullptr && Index + 1 < Count)
+                        Match.Tail = {Segments[Index + 1].Data, (size_t) (End - Segments[Index + 1].Data)};
+
+                    // A path under a prefix of the table is never a static file.
+                    if (Index == 0)
+                        Result.Status = rsNotFound;
+                }
+
+                if (!Matched || Index != Count || (Overflow && !Rest))
+                    continue;
+
+                Result.Allowed |= Route.Methods;
+
+                if ((Route.Methods & Method) == 0 || Result.Id != rtNone)
+                    continue;
+
+                const auto Allowed = Result.Allowed;
+
+                Result = Match;
+                Result.Id = Route.Id;
+                Result.Allowed = Allowed;
+            }
+
+            if (Result.Id != rtNone) {
+                Result.Status = rsFound;
+            } else if (Result.Allowed != 0) {
+                Result.Status = rsNotAllowed;
+            }
+
+            return Result;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CString CRouteTable::Route(const CRouteValue &Tail) {
+            CString Result(_T("/"));
+
+            for (size_t i = 0; i < Tail.Length; ++i) {
+                const auto ch = Tail.Data[i];
+                if (ch != '/') {
+                    Result.Append((char) tolower(ch));
+                } else if (Result.back() != '/') {
+                    Result.Append('/');
+                }
+            }
+
+            return Result;
+        }
+
+    }
+}
+}
@@ -0,0 +1,130 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  RouteTable.hpp
+
+Notices:
+
+  Module WebService: HTTP route table
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_ROUTETABLE_HPP
+#define APOSTOL_WEBSERVICE_ROUTETABLE_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <cstddef>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define ROUTE_MAX_SEGMENTS 8
+#define ROUTE_MAX_VALUES   4
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CRouteTable -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef enum route_id_e {
+            rtNone = 0,
+            rtSession,
+            rtOAuth2,
+            rtPing,
+            rtTime,
+            rtMetrics,
+            rtConnectors,
+            rtJob,
+            rtWhoAmI,
+            rtCurrent,
+            rtMethod,
+            rtMethodGet,
+            rtObject,
+            rtStation,
+            rtSignIn,
+            rtSignUp,
+            rtFetch
+        } CRouteId;
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef enum route_method_e {
+            rmGet = 1,
+            rmPost = 2
+        } CRouteMethod;
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef enum route_status_e {
+            rsFound = 0,
+            rsNotFound,      // under a prefix of the table, but no route
+            rsNotAllowed,    // the route exists for another method
+            rsOther          // not ours (static files)
+        } CRouteStatus;
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct route_value_s {
+            const char *Data;
+            size_t Length;
+        } CRouteValue;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Result of CRouteTable::Match(). Values point into the request path, so the match must not outlive it.
+         */
+        typedef struct route_match_s {
+            CRouteId Id;
+            CRouteStatus Status;
+            int Version;                          // {version} segment: v1 - 1, v2 - 2
+            CRouteValue Values[ROUTE_MAX_VALUES]; // {} segments in order
+            int Count;
+            CRouteValue Tail;                     // the path after {version}
+            unsigned Allowed;                     // CRouteMethod mask of the routes matching the path
+
+            CString Value(int Index) const {
+                CString Result;
+                if (Index < Count) {
+                    for (size_t i = 0; i < Values[Index].Length; ++i)
+                        Result.Append(Values[Index].Data[i]);
+                }
+                return Result;
+            }
+        } CRouteMatch;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Routes of the web service in one static table. A pattern is a list of path segments: a literal (compared
+         * case-insensitively), "{version}", "{}" for any one segment or "**" for the rest of the path. The path is
+         * cut into segments once, in place, and each row is compared against them, nothing is allocated.
+         */
+        class CRouteTable {
+        public:
+
+            static CRouteMatch Match(const CString &Path, CRouteMethod Method);
+
+            // "/" and the lower-cased tail, as the database knows the route.
+            static CString Route(const CRouteValue &Tail);
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_ROUTETABLE_HPP
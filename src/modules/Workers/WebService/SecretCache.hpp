@@ -0,0 +1,63 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  SecretCache.hpp
+
+Notices:
+
+  Module WebService: Session secret cache
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_SECRETCACHE_HPP
+#define APOSTOL_WEBSERVICE_SECRETCACHE_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CSecretCache ----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Session secrets known to this worker (filled from "/sign/in" replies). A miss only means the signature
+         * is left to the database to check.
+         */
+        class CSecretCache: public CTimedCache<CString> {
+        public:
+
+            CSecretCache(): CTimedCache<CString>(10000, 3600) {
+
+            };
+
+            void Add(const CString &Session, const CString &Secret) {
+                if (!Secret.IsEmpty())
+                    CTimedCache<CString>::Add(Session, Secret);
+            }
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_SECRETCACHE_HPP
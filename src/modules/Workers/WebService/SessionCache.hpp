@@ -0,0 +1,63 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  SessionCache.hpp
+
+Notices:
+
+  Module WebService: Session authorization cache
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_SESSIONCACHE_HPP
+#define APOSTOL_WEBSERVICE_SESSIONCACHE_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CSessionCache ---------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Sessions that daemon.Authorize has recently accepted. Only lets HTML pages be served without asking the
+         * database; API calls still authorize in the database. Entries go on "/sign/out" and on revocation
+         * notices from the database.
+         */
+        class CSessionCache: public CTimedCache<bool> {
+        public:
+
+            CSessionCache(): CTimedCache<bool>(10000, 60) {
+
+            };
+
+            void Add(const CString &Session) { CTimedCache<bool>::Add(Session, true); }
+
+            bool Check(const CString &Session) { return Find(Session) != nullptr; }
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_SESSIONCACHE_HPP
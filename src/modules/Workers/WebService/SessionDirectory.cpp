@@ -0,0 +1,164 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  SessionDirectory.cpp
+
+Notices:
+
+  Module WebService: WebSocket session directory shared by the workers
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "SessionDirectory.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <unistd.h>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CSessionDirectory -----------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CSessionDirectory::Read(const CSessionSlot *Slot, char *Identity, CSessionRecord *Record, time_t *Updated) {
+            CSessionSlot Copy;
+
+            if (!CSlotTable::Read(Slot, &Copy, sizeof(CSessionSlot)))
+                return false;
+
+            if (Identity != nullptr) {
+                memcpy(Identity, Copy.Identity, SESSION_IDENTITY_SIZE);
+                Identity[SESSION_IDENTITY_SIZE - 1] = '\0';
+            }
+
+            if (Record != nullptr) {
+                Record->Worker = Copy.Worker;
+                Record->Connection = Copy.Connection;
+            }
+
+            if (Updated != nullptr)
+                *Updated = Copy.Updated;
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CSessionSlot *CSessionDirectory::Lookup(const CString &Identity, uint32_t KeyHash) const {
+            char Name[SESSION_IDENTITY_SIZE];
+
+            return (CSessionSlot *) m_Table.Find(KeyHash, SESSION_DIRECTORY_PROBES, [&](const CSharedSlot *Slot) {
+                return Read((const CSessionSlot *) Slot, Name, nullptr, nullptr) && Identity == Name;
+            });
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CSessionDirectory::Open() {
+            m_Table.Open(SESSION_DIRECTORY_TAG, m_Capacity, sizeof(CSessionSlot));
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CSessionDirectory::Find(const CString &Identity, CSessionRecord &Record) const {
+            if (!Active() || Identity.IsEmpty() || Identity.Length() >= SESSION_IDENTITY_SIZE)
+                return false;
+
+            const auto Slot = Lookup(Identity, CSlotTable::Hash(Identity.c_str(), Identity.Length()));
+
+            char Name[SESSION_IDENTITY_SIZE];
+
+            // The slot may have been given to another station since the lookup.
+            return Slot != nullptr && Read(Slot, Name, &Record, nullptr) && Identity == Name;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CSessionDirectory::Attach(const CString &Identity, const void *Connection) {
+            if (!Active() || Identity.IsEmpty() || Identity.Length() >= SESSION_IDENTITY_SIZE)
+                return;
+
+            const auto KeyHash = CSlotTable::Hash(Identity.c_str(), Identity.Length());
+
+            auto Target = Lookup(Identity, KeyHash);
+
+            if (Target == nullptr) {
+                bool Evicted;
+
+                Target = (CSessionSlot *) m_Table.Vacant(KeyHash, SESSION_DIRECTORY_PROBES,
+                        [](const CSharedSlot *Slot, uint64_t &Order) {
+                    time_t Updated;
+                    if (!Read((const CSessionSlot *) Slot, nullptr, nullptr, &Updated))
+                        return false;
+                    Order = (uint64_t) Updated;
+                    return true;
+                }, Evicted);
+
+                if (Target == nullptr)
+                    return;
+
+                if (Evicted)
+                    m_Evicted++;
+            }
+
+            // Two workers may pick the same slot at once, the later write wins: the directory is bounded, not exact.
+            if (!CSlotTable::Lock(Target))
+                return;
+
+            CSlotTable::BeginWrite(Target);
+            __atomic_store_n(&Target->Hash, 0, __ATOMIC_RELAXED);
+            memset(Target->Identity, 0, SESSION_IDENTITY_SIZE);
+            memcpy(Target->Identity, Identity.c_str(), Identity.Length());
+            Target->Worker = getpid();
+            Target->Connection = (uint64_t) (uintptr_t) Connection;
+            Target->Updated = time(nullptr);
+            __atomic_store_n(&Target->Hash, KeyHash, __ATOMIC_RELAXED);
+            CSlotTable::EndWrite(Target);
+
+            CSlotTable::Unlock(Target);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CSessionDirectory::Detach(const CString &Identity, const void *Connection) {
+            if (!Active() || Identity.IsEmpty() || Identity.Length() >= SESSION_IDENTITY_SIZE)
+                return;
+
+            const auto Slot = Lookup(Identity, CSlotTable::Hash(Identity.c_str(), Identity.Length()));
+            if (Slot == nullptr || !CSlotTable::Lock(Slot))
+                return;
+
+            // The station may already be attached to another connection or worker.
+            if (Identity == Slot->Identity && Slot->Worker == getpid() &&
+                    Slot->Connection == (uint64_t) (uintptr_t) Connection) {
+                CSlotTable::BeginWrite(Slot);
+                __atomic_store_n(&Slot->Hash, 0, __ATOMIC_RELAXED);
+                Slot->Worker = 0;
+                Slot->Connection = 0;
+                Slot->Updated = 0;
+                CSlotTable::EndWrite(Slot);
+            }
+
+            CSlotTable::Unlock(Slot);
+        }
+
+    }
+}
+}
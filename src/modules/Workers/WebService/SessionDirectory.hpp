@@ -0,0 +1,110 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  SessionDirectory.hpp
+
+Notices:
+
+  Module WebService: WebSocket session directory shared by the workers
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_SESSIONDIRECTORY_HPP
+#define APOSTOL_WEBSERVICE_SESSIONDIRECTORY_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <cstdint>
+#include <sys/types.h>
+//----------------------------------------------------------------------------------------------------------------------
+
+#define SESSION_DIRECTORY_TAG "stations"
+
+#define SESSION_IDENTITY_SIZE    64
+#define SESSION_DIRECTORY_PROBES 16
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CSessionDirectory -----------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct session_slot_s: public CSharedSlot {
+            pid_t Worker;
+            uint64_t Connection;
+            time_t Updated;
+            char Identity[SESSION_IDENTITY_SIZE];
+        } CSessionSlot;
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct session_record_s {
+            pid_t Worker;
+            uint64_t Connection;
+        } CSessionRecord;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Charge point identity -> (worker, connection) in a CSlotTable, visible to all workers. A station is only
+         * attached once the database has confirmed its session, and detached when its connection goes away. No
+         * credentials are kept: a station that reconnects signs in again. A key may only live in the
+         * SESSION_DIRECTORY_PROBES slots after its hash; when they are all taken, the station attached longest ago
+         * gives its slot away.
+         */
+        class CSessionDirectory {
+        private:
+
+            CSlotTable m_Table;
+
+            size_t m_Capacity;
+
+            size_t m_Evicted;
+
+            static bool Read(const CSessionSlot *Slot, char *Identity, CSessionRecord *Record, time_t *Updated);
+
+            CSessionSlot *Lookup(const CString &Identity, uint32_t KeyHash) const;
+
+        public:
+
+            CSessionDirectory(): m_Capacity(16384), m_Evicted(0) {
+
+            };
+
+            void Open();
+
+            bool Active() const { return m_Table.Active(); }
+
+            size_t Capacity() const { return m_Capacity; }
+            void Capacity(size_t Value) { m_Capacity = Value; }
+
+            size_t Evicted() const { return m_Evicted; }
+
+            bool Find(const CString &Identity, CSessionRecord &Record) const;
+
+            void Attach(const CString &Identity, const void *Connection);
+            void Detach(const CString &Identity, const void *Connection);
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_SESSIONDIRECTORY_HPP
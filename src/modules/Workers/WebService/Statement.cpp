@@ -0,0 +1,108 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  Statement.cpp
+
+Notices:
+
+  Module WebService: Named SQL statements
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "Statement.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        // The session of the station ($4, with its agent $5 and host $6) is checked and set in FROM, before the
+        // handler runs; unless $3 is false (the worker writes the log itself), the call is written to ocpp.log in the
+        // same statement.
+#define OCPP_STATEMENT(Action) \
+    _T("WITH r AS (SELECT ocpp." Action "($1, $2::jsonb) AS response FROM daemon.OcppSession($4, $5, $6::inet)) " \
+       "SELECT response, CASE WHEN $3::boolean THEN ocpp.WriteToLog($1, '" Action "', $2::jsonb, response::jsonb, clock_timestamp() - statement_timestamp()) END FROM r;")
+
+        static const CPQStatement Statements[psStatementCount] = {
+            CPQStatement(_T("daemon_authorize")  , _T("SELECT * FROM daemon.Authorize($1);"), 1),
+            CPQStatement(_T("daemon_sign_in")    , _T("SELECT * FROM daemon.SignIn($1::jsonb, $2, $3);"), 3),
+            CPQStatement(_T("daemon_sign_up")    , _T("SELECT * FROM daemon.SignUp('admin', $1, $2::jsonb);"), 2),
+            CPQStatement(_T("daemon_fetch")      , _T("SELECT * FROM daemon.Fetch($1, $2, $3, $4::jsonb, $5, $6);"), 6),
+            CPQStatement(_T("daemon_auth_fetch") , _T("SELECT * FROM daemon.AuthFetch($1, $2, $3, $4::jsonb, $5, $6);"), 6),
+            CPQStatement(_T("daemon_token_fetch"), _T("SELECT * FROM daemon.TokenFetch($1, $2, $3, $4::jsonb, $5, $6);"), 6),
+            CPQStatement(_T("daemon_sign_fetch") , _T("SELECT * FROM daemon.SignFetch($1, $2::json, $3, $4, $5, $6, $7, $8::interval, $9::boolean);"), 9),
+            CPQStatement(_T("ocpp_heartbeat"), OCPP_STATEMENT("Heartbeat"), 6),
+            CPQStatement(_T("ocpp_authorize"), OCPP_STATEMENT("Authorize"), 6),
+            CPQStatement(_T("ocpp_boot_notification"), OCPP_STATEMENT("BootNotification"), 6),
+            CPQStatement(_T("ocpp_status_notification"), OCPP_STATEMENT("StatusNotification"), 6),
+            CPQStatement(_T("ocpp_start_transaction"), OCPP_STATEMENT("StartTransaction"), 6),
+            CPQStatement(_T("ocpp_stop_transaction"), OCPP_STATEMENT("StopTransaction"), 6),
+            CPQStatement(_T("ocpp_meter_values"), OCPP_STATEMENT("MeterValues"), 6),
+            CPQStatement(_T("ocpp_data_transfer"), OCPP_STATEMENT("DataTransfer"), 6),
+            CPQStatement(_T("ocpp_set_last_seen"), _T("SELECT ocpp.SetLastSeen($1::text[], $2::double precision[], $3::text[]);"), 3),
+            CPQStatement(_T("ocpp_add_meter_values"), _T("SELECT ocpp.AddMeterValues($1::jsonb, $2::boolean);"), 2),
+            CPQStatement(_T("daemon_write_log"), _T("SELECT daemon.WriteLog($1::jsonb);"), 1)
+        };
+
+#undef OCPP_STATEMENT
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CPQStatement ----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        const CPQStatement &CPQStatement::Get(CPQStatementId Id) {
+            return Statements[Id];
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CString CPQStatement::Bind(const CStringList &Params) const {
+
+            if (Params.Count() != m_ParamCount)
+                throw ExceptionFrm(_T("Statement \"%s\": expected %d parameters, got %d."), m_Name, m_ParamCount, Params.Count());
+
+            CString Result;
+
+            LPCTSTR P = m_SQL;
+            while (*P) {
+                if (*P == '$' && isdigit(*(P + 1))) {
+                    int Index = 0;
+
+                    P++;
+                    while (isdigit(*P)) {
+                        Index = Index * 10 + (*P - '0');
+                        P++;
+                    }
+
+                    if (Index < 1 || Index > m_ParamCount)
+                        throw ExceptionFrm(_T("Statement \"%s\": invalid parameter index: $%d."), m_Name, Index);
+
+                    Result << PQQuoteLiteral(Params[Index - 1]);
+                } else {
+                    Result.Append(*P++);
+                }
+            }
+
+            return Result;
+        }
+
+    }
+}
+}
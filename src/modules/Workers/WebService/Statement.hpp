@@ -0,0 +1,97 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  Statement.hpp
+
+Notices:
+
+  Module WebService: Named SQL statements
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_STATEMENT_HPP
+#define APOSTOL_WEBSERVICE_STATEMENT_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CPQStatement ----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef enum pq_statement_id_e {
+            psAuthorize = 0,
+            psSignIn,
+            psSignUp,
+            psFetch,
+            psAuthFetch,
+            psTokenFetch,
+            psSignFetch,
+            psOcppHeartbeat,
+            psOcppAuthorize,
+            psOcppBootNotification,
+            psOcppStatusNotification,
+            psOcppStartTransaction,
+            psOcppStopTransaction,
+            psOcppMeterValues,
+            psOcppDataTransfer,
+            psOcppSetLastSeen,
+            psOcppAddMeterValues,
+            psWriteLog,
+            psStatementCount
+        } CPQStatementId;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * SQL text with positional parameters ($1..$N). Parameters are always sent as quoted literals, the
+         * SQL text itself never contains request data.
+         */
+        class CPQStatement {
+        private:
+
+            LPCTSTR m_Name;
+            LPCTSTR m_SQL;
+
+            int m_ParamCount;
+
+        public:
+
+            CPQStatement(LPCTSTR Name, LPCTSTR SQL, int ParamCount): m_Name(Name), m_SQL(SQL), m_ParamCount(ParamCount) {
+
+            };
+
+            LPCTSTR Name() const { return m_Name; }
+            LPCTSTR SQL() const { return m_SQL; }
+
+            int ParamCount() const { return m_ParamCount; }
+
+            CString Bind(const CStringList &Params) const;
+
+            static const CPQStatement &Get(CPQStatementId Id);
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_STATEMENT_HPP
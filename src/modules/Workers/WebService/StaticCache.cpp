@@ -0,0 +1,155 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  StaticCache.cpp
+
+Notices:
+
+  Module WebService: Static file cache
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "StaticCache.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <fcntl.h>
+#include <unistd.h>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CStaticCache ----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CStaticCache::ReadFile(const CString &FileName, size_t MaxSize, CString &Content, struct stat &Stat) {
+            const int fd = open(FileName.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd == -1)
+                return false;
+
+            bool Result = false;
+
+            if (fstat(fd, &Stat) == 0 && S_ISREG(Stat.st_mode) && (size_t) Stat.st_size <= MaxSize) {
+                Content.SetLength(Stat.st_size);
+
+                size_t Done = 0;
+                while (Done < (size_t) Stat.st_size) {
+                    const auto Count = read(fd, (char *) Content.Data() + Done, Stat.st_size - Done);
+                    if (Count <= 0)
+                        break;
+                    Done += Count;
+                }
+
+                Result = Done == (size_t) Stat.st_size;
+            }
+
+            close(fd);
+
+            return Result;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CStaticCache::Load(const CString &FileName, LPCTSTR ContentType, CStaticEntry &Entry) const {
+            struct stat Stat = {};
+
+            if (!ReadFile(FileName, m_MaxFileSize, Entry.Content, Stat))
+                return false;
+
+            Entry.ContentType = ContentType == nullptr ? _T("application/octet-stream") : ContentType;
+            Entry.Modified = Stat.st_mtime;
+            Entry.Size = Stat.st_size;
+            Entry.Checked = time(nullptr);
+
+            TCHAR szBuffer[64] = {0};
+
+            snprintf(szBuffer, sizeof(szBuffer), "\"%lx-%lx\"", (unsigned long) Stat.st_mtime, (unsigned long) Stat.st_size);
+            Entry.ETag = szBuffer;
+
+            struct tm Time = {};
+            gmtime_r(&Stat.st_mtime, &Time);
+            strftime(szBuffer, sizeof(szBuffer), "%a, %d %b %Y %H:%M:%S GMT", &Time);
+            Entry.LastModified = szBuffer;
+
+            // A compressed sibling older than the file itself is stale.
+            struct stat Variant = {};
+
+            if (!ReadFile(FileName + ".gz", m_MaxFileSize, Entry.Gzip, Variant) || Variant.st_mtime < Stat.st_mtime)
+                Entry.Gzip.Clear();
+
+            if (!ReadFile(FileName + ".br", m_MaxFileSize, Entry.Brotli, Variant) || Variant.st_mtime < Stat.st_mtime)
+                Entry.Brotli.Clear();
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        const CStaticEntry *CStaticCache::Find(const CString &Root, const CString &Path, LPCTSTR ContentType) {
+
+            const auto now = time(nullptr);
+            const auto& FileName = Root + Path;
+            const std::string Key(Path.c_str());
+
+            const auto it = m_Entries.find(Key);
+            if (it != m_Entries.end()) {
+                auto& Entry = it->second;
+
+                if (now - Entry.Checked < m_CheckInterval) {
+                    m_Hits++;
+                    return &Entry;
+                }
+
+                struct stat Stat = {};
+                if (stat(FileName.c_str(), &Stat) == 0 && Stat.st_mtime == Entry.Modified && Stat.st_size == Entry.Size) {
+                    Entry.Checked = now;
+                    m_Hits++;
+                    return &Entry;
+                }
+
+                m_Size -= Entry.Weight();
+                m_Entries.erase(it);
+            }
+
+            m_Misses++;
+
+            CStaticEntry Entry;
+            if (!Load(FileName, ContentType, Entry))
+                return nullptr;
+
+            if (m_Size + Entry.Weight() > m_MaxSize)
+                return nullptr;
+
+            m_Size += Entry.Weight();
+
+            return &(m_Entries[Key] = std::move(Entry));
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CStaticCache::Clear() {
+            m_Entries.clear();
+            m_Size = 0;
+        }
+
+    }
+}
+}
@@ -0,0 +1,122 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  StaticCache.hpp
+
+Notices:
+
+  Module WebService: Static file cache
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_STATICCACHE_HPP
+#define APOSTOL_WEBSERVICE_STATICCACHE_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <string>
+#include <unordered_map>
+#include <sys/stat.h>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CStaticCache ----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct static_entry_s {
+            CString ContentType;
+
+            CString Content;
+            CString Gzip;
+            CString Brotli;
+
+            CString ETag;
+            CString LastModified;
+
+            time_t Modified;
+            off_t Size;
+
+            time_t Checked;
+
+            size_t Weight() const { return Content.length() + Gzip.length() + Brotli.length(); }
+        } CStaticEntry;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Files under the document root kept in memory with precomputed validators. Pre-compressed siblings
+         * ("file.gz", "file.br") are picked up as variants. The file is checked with stat() at most once per
+         * CheckInterval seconds; large files are not cached.
+         */
+        class CStaticCache {
+        private:
+
+            std::unordered_map<std::string, CStaticEntry> m_Entries;
+
+            bool m_Enabled;
+
+            size_t m_MaxSize;
+            size_t m_MaxFileSize;
+            size_t m_Size;
+
+            time_t m_CheckInterval;
+
+            size_t m_Hits;
+            size_t m_Misses;
+
+            bool Load(const CString &FileName, LPCTSTR ContentType, CStaticEntry &Entry) const;
+
+            static bool ReadFile(const CString &FileName, size_t MaxSize, CString &Content, struct stat &Stat);
+
+        public:
+
+            CStaticCache(): m_Enabled(true), m_MaxSize(32 * 1024 * 1024), m_MaxFileSize(512 * 1024), m_Size(0),
+                m_CheckInterval(1), m_Hits(0), m_Misses(0) {
+
+            };
+
+            bool Enabled() const { return m_Enabled; }
+            void Enabled(bool Value) { m_Enabled = Value; }
+
+            size_t Count() const { return m_Entries.size(); }
+            size_t Size() const { return m_Size; }
+
+            size_t Hits() const { return m_Hits; }
+            size_t Misses() const { return m_Misses; }
+
+            size_t MaxSize() const { return m_MaxSize; }
+            void MaxSize(size_t Value) { m_MaxSize = Value; }
+
+            size_t MaxFileSize() const { return m_MaxFileSize; }
+            void MaxFileSize(size_t Value) { m_MaxFileSize = Value; }
+
+            const CStaticEntry *Find(const CString &Root, const CString &Path, LPCTSTR ContentType);
+
+            void Clear();
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_STATICCACHE_HPP
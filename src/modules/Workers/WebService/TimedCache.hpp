@@ -0,0 +1,168 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  TimedCache.hpp
+
+Notices:
+
+  Module WebService: Bounded map with a time to live
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_TIMEDCACHE_HPP
+#define APOSTOL_WEBSERVICE_TIMEDCACHE_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <ctime>
+#include <string>
+#include <unordered_map>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CTimedCache -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Values kept for TimeToLive seconds, at most MaxCount of them. A full map first drops the expired values,
+         * then an arbitrary one. An expired value is dropped when it is looked up. The cache is off while MaxCount
+         * or TimeToLive is zero.
+         */
+        template<class TValue>
+        class CTimedCache {
+        private:
+
+            typedef struct timed_item_s {
+                TValue Value;
+                time_t Expires;
+            } CTimedItem;
+
+            std::unordered_map<std::string, CTimedItem> m_Items;
+
+            size_t m_MaxCount;
+            time_t m_TimeToLive;
+
+            size_t m_Hits;
+            size_t m_Misses;
+
+            void Purge(time_t Now) {
+                for (auto it = m_Items.begin(); it != m_Items.end();) {
+                    if (it->second.Expires <= Now) {
+                        it = m_Items.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+
+        public:
+
+            CTimedCache(size_t MaxCount, time_t TimeToLive): m_MaxCount(MaxCount), m_TimeToLive(TimeToLive),
+                m_Hits(0), m_Misses(0) {
+
+            };
+
+            size_t Count() const { return m_Items.size(); }
+
+            size_t Hits() const { return m_Hits; }
+            size_t Misses() const { return m_Misses; }
+
+            bool Enabled() const { return m_TimeToLive > 0 && m_MaxCount > 0; }
+
+            size_t MaxCount() const { return m_MaxCount; }
+            void MaxCount(size_t Value) { m_MaxCount = Value; }
+
+            time_t TimeToLive() const { return m_TimeToLive; }
+            void TimeToLive(time_t Value) { m_TimeToLive = Value; }
+
+            /**
+             * Renews the time to live of the value under Key, a new key gets a default value.
+             * @return The value to fill in, nullptr if the cache is off.
+             */
+            TValue *Put(const CString &Key) {
+                if (Key.IsEmpty() || !Enabled())
+                    return nullptr;
+
+                const auto now = time(nullptr);
+                const std::string Name(Key.c_str());
+
+                if (m_Items.size() >= m_MaxCount && m_Items.find(Name) == m_Items.end()) {
+                    Purge(now);
+                    if (m_Items.size() >= m_MaxCount)
+                        m_Items.erase(m_Items.begin());
+                }
+
+                auto& Item = m_Items[Name];
+                Item.Expires = now + m_TimeToLive;
+
+                return &Item.Value;
+            }
+
+            void Add(const CString &Key, const TValue &Value) {
+                const auto Item = Put(Key);
+                if (Item != nullptr)
+                    *Item = Value;
+            }
+
+            void Delete(const CString &Key) {
+                m_Items.erase(std::string(Key.c_str()));
+            }
+
+            // Returns the value under Key, nullptr if there is none or it has expired.
+            TValue *Find(const CString &Key) {
+                const auto it = m_Items.find(std::string(Key.c_str()));
+                if (it == m_Items.end()) {
+                    m_Misses++;
+                    return nullptr;
+                }
+
+                if (it->second.Expires <= time(nullptr)) {
+                    m_Items.erase(it);
+                    m_Misses++;
+                    return nullptr;
+                }
+
+                m_Hits++;
+
+                return &it->second.Value;
+            }
+
+            bool Find(const CString &Key, TValue &Value) {
+                const auto Item = Find(Key);
+                if (Item == nullptr)
+                    return false;
+
+                Value = *Item;
+
+                return true;
+            }
+
+            void Clear() { m_Items.clear(); }
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_TIMEDCACHE_HPP
@@ -0,0 +1,109 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  TokenCache.cpp
+
+Notices:
+
+  Module WebService: Verified token cache
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Core.hpp"
+#include "TokenCache.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <openssl/sha.h>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CTokenCache -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        std::string CTokenCache::Digest(const CString &Token) {
+            unsigned char digest[SHA256_DIGEST_LENGTH];
+            ::SHA256((const unsigned char *) Token.data(), Token.length(), digest);
+            return std::string((const char *) digest, SHA256_DIGEST_LENGTH);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        const CString &CTokenCache::Add(const CString &Token, const CString &Verified, time_t Expires) {
+
+            const auto now = time(nullptr);
+            if (Expires > now + m_TimeToLive)
+                Expires = now + m_TimeToLive;
+
+            const auto& Key = Digest(Token);
+
+            const auto it = m_Index.find(Key);
+            if (it != m_Index.end()) {
+                m_List.erase(it->second);
+                m_Index.erase(it);
+            }
+
+            while (!m_List.empty() && m_List.size() >= m_MaxCount) {
+                m_Index.erase(m_List.back().Digest);
+                m_List.pop_back();
+            }
+
+            m_List.push_front({Key, Verified, Expires});
+            m_Index[Key] = m_List.begin();
+
+            return m_List.front().Token;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CTokenCache::Find(const CString &Token, CString &Verified) {
+
+            const auto it = m_Index.find(Digest(Token));
+
+            if (it == m_Index.end()) {
+                m_Misses++;
+                return false;
+            }
+
+            if (it->second->Expires <= time(nullptr)) {
+                m_List.erase(it->second);
+                m_Index.erase(it);
+                m_Misses++;
+                return false;
+            }
+
+            m_List.splice(m_List.begin(), m_List, it->second);
+            Verified = it->second->Token;
+            m_Hits++;
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CTokenCache::Clear() {
+            m_Index.clear();
+            m_List.clear();
+        }
+
+    }
+}
+}
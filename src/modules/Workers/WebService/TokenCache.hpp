@@ -0,0 +1,102 @@
+/*++
+
+Program name:
+
+  Apostol Web Service
+
+Module Name:
+
+  TokenCache.hpp
+
+Notices:
+
+  Module WebService: Verified token cache
+
+Author:
+
+  Copyright (c) Prepodobny Alen
+
+  mailto: alienufo@inbox.ru
+  mailto: ufocomp@gmail.com
+
+--*/
+
+#ifndef APOSTOL_WEBSERVICE_TOKENCACHE_HPP
+#define APOSTOL_WEBSERVICE_TOKENCACHE_HPP
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <list>
+#include <string>
+#include <unordered_map>
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C++" {
+
+namespace Apostol {
+
+    namespace Workers {
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        //-- CTokenCache -----------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct token_item_s {
+            std::string Digest;
+            CString Token;
+            time_t Expires;
+        } CTokenItem;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * LRU cache: SHA-256 of a verified access token -> token to pass to the database (the same token for HS256,
+         * the token re-signed with the default secret otherwise). An entry never outlives the "exp" claim.
+         */
+        class CTokenCache {
+        private:
+
+            typedef std::list<CTokenItem> CTokenList;
+
+            CTokenList m_List;
+            std::unordered_map<std::string, CTokenList::iterator> m_Index;
+
+            size_t m_MaxCount;
+            time_t m_TimeToLive;
+
+            size_t m_Hits;
+            size_t m_Misses;
+
+            static std::string Digest(const CString &Token);
+
+        public:
+
+            CTokenCache(): m_MaxCount(1000), m_TimeToLive(300), m_Hits(0), m_Misses(0) {
+
+            };
+
+            size_t Count() const { return m_List.size(); }
+
+            size_t Hits() const { return m_Hits; }
+            size_t Misses() const { return m_Misses; }
+
+            size_t MaxCount() const { return m_MaxCount; }
+            void MaxCount(size_t Value) { m_MaxCount = Value; }
+
+            time_t TimeToLive() const { return m_TimeToLive; }
+            void TimeToLive(time_t Value) { m_TimeToLive = Value; }
+
+            const CString &Add(const CString &Token, const CString &Verified, time_t Expires);
+
+            bool Find(const CString &Token, CString &Verified);
+
+            void Clear();
+
+        };
+
+    }
+}
+
+using namespace Apostol::Workers;
+}
+#endif //APOSTOL_WEBSERVICE_TOKENCACHE_HPP
@@ -37,6 +37,8 @@ Author:
 
 #define SHA256_DIGEST_LENGTH   32
 
+#define VERIFIER_MAX_COUNT     256
+
 extern "C++" {
 
 namespace Apostol {
@@ -89,6 +91,38 @@ namespace Apostol {
         }
         //--------------------------------------------------------------------------------------------------------------
 
+        CString MsToISOTime(unsigned long Ms) {
+            const auto Seconds = (time_t) (Ms / 1000);
+
+            struct tm Time = {0};
+            gmtime_r(&Seconds, &Time);
+
+            TCHAR szTime[32] = {0};
+            const auto Length = strftime(szTime, sizeof(szTime), "%Y-%m-%dT%H:%M:%S", &Time);
+            snprintf(szTime + Length, sizeof(szTime) - Length, ".%03dZ", (int) (Ms % 1000));
+
+            return szTime;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void RowsToJson(CPQResult *AResult, int From, CString &Json, bool IsArray) {
+            const auto Count = AResult->nTuples() - From;
+
+            if (Count == 1 && !IsArray) {
+                Json = AResult->GetIsNull(From, 0) ? _T("null") : AResult->GetValue(From, 0);
+                return;
+            }
+
+            Json = _T("[");
+            for (int Row = From; Row < AResult->nTuples(); ++Row) {
+                if (Row > From)
+                    Json.Append(',');
+                Json << (AResult->GetIsNull(Row, 0) ? _T("null") : AResult->GetValue(Row, 0));
+            }
+            Json.Append(']');
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
         CDateTime GetRandomDate(int a, int b, CDateTime Date) {
             std::random_device rd;
             std::mt19937 gen(rd());
@@ -99,6 +133,78 @@ namespace Apostol {
 
         //--------------------------------------------------------------------------------------------------------------
 
+        //-- CVerifierTable --------------------------------------------------------------------------------------------
+
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef jwt::verifier<jwt::default_clock> CVerifier;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Ready verifiers keyed by "provider/kid/alg" ("provider//alg" for HMAC). A verifier holds the parsed key
+         * (EVP_PKEY or HMAC secret), so PEM is parsed once per key and not once per request. Only verifiers that
+         * passed a token are kept, at most VERIFIER_MAX_COUNT of them. The whole table is replaced on key reload.
+         */
+        class CVerifierTable {
+        private:
+
+            std::unordered_map<std::string, std::shared_ptr<CVerifier>> m_Items;
+
+        public:
+
+            std::shared_ptr<CVerifier> Find(const std::string &Key) const {
+                const auto it = m_Items.find(Key);
+                return it == m_Items.end() ? nullptr : it->second;
+            }
+
+            void Add(const std::string &Key, const std::shared_ptr<CVerifier> &Verifier) {
+                // A full table still verifies, it just parses the key again next time.
+                if (m_Items.size() >= VERIFIER_MAX_COUNT && m_Items.find(Key) == m_Items.end())
+                    return;
+                m_Items[Key] = Verifier;
+            }
+
+            size_t Count() const { return m_Items.size(); }
+
+        };
+        //--------------------------------------------------------------------------------------------------------------
+
+        std::shared_ptr<CVerifier> CreateVerifier(const std::string &alg, const std::string &key) {
+            auto verifier = std::make_shared<CVerifier>(jwt::verify());
+
+            if (alg == "HS256") {
+                verifier->allow_algorithm(jwt::algorithm::hs256{key});
+            } else if (alg == "HS384") {
+                verifier->allow_algorithm(jwt::algorithm::hs384{key});
+            } else if (alg == "HS512") {
+                verifier->allow_algorithm(jwt::algorithm::hs512{key});
+            } else if (alg == "RS256") {
+                verifier->allow_algorithm(jwt::algorithm::rs256{key});
+            } else if (alg == "RS384") {
+                verifier->allow_algorithm(jwt::algorithm::rs384{key});
+            } else if (alg == "RS512") {
+                verifier->allow_algorithm(jwt::algorithm::rs512{key});
+            } else if (alg == "ES256") {
+                verifier->allow_algorithm(jwt::algorithm::es256{key});
+            } else if (alg == "ES384") {
+                verifier->allow_algorithm(jwt::algorithm::es384{key});
+            } else if (alg == "ES512") {
+                verifier->allow_algorithm(jwt::algorithm::es512{key});
+            } else if (alg == "PS256") {
+                verifier->allow_algorithm(jwt::algorithm::ps256{key});
+            } else if (alg == "PS384") {
+                verifier->allow_algorithm(jwt::algorithm::ps384{key});
+            } else if (alg == "PS512") {
+                verifier->allow_algorithm(jwt::algorithm::ps512{key});
+            } else {
+                throw jwt::token_verification_exception("Token signed with unsupported algorithm: " + alg);
+            }
+
+            return verifier;
+        }
+
+        //--------------------------------------------------------------------------------------------------------------
+
         //-- CWebService -----------------------------------------------------------------------------------------------
 
         //--------------------------------------------------------------------------------------------------------------
@@ -111,6 +217,20 @@ namespace Apostol {
             m_Headers.Add("Key");
 
             m_FixedDate = Now();
+            m_KeySequence = 0;
+
+            m_Metrics = false;
+
+            m_Pipeline = false;
+            m_PipelineDepth = 2;
+            m_PipelineBatch = 16;
+            m_PipelineInFlight = 0;
+
+            m_Verifiers = std::make_shared<CVerifierTable>();
+
+            m_LogFallback = 0;
+
+            m_JobWait = 30000;
 
             CWebService::InitMethods();
         }
@@ -144,8 +264,10 @@ namespace Apostol {
         void CWebService::AfterQueryWS(CHTTPServerConnection *AConnection, const CString &Path, const CJSON &Payload) {
 
             auto lpSession = CSession::FindOfConnection(AConnection);
+            if (lpSession == nullptr)
+                return;
 
-            auto SignIn = [lpSession](const CJSON &Payload) {
+            auto SignIn = [AConnection, lpSession](const CJSON &Payload) {
                 if (Payload.HasOwnProperty(_T("error")))
                     return;
 
@@ -160,9 +282,12 @@ namespace Apostol {
 
                 lpSession->Session() = Session;
                 lpSession->Secret() = Secret;
+
+                // The session was created by the database: OCPP calls may be routed in the worker.
+                AConnection->Data().Values("authorized", Session);
             };
 
-            auto SignOut = [lpSession](const CJSON &Payload) {
+            auto SignOut = [AConnection, lpSession](const CJSON &Payload) {
                 if (Payload.HasOwnProperty(_T("error")))
                     return;
 
@@ -174,6 +299,12 @@ namespace Apostol {
 
                 lpSession->Session().Clear();
                 lpSession->Secret().Clear();
+
+                AConnection->Data().Values("authorized", CString());
+            };
+
+            auto IsValid = [](const CJSON &Payload) {
+                return !Payload.HasOwnProperty(_T("error")) && Payload[_T("valid")].AsBoolean();
             };
 
             if (Path == _T("/sign/in")) {
@@ -201,13 +332,56 @@ namespace Apostol {
                         }
                     }
                 }
+
+            } else if (Path == _T("/authorize")) {
+
+                // The session of mtOpen comes from the station itself, it is trusted once the database has confirmed it
+                // (daemon.SignFetch checks the signature made with its secret, api.authorize checks the session).
+                bool Valid = false;
+
+                if (Payload.IsObject()) {
+                    Valid = IsValid(Payload);
+                } else if (Payload.IsArray()) {
+                    for (int i = 0; i < Payload.Count(); i++) {
+                        const auto& Value = Payload.Array()[i];
+                        if (Value.IsObject()) {
+                            Valid = IsValid(Value);
+                        }
+                    }
+                }
+
+                if (Valid) {
+                    AConnection->Data().Values("authorized", lpSession->Session());
+                } else {
+                    ResetSession(AConnection);
+                }
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::ResetSession(CHTTPServerConnection *AConnection) {
+            auto lpSession = CSession::FindOfConnection(AConnection);
+            if (lpSession != nullptr) {
+                lpSession->Session().Clear();
+                lpSession->Secret().Clear();
             }
+
+            AConnection->Data().Values("authorized", CString());
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CWebService::IsAuthorized(CHTTPServerConnection *AConnection) {
+            auto lpSession = CSession::FindOfConnection(AConnection);
+            if (lpSession == nullptr || lpSession->Session().IsEmpty())
+                return false;
+
+            return AConnection->Data()["authorized"] == lpSession->Session();
         }
         //--------------------------------------------------------------------------------------------------------------
 
-        void CWebService::AfterQuery(CReply *AReply, const CString &Path, const CString &Content) {
+        void CWebService::AfterQuery(CReply *AReply, const CString &Path, CPQResult *AResult, int From, int Count) {
 
-            auto SignIn = [AReply](const CJSON &Payload) {
+            auto SignIn = [this, AReply](const CJSON &Payload) {
                 if (Payload.HasOwnProperty(_T("error")))
                     return;
 
@@ -216,8 +390,10 @@ namespace Apostol {
 
                 if (Result) {
                     const auto &Session = Payload[_T("session")].AsString();
-                    if (!Session.IsEmpty())
+                    if (!Session.IsEmpty()) {
                         AReply->SetCookie(_T("AWS-Session"), Session.c_str(), _T("/"), 60 * 86400);
+                        m_SecretCache.Add(Session, Payload[_T("secret")].AsString());
+                    }
 
                     const auto &Key = Payload[_T("key")].AsString();
                     if (!Key.IsEmpty())
@@ -252,47 +428,32 @@ namespace Apostol {
                 }
             };
 
-            if (Path == _T("/sign/in")) {
-
-                const CJSON Payload(Content);
-
-                if (Payload.IsObject()) {
-                    SignIn(Payload);
-                } else if (Payload.IsArray()) {
-                    for (int i = 0; i < Payload.Count(); i++) {
-                        const auto& Value = Payload.Array()[i];
-                        if (Value.IsObject()) {
-                            SignIn(Value);
-                        }
-                    }
-                }
+            std::function<void (const CJSON &)> Handler;
 
+            if (Path == _T("/sign/in")) {
+                Handler = SignIn;
             } else if (Path == _T("/sign/out")) {
-
-                const CJSON Payload(Content);
-
-                if (Payload.IsObject()) {
-                    SignOut(Payload);
-                } else if (Payload.IsArray()) {
-                    for (int i = 0; i < Payload.Count(); i++) {
-                        const auto& Value = Payload.Array()[i];
-                        if (Value.IsObject()) {
-                            SignOut(Value);
-                        }
-                    }
-                }
-
+                Handler = SignOut;
             } else if (Path == _T("/authenticate")) {
+                Handler = Authenticate;
+            } else {
+                return;
+            }
 
-                const CJSON Payload(Content);
+            // Only the rows of the sign/authenticate replies are parsed, never the whole reply content.
+            for (int Row = From; Row < From + Count; ++Row) {
+                if (AResult->GetIsNull(Row, 0))
+                    continue;
+
+                const CJSON Payload(CString(AResult->GetValue(Row, 0)));
 
                 if (Payload.IsObject()) {
-                    Authenticate(Payload);
+                    Handler(Payload);
                 } else if (Payload.IsArray()) {
                     for (int i = 0; i < Payload.Count(); i++) {
                         const auto& Value = Payload.Array()[i];
                         if (Value.IsObject()) {
-                            Authenticate(Value);
+                            Handler(Value);
                         }
                     }
                 }
@@ -300,100 +461,134 @@ namespace Apostol {
         }
         //--------------------------------------------------------------------------------------------------------------
 
-        void CWebService::DoPostgresQueryExecuted(CPQPollQuery *APollQuery) {
-            clock_t start = clock();
+        CReply::CStatusType CWebService::ResultToReply(CReply *AReply, CPQResult *AResult, const CString &Path,
+                const CString &GrantType) {
 
-            auto LResult = APollQuery->Results(0);
+            const auto IsArray = Path.Find(_T("/list")) != CString::npos;
+            const auto Count = AResult->nTuples();
 
-            if (LResult->ExecStatus() != PGRES_TUPLES_OK) {
-                QueryException(APollQuery, Delphi::Exception::EDBError(LResult->GetErrorMessage()));
-                return;
-            }
+            if (GrantType == "client") {
+                // The first row is the reply of api.authenticate, the rest is the reply of api.fetch.
+                if (Count == 0)
+                    return CReply::no_content;
 
-            auto LConnection = dynamic_cast<CHTTPServerConnection *> (APollQuery->PollConnection());
+                AfterQuery(AReply, _T("/authenticate"), AResult, 0, 1);
 
-            if (LConnection != nullptr) {
+                if (Count == 1) {
+                    AReply->Content = _T("{}");
+                } else {
+                    RowsToJson(AResult, 1, AReply->Content, IsArray);
+                    AfterQuery(AReply, Path, AResult, 1, Count - 1);
+                }
+            } else {
+                PQResultToJson(AResult, AReply->Content, IsArray);
+                AfterQuery(AReply, Path, AResult, 0, Count);
+            }
 
-                const auto& Path = LConnection->Data()["path"].Lower();
-                const auto IsArray = Path.Find(_T("/list")) != CString::npos;
+            return CReply::ok;
+        }
+        //--------------------------------------------------------------------------------------------------------------
 
-                if (LConnection->Protocol() == pWebSocket ) {
+        void CWebService::QueryResult(CHTTPServerConnection *AConnection, CPQResult *AResult) {
 
-                    auto LWSRequest = LConnection->WSRequest();
-                    auto LWSReply = LConnection->WSReply();
+            WriteFetchLog(AConnection);
 
-                    const CString LRequest(LWSRequest->Payload());
+            const auto& Path = AConnection->Data()["path"].Lower();
+            const auto IsArray = Path.Find(_T("/list")) != CString::npos;
 
-                    CWSMessage wsmRequest;
-                    CWSProtocol::Request(LRequest, wsmRequest);
+            if (AConnection->Protocol() == pWebSocket ) {
 
-                    CWSMessage wsmResponse;
-                    CWSProtocol::PrepareResponse(wsmRequest, wsmResponse);
+                auto LWSRequest = AConnection->WSRequest();
+                auto LWSReply = AConnection->WSReply();
 
-                    try {
-                        CString jsonString;
-                        PQResultToJson(LResult, jsonString, IsArray);
+                const CString LRequest(LWSRequest->Payload());
+
+                CWSMessage wsmRequest;
+                CWSProtocol::Request(LRequest, wsmRequest);
 
-                        wsmResponse.Payload << jsonString;
-                        AfterQueryWS(LConnection, wsmRequest.Action, wsmResponse.Payload);
-                    } catch (Delphi::Exception::Exception &E) {
-                        wsmResponse.MessageTypeId = mtCallError;
-                        wsmResponse.ErrorCode = CReply::internal_server_error;
-                        wsmResponse.ErrorMessage = E.what();
+                CWSMessage wsmResponse;
+                CWSProtocol::PrepareResponse(wsmRequest, wsmResponse);
 
-                        Log()->Error(APP_LOG_EMERG, 0, E.what());
+                try {
+                    CString jsonString;
+                    PQResultToJson(AResult, jsonString, IsArray);
+
+                    wsmResponse.Payload << jsonString;
+
+                    // The request may have been an mtOpen, the path is the call it was turned into.
+                    AfterQueryWS(AConnection, Path, wsmResponse.Payload);
+
+                    if (Path == _T("/sign/in") || Path == _T("/sign/out") || Path == _T("/authorize")) {
+                        auto lpSession = CSession::FindOfConnection(AConnection);
+                        // Other workers only learn a station the database has confirmed.
+                        if (lpSession != nullptr) {
+                            if (Path == _T("/sign/out")) {
+                                m_SessionDirectory.Detach(lpSession->Identity(), AConnection);
+                            } else if (IsAuthorized(AConnection)) {
+                                m_SessionDirectory.Attach(lpSession->Identity(), AConnection);
+                            }
+                        }
                     }
+                } catch (Delphi::Exception::Exception &E) {
+                    wsmResponse.MessageTypeId = mtCallError;
+                    wsmResponse.ErrorCode = CReply::internal_server_error;
+                    wsmResponse.ErrorMessage = E.what();
 
-                    CString LResponse;
-                    CWSProtocol::Response(wsmResponse, LResponse);
+                    Log()->Error(APP_LOG_EMERG, 0, E.what());
+                }
+
+                CString LResponse;
+                CWSProtocol::Response(wsmResponse, LResponse);
 #ifdef _DEBUG
-                    DebugMessage("\n[%p] [%s:%d] [%d] [WebSocket] Response:\n%s\n", LConnection, LConnection->Socket()->Binding()->PeerIP(),
-                                 LConnection->Socket()->Binding()->PeerPort(), LConnection->Socket()->Binding()->Handle(), LResponse.c_str());
+                DebugMessage("\n[%p] [%s:%d] [%d] [WebSocket] Response:\n%s\n", AConnection, AConnection->Socket()->Binding()->PeerIP(),
+                             AConnection->Socket()->Binding()->PeerPort(), AConnection->Socket()->Binding()->Handle(), LResponse.c_str());
 #endif
-                    LWSReply->SetPayload(LResponse);
-                    LConnection->SendWebSocket(true);
+                LWSReply->SetPayload(LResponse);
+                AConnection->SendWebSocket(true);
 
-                } else {
+            } else {
 
-                    auto LReply = LConnection->Reply();
+                auto LReply = AConnection->Reply();
 
-                    const auto& LGrandType = LConnection->Data()["grant_type"];
+                const auto& LGrandType = AConnection->Data()["grant_type"];
 
-                    CReply::CStatusType LStatus = CReply::internal_server_error;
+                CReply::CStatusType LStatus = CReply::internal_server_error;
 
-                    try {
-                        if (LGrandType == "client") {
-                            CStringList List;
-                            PQResultToList(LResult, List);
-
-                            LStatus = CReply::no_content;
-                            if (List.Count() != 0) {
-                                LStatus = CReply::ok;
-
-                                AfterQuery(LReply, _T("/authenticate"), List[0]);
-
-                                List.Delete(0);
-                                if (List.Count() == 0) {
-                                    LReply->Content =_T("{}");
-                                } else {
-                                    ListToJson(List, LReply->Content, IsArray);
-                                    AfterQuery(LReply, Path, LReply->Content);
-                                }
-                            }
-                        } else {
-                            PQResultToJson(LResult, LReply->Content, IsArray);
-                            AfterQuery(LReply, Path, LReply->Content);
-                            LStatus = CReply::ok;
-                        }
-                    } catch (Delphi::Exception::Exception &E) {
-                        LReply->Content.Clear();
-                        ExceptionToJson(0, E, LReply->Content);
-                        Log()->Error(APP_LOG_EMERG, 0, E.what());
-                    }
+                try {
+                    LStatus = ResultToReply(LReply, AResult, Path, LGrandType);
 
-                    LConnection->SendReply(LStatus, nullptr, true);
+                    const auto& LCacheKey = AConnection->Data()["cache_key"];
+                    if (LStatus == CReply::ok && !LCacheKey.IsEmpty())
+                        m_ResponseCache.Add(LCacheKey, AConnection->Data()["cache_owner"], Path, LReply->Content);
+                } catch (Delphi::Exception::Exception &E) {
+                    LReply->Content.Clear();
+                    ExceptionToJson(0, E, LReply->Content);
+                    Log()->Error(APP_LOG_EMERG, 0, E.what());
                 }
 
+                ReplyFlight(AConnection, LStatus);
+
+                AConnection->SendReply(LStatus, nullptr, true);
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::DoPostgresQueryExecuted(CPQPollQuery *APollQuery) {
+            clock_t start = clock();
+
+            auto LResult = APollQuery->Results(0);
+
+            if (LResult->ExecStatus() != PGRES_TUPLES_OK) {
+                QueryException(APollQuery, Delphi::Exception::EDBError(LResult->GetErrorMessage()));
+                return;
+            }
+
+            auto LConnection = dynamic_cast<CHTTPServerConnection *> (APollQuery->PollConnection());
+
+            if (LConnection != nullptr) {
+
+                QueryResult(LConnection, LResult);
+
             } else {
 
                 auto LJob = m_pJobs->FindJobByQuery(APollQuery);
@@ -403,37 +598,19 @@ namespace Apostol {
                 }
 
                 const auto& LGrandType = LJob->Data()["grant_type"];
-
-                const auto& Path = LConnection->Data()["path"].Lower();
-                const auto IsArray = Path.Find(_T("/list")) != CString::npos;
+                const auto& Path = LJob->Data()["path"].Lower();
 
                 auto LReply = &LJob->Reply();
 
                 try {
-                    if (LGrandType == "client") {
-                        CStringList List;
-                        PQResultToList(LResult, List);
-
-                        if (List.Count() != 0) {
-                            AfterQuery(LReply, _T("/authenticate"), List[0]);
-
-                            List.Delete(0);
-                            if (List.Count() == 0) {
-                                LReply->Content =_T("{}");
-                            } else {
-                                ListToJson(List, LReply->Content, IsArray);
-                                AfterQuery(LReply, Path, LReply->Content);
-                            }
-                        }
-                    } else {
-                        PQResultToJson(LResult, LReply->Content, IsArray);
-                        AfterQuery(LReply, Path, LReply->Content);
-                    }
+                    ResultToReply(LReply, LResult, Path, LGrandType);
                 } catch (Delphi::Exception::Exception &E) {
                     LReply->Content.Clear();
                     ExceptionToJson(0, E, LReply->Content);
                     Log()->Error(APP_LOG_EMERG, 0, E.what());
                 }
+
+                JobDone(LJob->Identity(), LReply->Content);
             }
 
             log_debug1(APP_LOG_DEBUG_CORE, Log(), 0, _T("Query executed runtime: %.2f ms."), (double) ((clock() - start) / (double) CLOCKS_PER_SEC * 1000));
@@ -448,10 +625,26 @@ namespace Apostol {
                 auto LJob = m_pJobs->FindJobByQuery(APollQuery);
                 if (LJob != nullptr) {
                     ExceptionToJson(0, e, LJob->Reply().Content);
+                    JobDone(LJob->Identity(), LJob->Reply().Content);
                 }
-            } else if (LConnection->Protocol() == pWebSocket) {
-                auto LWSRequest = LConnection->WSRequest();
-                auto LWSReply = LConnection->WSReply();
+                Log()->Error(APP_LOG_EMERG, 0, e.what());
+            } else {
+                QueryException(LConnection, e);
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::QueryException(CHTTPServerConnection *AConnection, const std::exception &e) {
+
+            WriteFetchLog(AConnection);
+
+            if (AConnection->Protocol() == pWebSocket) {
+                auto LWSRequest = AConnection->WSRequest();
+                auto LWSReply = AConnection->WSReply();
+
+                // The session was not confirmed.
+                if (AConnection->Data()["path"] == _T("/authorize"))
+                    ResetSession(AConnection);
 
                 const CString LRequest(LWSRequest->Payload());
 
@@ -471,21 +664,23 @@ namespace Apostol {
 
                 CWSProtocol::Response(wsmResponse, LResponse);
 #ifdef _DEBUG
-                DebugMessage("\n[%p] [%s:%d] [%d] [WebSocket] Response:\n%s\n", LConnection,
-                             LConnection->Socket()->Binding()->PeerIP(),
-                             LConnection->Socket()->Binding()->PeerPort(), LConnection->Socket()->Binding()->Handle(),
+                DebugMessage("\n[%p] [%s:%d] [%d] [WebSocket] Response:\n%s\n", AConnection,
+                             AConnection->Socket()->Binding()->PeerIP(),
+                             AConnection->Socket()->Binding()->PeerPort(), AConnection->Socket()->Binding()->Handle(),
                              LResponse.c_str());
 #endif
                 LWSReply->SetPayload(LResponse);
-                LConnection->SendWebSocket(true);
+                AConnection->SendWebSocket(true);
             } else {
-                auto LReply = LConnection->Reply();
+                auto LReply = AConnection->Reply();
 
                 CReply::CStatusType LStatus = CReply::internal_server_error;
 
                 ExceptionToJson(0, e, LReply->Content);
 
-                LConnection->SendReply(LStatus, nullptr, true);
+                ReplyFlight(AConnection, LStatus);
+
+                AConnection->SendReply(LStatus, nullptr, true);
             }
 
             Log()->Error(APP_LOG_EMERG, 0, e.what());
@@ -497,150 +692,301 @@ namespace Apostol {
         }
         //--------------------------------------------------------------------------------------------------------------
 
-        CString CWebService::GetSession(CRequest *ARequest) {
-            const auto& headerSession = ARequest->Headers.Values(_T("Session"));
-            const auto& cookieSession = ARequest->Cookies.Values(_T("AWS-Session"));
+        void CWebService::WriteLog(const CString &Record) {
 
-            return headerSession.IsEmpty() ? cookieSession : headerSession;
-        }
-        //--------------------------------------------------------------------------------------------------------------
+            if (m_LogRing.Push(Record))
+                return;
 
-        int CWebService::CheckSession(CRequest *ARequest, const CString &Path, CString &Session) {
+            // The queue is full or the record is too large: write it directly.
+            m_LogFallback++;
 
-            if (Path.SubString(0, 6) == "/sign/")
-                return -1;
+            auto OnExecuted = [](CPQPollQuery *APollQuery) {
+                auto LResult = APollQuery->Results(0);
+                if (LResult->ExecStatus() != PGRES_TUPLES_OK)
+                    Log()->Error(APP_LOG_WARN, 0, LResult->GetErrorMessage());
+            };
 
-            const auto& LSession = GetSession(ARequest);
+            auto OnException = [](CPQPollQuery *APollQuery, Delphi::Exception::Exception *AException) {
+                Log()->Error(APP_LOG_WARN, 0, AException->what());
+            };
 
-            if (LSession.Length() != 40)
-                return 0;
+            CStringList Params;
+            CStringList SQL;
 
-            Session = LSession;
+            CString Batch(_T("["));
+            Batch << Record;
+            Batch.Append(']');
 
-            return 1;
+            Params.Add(Batch);
+
+            try {
+                SQL.Add(CPQStatement::Get(psWriteLog).Bind(Params));
+                ExecSQL(SQL, nullptr, OnExecuted, OnException);
+            } catch (std::exception &e) {
+                Log()->Error(APP_LOG_WARN, 0, e.what());
+            }
         }
         //--------------------------------------------------------------------------------------------------------------
 
-        CString CWebService::CreateToken(const CCleanToken& CleanToken) {
-            const auto& AuthParams = Server().AuthParams();
-            const auto& Default = AuthParams.Default().Value();
+        void CWebService::WriteFetchLog(CHTTPServerConnection *AConnection) {
 
-            auto token = jwt::create()
-                    .set_issuer(Default.Issuer())
-                    .set_audience(Default.Audience())
-                    .set_issued_at(std::chrono::system_clock::now())
-                    .set_expires_at(std::chrono::system_clock::now() + std::chrono::seconds{3600})
-                    .sign(jwt::algorithm::hs256{std::string(Default.Secret())});
+            const auto& LTime = AConnection->Data()["log_time"];
+            if (LTime.IsEmpty())
+                return;
 
-            return token;
+            const auto Start = (uint64_t) strtoull(LTime.c_str(), nullptr, 10);
+            const auto Now = MsEpoch();
+
+            WriteLog(CLogRecord::Api(Start, AConnection->Data()["log_session"], AConnection->Data()["path"],
+                AConnection->Data()["log_payload"], Now - Start));
+
+            AConnection->Data().Values("log_time", CString());
+            AConnection->Data().Values("log_payload", CString());
         }
         //--------------------------------------------------------------------------------------------------------------
 
-        CString CWebService::VerifyToken(const CString &Token) {
-
-            const auto& GetSecret = [](const CAuthParam& Param) {
-                const auto& Secret = Param.Secret();
-                if (Secret.IsEmpty())
-                    throw ExceptionFrm("Not found \"Secret\" for provider: %s",  Param.Provider.c_str());
-                return Secret;
-            };
+        bool CWebService::EnqueueQuery(CHTTPServerConnection *AConnection, const CStringList &SQL) {
 
-            const auto& AuthParams = Server().AuthParams();
+            if (!m_Pipeline)
+                return StartQuery(AConnection, SQL);
 
-            auto decoded = jwt::decode(Token);
+            CPipelineQuery LQuery;
 
-            const auto& aud = CString(decoded.get_audience());
-            auto Index = OAuth2::Helper::IndexOfAudience(AuthParams, aud);
-            if (Index == -1)
-                throw jwt::token_verification_exception("Token doesn't contain the required audience");
+            LQuery.Connection = AConnection;
+            LQuery.SQL = SQL;
 
-            const auto& AuthParam = AuthParams[Index].Value();
+            m_PipelineQueue.push_back(LQuery);
 
-            const auto& iss = CString(decoded.get_issuer());
-            const CStringList& Issuers = AuthParam.GetIssuers();
-            if (Issuers[iss].IsEmpty())
-                throw jwt::token_verification_exception("Token doesn't contain the required issuer");
+            // A station is dropped from the pipeline by DoSessionDisconnected.
+            if (AConnection->Protocol() != pWebSocket) {
+#if defined(_GLIBCXX_RELEASE) && (_GLIBCXX_RELEASE >= 9)
+                AConnection->OnDisconnected([this](auto && Sender) { DoQueryDisconnected(Sender); });
+#else
+                AConnection->OnDisconnected(std::bind(&CWebService::DoQueryDisconnected, this, _1));
+#endif
+            }
 
-            const auto& alg = decoded.get_algorithm();
-            const auto& ch = alg.substr(0, 2);
-
-            if (ch == "HS") {
-                const auto& Secret = GetSecret(AuthParam);
-                if (alg == "HS256") {
-                    auto verifier = jwt::verify()
-                            .allow_algorithm(jwt::algorithm::hs256{Secret});
-                    verifier.verify(decoded);
-
-                    return Token; // if algorithm HS256
-                } else if (alg == "HS384") {
-                    auto verifier = jwt::verify()
-                            .allow_algorithm(jwt::algorithm::hs384{Secret});
-                    verifier.verify(decoded);
-                } else if (alg == "HS512") {
-                    auto verifier = jwt::verify()
-                            .allow_algorithm(jwt::algorithm::hs512{Secret});
-                    verifier.verify(decoded);
+            if (m_PipelineInFlight < m_PipelineDepth)
+                FlushPipeline();
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::FlushPipeline() {
+
+            if (m_PipelineQueue.empty())
+                return;
+
+            auto LBatch = std::make_shared<std::vector<CPipelineQuery>>();
+            CStringList SQL;
+
+            while (!m_PipelineQueue.empty() && LBatch->size() < (size_t) m_PipelineBatch) {
+                const auto& LQuery = m_PipelineQueue.front();
+
+                // Each statement is committed on its own: an error in one of them must not roll back the others.
+                for (int I = 0; I < LQuery.SQL.Count(); ++I)
+                    SQL.Add(LQuery.SQL[I]);
+                SQL.Add(_T("COMMIT;"));
+
+                LBatch->push_back(LQuery);
+                m_PipelineQueue.pop_front();
+            }
+
+            auto OnExecuted = [this, LBatch](CPQPollQuery *APollQuery) {
+
+                m_PipelineInFlight--;
+                m_PipelineBatches.remove(LBatch);
+
+                for (size_t I = 0; I < LBatch->size(); ++I) {
+                    const auto& LQuery = LBatch->at(I);
+                    const auto Index = (int) I * 2;
+
+                    if (LQuery.Connection == nullptr)
+                        continue;
+
+                    try {
+                        if (Index >= APollQuery->Count()) {
+                            // The server stops executing a batch at the first failed statement, run the rest one by one.
+                            if (!StartQuery(LQuery.Connection, LQuery.SQL)) {
+                                ReplyFlight(LQuery.Connection, CReply::service_unavailable, true);
+                                LQuery.Connection->SendStockReply(CReply::service_unavailable);
+                            }
+                            continue;
+                        }
+
+                        auto LResult = APollQuery->Results(Index);
+
+                        if (LResult->ExecStatus() != PGRES_TUPLES_OK) {
+                            QueryException(LQuery.Connection, Delphi::Exception::EDBError(LResult->GetErrorMessage()));
+                        } else {
+                            QueryResult(LQuery.Connection, LResult);
+                        }
+                    } catch (std::exception &e) {
+                        Log()->Error(APP_LOG_EMERG, 0, e.what());
+                    }
                 }
-            } else if (ch == "RS") {
-
-                const auto& kid = decoded.get_key_id();
-                const auto& key = OAuth2::Helper::GetPublicKey(AuthParams, kid);
-
-                if (alg == "RS256") {
-                    auto verifier = jwt::verify()
-                            .allow_algorithm(jwt::algorithm::rs256{key});
-                    verifier.verify(decoded);
-                } else if (alg == "RS384") {
-                    auto verifier = jwt::verify()
-                            .allow_algorithm(jwt::algorithm::rs384{key});
-                    verifier.verify(decoded);
-                } else if (alg == "RS512") {
-                    auto verifier = jwt::verify()
-                            .allow_algorithm(jwt::algorithm::rs512{key});
-                    verifier.verify(decoded);
+
+                if (m_PipelineInFlight < m_PipelineDepth)
+                    FlushPipeline();
+            };
+
+            auto OnException = [this, LBatch](CPQPollQuery *APollQuery, Delphi::Exception::Exception *AException) {
+
+                m_PipelineInFlight--;
+                m_PipelineBatches.remove(LBatch);
+
+                for (const auto& LQuery : *LBatch) {
+                    if (LQuery.Connection != nullptr)
+                        QueryException(LQuery.Connection, *AException);
+                }
+
+                if (m_PipelineInFlight < m_PipelineDepth)
+                    FlushPipeline();
+            };
+
+            try {
+                if (ExecSQL(SQL, nullptr, OnExecuted, OnException)) {
+                    m_PipelineBatches.push_back(LBatch);
+                    m_PipelineInFlight++;
+                    return;
+                }
+            } catch (std::exception &e) {
+                Log()->Error(APP_LOG_EMERG, 0, e.what());
+            }
+
+            for (const auto& LQuery : *LBatch) {
+                ReplyFlight(LQuery.Connection, CReply::service_unavailable, true);
+                LQuery.Connection->SendStockReply(CReply::service_unavailable);
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::RemovePipeline(CHTTPServerConnection *AConnection) {
+            for (auto it = m_PipelineQueue.begin(); it != m_PipelineQueue.end();) {
+                if (it->Connection == AConnection) {
+                    it = m_PipelineQueue.erase(it);
+                } else {
+                    ++it;
                 }
-            } else if (ch == "ES") {
-
-                const auto& kid = decoded.get_key_id();
-                const auto& key = OAuth2::Helper::GetPublicKey(AuthParams, kid);
-
-                if (alg == "ES256") {
-                    auto verifier = jwt::verify()
-                            .allow_algorithm(jwt::algorithm::es256{key});
-                    verifier.verify(decoded);
-                } else if (alg == "ES384") {
-                    auto verifier = jwt::verify()
-                            .allow_algorithm(jwt::algorithm::es384{key});
-                    verifier.verify(decoded);
-                } else if (alg == "ES512") {
-                    auto verifier = jwt::verify()
-                            .allow_algorithm(jwt::algorithm::es512{key});
-                    verifier.verify(decoded);
+            }
+
+            // The batch still runs, its reply for this connection is thrown away.
+            for (const auto& LBatch : m_PipelineBatches) {
+                for (auto& LQuery : *LBatch) {
+                    if (LQuery.Connection == AConnection)
+                        LQuery.Connection = nullptr;
                 }
-            } else if (ch == "PS") {
-
-                const auto& kid = decoded.get_key_id();
-                const auto& key = OAuth2::Helper::GetPublicKey(AuthParams, kid);
-
-                if (alg == "PS256") {
-                    auto verifier = jwt::verify()
-                            .allow_algorithm(jwt::algorithm::ps256{key});
-                    verifier.verify(decoded);
-                } else if (alg == "PS384") {
-                    auto verifier = jwt::verify()
-                            .allow_algorithm(jwt::algorithm::ps384{key});
-                    verifier.verify(decoded);
-                } else if (alg == "PS512") {
-                    auto verifier = jwt::verify()
-                            .allow_algorithm(jwt::algorithm::ps512{key});
-                    verifier.verify(decoded);
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CString CWebService::GetSession(CRequest *ARequest) {
+            const auto& headerSession = ARequest->Headers.Values(_T("Session"));
+            const auto& cookieSession = ARequest->Cookies.Values(_T("AWS-Session"));
+
+            return headerSession.IsEmpty() ? cookieSession : headerSession;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        int CWebService::CheckSession(CRequest *ARequest, const CString &Path, CString &Session) {
+
+            if (Path.SubString(0, 6) == "/sign/")
+                return -1;
+
+            const auto& LSession = GetSession(ARequest);
+
+            if (LSession.Length() != 40)
+                return 0;
+
+            Session = LSession;
+
+            return 1;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CString CWebService::CreateToken(const CCleanToken& CleanToken) {
+            const auto& AuthParams = Server().AuthParams();
+            const auto& Default = AuthParams.Default().Value();
+
+            auto token = jwt::create()
+                    .set_issuer(Default.Issuer())
+                    .set_audience(Default.Audience())
+                    .set_issued_at(std::chrono::system_clock::now())
+                    .set_expires_at(std::chrono::system_clock::now() + std::chrono::seconds{3600})
+                    .sign(jwt::algorithm::hs256{std::string(Default.Secret())});
+
+            return token;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        CString CWebService::VerifyToken(const CString &Token) {
+
+            const auto& GetSecret = [](const CAuthParam& Param) {
+                const auto& Secret = Param.Secret();
+                if (Secret.IsEmpty())
+                    throw ExceptionFrm("Not found \"Secret\" for provider: %s",  Param.Provider.c_str());
+                return Secret;
+            };
+
+            if (m_KeySegment.Sequence() != m_KeySequence || m_KeySegment.Retired())
+                LoadProviders();
+
+            CString Verified;
+            if (m_TokenCache.Find(Token, Verified))
+                return Verified;
+
+            const auto& AuthParams = Server().AuthParams();
+
+            auto decoded = jwt::decode(Token);
+
+            const auto Expires = decoded.has_expires_at() ? std::chrono::system_clock::to_time_t(decoded.get_expires_at()) :
+                                 time(nullptr) + m_TokenCache.TimeToLive();
+
+            const auto& aud = CString(decoded.get_audience());
+            auto Index = OAuth2::Helper::IndexOfAudience(AuthParams, aud);
+            if (Index == -1)
+                throw jwt::token_verification_exception("Token doesn't contain the required audience");
+
+            const auto& AuthParam = AuthParams[Index].Value();
+
+            const auto& iss = CString(decoded.get_issuer());
+            const CStringList& Issuers = AuthParam.GetIssuers();
+            if (Issuers[iss].IsEmpty())
+                throw jwt::token_verification_exception("Token doesn't contain the required issuer");
+
+            const auto& alg = decoded.get_algorithm();
+            const auto IsHMAC = alg.substr(0, 2) == "HS";
+
+            // An HMAC secret does not depend on the kid, the token may put anything there.
+            const auto& kid = !IsHMAC && decoded.has_key_id() ? decoded.get_key_id() : std::string();
+            const auto& Key = std::string(AuthParam.Provider.c_str()) + '/' + kid + '/' + alg;
+
+            // Hold the table: LoadProviders() may replace it while we are here.
+            const auto Verifiers = m_Verifiers;
+
+            auto verifier = Verifiers->Find(Key);
+            if (verifier == nullptr) {
+                if (IsHMAC) {
+                    verifier = CreateVerifier(alg, GetSecret(AuthParam));
+                } else {
+                    verifier = CreateVerifier(alg, OAuth2::Helper::GetPublicKey(AuthParams, kid));
                 }
+
+                verifier->verify(decoded);
+
+                Verifiers->Add(Key, verifier);
+            } else {
+                verifier->verify(decoded);
             }
 
+            if (alg == "HS256")
+                return m_TokenCache.Add(Token, Token, Expires);
+
             const auto& Secret = GetSecret(AuthParams.Default().Value());
             const auto& Result = CCleanToken(R"({"alg":"HS256","typ":"JWT"})", decoded.get_payload(), true);
 
-            return Result.Sign(jwt::algorithm::hs256{Secret});
+            return m_TokenCache.Add(Token, Result.Sign(jwt::algorithm::hs256{Secret}), Expires);
         }
         //--------------------------------------------------------------------------------------------------------------
 
@@ -704,29 +1050,78 @@ namespace Apostol {
         //--------------------------------------------------------------------------------------------------------------
 
         void CWebService::LoadProviders() {
-            const CString pathCerts = Config()->Prefix() + _T("certs/");
-            const CString lockFile = pathCerts + "lock";
-            if (!FileExists(lockFile.c_str())) {
-                CFile Lock(lockFile.c_str(), FILE_CREATE_OR_OPEN);
-                Lock.Open();
-                auto& AuthParams = Server().AuthParams();
-                for (int i = 0; i < AuthParams.Count(); i++) {
-                    auto &Param = AuthParams[i].Value();
-                    if (FileExists(CString(pathCerts + Param.Provider).c_str())) {
-                        Param.Keys.Clear();
-                        Param.Keys.LoadFromFile(CString(pathCerts + Param.Provider).c_str());
-                    }
-                }
-                Lock.Close(true);
-                if (unlink(lockFile.c_str()) == FILE_ERROR) {
-                    Log()->Error(APP_LOG_ALERT, errno, _T("Could not delete file: \"%s\" error: "), lockFile.c_str());
+            try {
+                if (m_KeySegment.Retired())
+                    m_KeySequence = 0;
+
+                if (!m_KeySegment.Active() || m_KeySegment.Retired())
+                    m_KeySegment.Open();
+
+                if (m_KeySegment.Load(Server().AuthParams(), m_KeySequence)) {
+                    // Tokens must be checked again against the new keys.
+                    m_Verifiers = std::make_shared<CVerifierTable>();
+                    m_TokenCache.Clear();
                 }
-            } else {
+            } catch (std::exception &e) {
+                Log()->Error(APP_LOG_ALERT, 0, e.what());
                 m_FixedDate = Now() + (CDateTime) 1 / 86400; // 1 sec
             }
         }
         //--------------------------------------------------------------------------------------------------------------
 
+        bool CWebService::SendStatic(CHTTPServerConnection *AConnection, const CString &Path, LPCTSTR ContentType) {
+
+            if (!m_StaticCache.Enabled())
+                return false;
+
+            const auto Entry = m_StaticCache.Find(Config()->DocRoot(), Path, ContentType);
+            if (Entry == nullptr)
+                return false;
+
+            auto LRequest = AConnection->Request();
+            auto LReply = AConnection->Reply();
+
+            const auto& IfNoneMatch = LRequest->Headers.Values(_T("If-None-Match"));
+            const auto& IfModifiedSince = LRequest->Headers.Values(_T("If-Modified-Since"));
+
+            const auto NotModified = IfNoneMatch.IsEmpty() ? IfModifiedSince == Entry->LastModified :
+                    IfNoneMatch == _T("*") || IfNoneMatch.Find(Entry->ETag) != CString::npos;
+
+            if (NotModified) {
+                LReply->Content.Clear();
+                CReply::GetReply(LReply, CReply::not_modified);
+            } else {
+                const auto& AcceptEncoding = LRequest->Headers.Values(_T("Accept-Encoding"));
+
+                if (!Entry->Brotli.IsEmpty() && AcceptEncoding.Find(_T("br")) != CString::npos) {
+                    LReply->Content = Entry->Brotli;
+                    CReply::GetReply(LReply, CReply::ok);
+                    LReply->Headers.Values(_T("Content-Encoding"), _T("br"));
+                } else if (!Entry->Gzip.IsEmpty() && AcceptEncoding.Find(_T("gzip")) != CString::npos) {
+                    LReply->Content = Entry->Gzip;
+                    CReply::GetReply(LReply, CReply::ok);
+                    LReply->Headers.Values(_T("Content-Encoding"), _T("gzip"));
+                } else {
+                    LReply->Content = Entry->Content;
+                    CReply::GetReply(LReply, CReply::ok);
+                }
+
+                LReply->Headers.Values(_T("Content-Type"), Entry->ContentType);
+            }
+
+            if (!Entry->Brotli.IsEmpty() || !Entry->Gzip.IsEmpty())
+                LReply->Headers.Values(_T("Vary"), _T("Accept-Encoding"));
+
+            LReply->Headers.Values(_T("ETag"), Entry->ETag);
+            LReply->Headers.Values(_T("Last-Modified"), Entry->LastModified);
+            LReply->Headers.Values(_T("Cache-Control"), _T("no-cache"));
+
+            AConnection->SendReply();
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
         bool CWebService::SignUp(CHTTPServerConnection *AConnection, const CString &Payload) {
 
             auto OnExecuted = [this, AConnection](CPQPollQuery *APollQuery) {
@@ -758,12 +1153,14 @@ namespace Apostol {
 
             };
 
+            CStringList Params;
+
+            Params.Add(m_Password);
+            Params.Add(Payload.IsEmpty() ? _T("{}") : Payload.c_str());
+
             CStringList SQL;
 
-            SQL.Add(CString().Format("SELECT * FROM daemon.SignUp('admin', %s, '%s'::jsonb);",
-                                     m_Password.c_str(),
-                                     Payload.IsEmpty() ? "{}" : Payload.c_str()
-            ));
+            SQL.Add(CPQStatement::Get(psSignUp).Bind(Params));
 
             return ExecSQL(SQL, AConnection, OnExecuted, OnException);
         }
@@ -784,7 +1181,7 @@ namespace Apostol {
                         throw Delphi::Exception::EDBError(LResult->GetErrorMessage());
 
                     PQResultToJson(LResult, LReply->Content);
-                    AfterQuery(LReply, "/sign/in", LReply->Content);
+                    AfterQuery(LReply, "/sign/in", LResult, 0, LResult->nTuples());
                     LStatus = CReply::ok;
                 } catch (Delphi::Exception::Exception &E) {
                     LReply->Content.Clear();
@@ -802,13 +1199,15 @@ namespace Apostol {
 
             };
 
+            CStringList Params;
+
+            Params.Add(Payload.IsEmpty() ? _T("{}") : Payload.c_str());
+            Params.Add(Agent);
+            Params.Add(Host);
+
             CStringList SQL;
 
-            SQL.Add(CString().Format("SELECT * FROM daemon.SignIn('%s'::jsonb, %s, %s);",
-                                     Payload.IsEmpty() ? "{}" : Payload.c_str(),
-                                     PQQuoteLiteral(Agent).c_str(),
-                                     PQQuoteLiteral(Host).c_str()
-            ));
+            SQL.Add(CPQStatement::Get(psSignIn).Bind(Params));
 
             return ExecSQL(SQL, AConnection, OnExecuted, OnException);
         }
@@ -837,11 +1236,13 @@ namespace Apostol {
 
                         if (!Result->GetIsNull(0, 0)) {
                             if (SameText(Result->GetValue(0, 0), _T("t"))) {
+                                m_SessionCache.Add(LSession);
                                 if (!LPath.IsEmpty()) {
                                     SendResource(AConnection, LPath, _T("text/html"), true);
                                     return;
                                 }
                             } else {
+                                m_SessionCache.Delete(LSession);
                                 LReply->SetCookie(_T("API-Key"), _T("null"), _T("/api"), -1);
                                 LReply->SetCookie(_T("AWS-Session"), _T("null"), _T("/"), -1);
                                 if (!Result->GetIsNull(0, 1))
@@ -863,9 +1264,13 @@ namespace Apostol {
 
             };
 
+            CStringList Params;
+
+            Params.Add(Session);
+
             CStringList SQL;
 
-            SQL.Add(CString().Format("SELECT * FROM daemon.Authorize('%s');", Session.c_str()));
+            SQL.Add(CPQStatement::Get(psAuthorize).Bind(Params));
 
             AConnection->Data().Values("session", Session);
             AConnection->Data().Values("path", Path);
@@ -874,165 +1279,416 @@ namespace Apostol {
         }
         //--------------------------------------------------------------------------------------------------------------
 
-        void CWebService::AuthFetch(CHTTPServerConnection *AConnection, const CAuthorization &Authorization,
-                const CString &Path, const CString &Payload, const CString &Agent, const CString &Host) {
+        bool CWebService::CheckSignature(const CString &Path, const CString &Payload, const CString &Session,
+                const CString &Nonce, const CString &Signature, long int ReceiveWindow) {
 
-            CStringList SQL;
+            if (Path == "/sign/in" || Path == "/sign/up")
+                return false;
 
-            if (Authorization.Schema == CAuthorization::asBasic) {
-                SQL.Add(CString().Format("SELECT * FROM daemon.%s(%s, %s, %s, '%s'::jsonb, %s, %s);",
-                                         Authorization.GrantType == CAuthorization::agtOwner ? "Fetch" : "AuthFetch",
-                                         PQQuoteLiteral(Authorization.Username).c_str(),
-                                         PQQuoteLiteral(Authorization.Password).c_str(),
-                                         PQQuoteLiteral(Path).c_str(),
-                                         Payload.IsEmpty() ? "{}" : Payload.c_str(),
-                                         PQQuoteLiteral(Agent).c_str(),
-                                         PQQuoteLiteral(Host).c_str()
-                ));
+            if (Nonce.IsEmpty())
+                throw CAuthorizationError(_T("Nonce cannot be empty."));
 
-                if (Authorization.GrantType == CAuthorization::agtOwner)
-                    AConnection->Data().Values("grant_type", "owner");
-                else
-                    AConnection->Data().Values("grant_type", "client");
+            // Same rules as daemon.SignFetch: nonce in microseconds, window in milliseconds (no more than 1 min).
+            const auto nonce = strtod(Nonce.c_str(), nullptr);
+            const auto now = (double) MsEpoch() * 1000;
+            const auto window = (double) (ReceiveWindow > 60000 ? 60000 : ReceiveWindow) * 1000;
 
-            } else if (Authorization.Schema == CAuthorization::asBearer) {
-                SQL.Add(CString().Format("SELECT * FROM daemon.TokenFetch(%s, '%s', %s, '%s'::jsonb, %s, %s);",
-                                         m_Password.c_str(),
-                                         Authorization.Token.c_str(),
-                                         PQQuoteLiteral(Path).c_str(),
-                                         Payload.IsEmpty() ? "{}" : Payload.c_str(),
-                                         PQQuoteLiteral(Agent).c_str(),
-                                         PQQuoteLiteral(Host).c_str()
-                ));
+            if (nonce >= now + 1000000 || now - nonce > window)
+                throw CAuthorizationError(_T("Nonce expired."));
 
-                if (Authorization.TokenType == CAuthorization::attAccess)
-                    AConnection->Data().Values("token_type", "access");
-                else
-                    AConnection->Data().Values("token_type", "refresh");
+            // Without the secret the signature is left to daemon.SignFetch.
+            CString Secret;
+            if (!m_SecretCache.Find(Session, Secret))
+                return false;
 
-            } else {
-                AConnection->SendStockReply(CReply::bad_request);
-                return;
-            }
+            // The signature covers the nonce as a number: "1e15", "0001000000000000000" and so on sign alike.
+            const CString Normalized(CString().Format("%.0f", nonce));
 
-            AConnection->Data().Values("signature", "false");
-            AConnection->Data().Values("path", Path);
+            CString sigData(Path);
+            sigData << Normalized;
+            sigData << ((Payload.IsEmpty() || Payload == _T("{}")) ? _T("null") : Payload.c_str());
 
-            if (!StartQuery(AConnection, SQL)) {
-                AConnection->SendStockReply(CReply::service_unavailable);
-            }
+            const auto& Expected = hmac_sha256(Secret, sigData);
+
+            unsigned char diff = Expected.Length() == Signature.Length() ? 0 : 1;
+            for (size_t i = 0; i < Expected.Length() && i < Signature.Length(); ++i)
+                diff |= (unsigned char) (Expected[i] ^ Signature[i]);
+
+            if (diff != 0)
+                throw CAuthorizationError(_T("Signature invalid."));
+
+            // Only nonces of verified requests are remembered, otherwise anyone could burn a session's nonces. The
+            // key is the signed form of the nonce, so another spelling of the same number is a replay.
+            if (!m_NonceStore.Add(Session, Normalized, nonce))
+                throw CAuthorizationError(_T("Nonce already used."));
+
+            return true;
         }
         //--------------------------------------------------------------------------------------------------------------
 
-        void CWebService::SignFetch(CHTTPServerConnection *AConnection, const CString &Path, const CString &Payload,
-                const CString &Session, const CString &Nonce, const CString &Signature, const CString &Agent,
-                const CString &Host, long int ReceiveWindow) {
+        bool CWebService::CachedFetch(CHTTPServerConnection *AConnection, const CString &Owner, const CString &Path,
+                const CString &Payload) {
 
-            CStringList SQL;
+            // A keep-alive connection carries the data of its previous request.
+            AConnection->Data().Values("cache_key", CString());
 
-            if (Path == "/sign/in") {
-                SQL.Add(CString().Format("SELECT * FROM daemon.SignIn('%s'::jsonb, %s, %s);",
-                                         Payload.IsEmpty() ? "{}" : Payload.c_str(),
-                                         PQQuoteLiteral(Agent).c_str(),
-                                         PQQuoteLiteral(Host).c_str()
-                ));
-            } else if (Path == "/sign/up") {
-                SQL.Add(CString().Format("SELECT * FROM daemon.SignUp('admin', %s, '%s'::jsonb);",
-                                         m_Password.c_str(),
-                                         Payload.IsEmpty() ? "{}" : Payload.c_str()
-                ));
-            } else {
-                SQL.Add(CString().Format("SELECT * FROM daemon.SignFetch(%s, '%s'::json, %s, %s, %s, %s, %s, INTERVAL '%d milliseconds');",
-                                         PQQuoteLiteral(Path).c_str(),
-                                         Payload.IsEmpty() ? "{}" : Payload.c_str(),
-                                         PQQuoteLiteral(Session).c_str(),
-                                         PQQuoteLiteral(Nonce).c_str(),
-                                         PQQuoteLiteral(Signature).c_str(),
-                                         PQQuoteLiteral(Agent).c_str(),
-                                         PQQuoteLiteral(Host).c_str(),
-                                         ReceiveWindow
-                ));
+            if (Owner.IsEmpty())
+                return false;
+
+            if (CResponseCache::ChangesSession(Path)) {
+                m_ResponseCache.Delete(Owner);
+                return false;
             }
 
-            AConnection->Data().Values("signature", "true");
-            AConnection->Data().Values("path", Path);
+            if (!m_ResponseCache.Enabled() || AConnection->Protocol() == pWebSocket)
+                return false;
 
-            if (!StartQuery(AConnection, SQL)) {
-                AConnection->SendStockReply(CReply::service_unavailable);
-            }
-        }
-        //--------------------------------------------------------------------------------------------------------------
+            if (m_ResponseCache.FindRule(Path) == nullptr)
+                return false;
 
-        void CWebService::DoSessionDisconnected(CObject *Sender) {
-            auto LConnection = dynamic_cast<CHTTPServerConnection *>(Sender);
-            if (LConnection != nullptr) {
-                auto LSession = m_SessionManager.FindByConnection(LConnection);
-                if (LSession != nullptr) {
-                    Log()->Message(_T("[%s:%d] WebSocket Session %s closed connection."), LConnection->Socket()->Binding()->PeerIP(),
-                                   LConnection->Socket()->Binding()->PeerPort(),
-                                   LSession->Identity().IsEmpty() ? "(empty)" : LSession->Identity().c_str());
-                    delete LSession;
-                } else {
-                    Log()->Message(_T("[%s:%d] WebSocket Session closed connection."), LConnection->Socket()->Binding()->PeerIP(),
-                                   LConnection->Socket()->Binding()->PeerPort());
-                }
+            const auto& Key = CResponseCache::Key(Owner, Path, Payload);
+            if (Key.IsEmpty())
+                return false;
+
+            auto LReply = AConnection->Reply();
+
+            if (m_ResponseCache.Find(Key, LReply->Content)) {
+                LReply->ContentType = CReply::json;
+                AConnection->SendReply(CReply::ok, nullptr, true);
+                return true;
             }
+
+            AConnection->Data().Values("cache_key", Key);
+            AConnection->Data().Values("cache_owner", Owner);
+
+            return false;
         }
         //--------------------------------------------------------------------------------------------------------------
 
-        void CWebService::DoObject(CHTTPServerConnection *AConnection, const CStringList &Routs) {
+        bool CWebService::JoinFlight(CHTTPServerConnection *AConnection, const CString &Owner, const CString &Path,
+                const CString &Payload) {
 
-            auto CheckParams = [this] (const CStringList &Params, const CString &Action, CString &Route, CJSON &Json) {
+            AConnection->Data().Values("flight_key", CString());
 
-                const auto& Id = Params["id"];
-                if (!Id.IsEmpty())
-                    Json.Object().AddPair("id", Id);
+            if (Owner.IsEmpty() || !m_FlightTable.Enabled() || AConnection->Protocol() == pWebSocket)
+                return false;
 
-                if (Action == "method") {
-                    Route << "/method";
-                } else if (Action == "count") {
-                    Route << "/count";
-                } else {
-                    if (Id.IsEmpty()) {
-                        Route << "/list";
-                    } else {
-                        Route << "/get";
-                    }
-                }
-            };
+            if (!CFlightTable::IsRead(Path) && m_ResponseCache.FindRule(Path) == nullptr)
+                return false;
 
-            auto LRequest = AConnection->Request();
-            auto LReply = AConnection->Reply();
+            const auto& Key = CFlightTable::Key(Owner, Path, Payload);
 
-            const auto& LCommand = Routs[2].Lower();
-            const auto& LAction = Routs.Count() == 4 ? Routs[3].Lower() : "";
+            const auto Joined = m_FlightTable.Join(Key, AConnection);
 
-            CString LPath;
-            CJSON Json;
+            if (!Joined) {
+                if (!m_FlightTable.Start(Key))
+                    return false;
 
-            if (LCommand == "whoami") {
+                AConnection->Data().Values("flight_key", Key);
+            }
 
-                LPath = "/";
-                LPath += LCommand;
+#if defined(_GLIBCXX_RELEASE) && (_GLIBCXX_RELEASE >= 9)
+            AConnection->OnDisconnected([this](auto && Sender) { DoQueryDisconnected(Sender); });
+#else
+            AConnection->OnDisconnected(std::bind(&CWebService::DoQueryDisconnected, this, _1));
+#endif
+            return Joined;
+        }
+        //--------------------------------------------------------------------------------------------------------------
 
-            } else if (LCommand == "current" && !LAction.IsEmpty()) {
+        void CWebService::ReplyFlight(CHTTPServerConnection *AConnection, CReply::CStatusType Status, bool Stock) {
 
-                LPath = "/";
-                LPath += LCommand;
-                LPath += "/";
-                LPath += LAction;
+            const auto& Key = AConnection->Data()["flight_key"];
+            if (Key.IsEmpty())
+                return;
 
-            } else if (LCommand == "method") {
+            std::vector<CHTTPServerConnection *> Waiters;
+            m_FlightTable.Land(Key, Waiters);
 
-                LPath = "/";
-                LPath += LCommand;
+            AConnection->Data().Values("flight_key", CString());
 
-                if (LAction == "get") {
+            const auto LReply = AConnection->Reply();
 
-                    LPath += "/get";
+            for (auto LWaiter : Waiters) {
+                try {
+                    if (Stock) {
+                        LWaiter->SendStockReply(Status);
+                        continue;
+                    }
 
-                    const auto& Object = LRequest->Params["object"];
-                    const auto& Class = LRequest->Params["class"];
+                    auto LWaiterReply = LWaiter->Reply();
+
+                    LWaiterReply->ContentType = LReply->ContentType;
+                    LWaiterReply->Content = LReply->Content;
+
+                    LWaiter->SendReply(Status, nullptr, true);
+                } catch (std::exception &e) {
+                    Log()->Error(APP_LOG_EMERG, 0, e.what());
+                }
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CWebService::AuthStatement(const CAuthorization &Authorization, const CString &Path,
+                const CString &Payload, const CString &Agent, const CString &Host, CStringList &SQL) const {
+
+            CStringList Params;
+
+            if (Authorization.Schema == CAuthorization::asBasic) {
+                Params.Add(Authorization.Username);
+                Params.Add(Authorization.Password);
+                Params.Add(Path);
+                Params.Add(Payload.IsEmpty() ? _T("{}") : Payload.c_str());
+                Params.Add(Agent);
+                Params.Add(Host);
+
+                SQL.Add(CPQStatement::Get(Authorization.GrantType == CAuthorization::agtOwner ? psFetch : psAuthFetch).Bind(Params));
+
+                return true;
+            }
+
+            if (Authorization.Schema == CAuthorization::asBearer) {
+                Params.Add(m_Password);
+                Params.Add(Authorization.Token);
+                Params.Add(Path);
+                Params.Add(Payload.IsEmpty() ? _T("{}") : Payload.c_str());
+                Params.Add(Agent);
+                Params.Add(Host);
+
+                SQL.Add(CPQStatement::Get(psTokenFetch).Bind(Params));
+
+                return true;
+            }
+
+            return false;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::AuthFetch(CHTTPServerConnection *AConnection, const CAuthorization &Authorization,
+                const CString &Path, const CString &Payload, const CString &Agent, const CString &Host) {
+
+            // Replies are not cached here: the worker is not told when a token is revoked.
+            AConnection->Data().Values("cache_key", CString());
+
+            const auto IsAccess = Authorization.Schema == CAuthorization::asBearer &&
+                    Authorization.TokenType == CAuthorization::attAccess;
+
+            // The same reply goes to the same credential: a password of the owner or an access token. A client
+            // grant gets a new key with every reply, it is never shared.
+            CString LFlightOwner;
+            if (Authorization.Schema == CAuthorization::asBasic &&
+                    Authorization.GrantType == CAuthorization::agtOwner) {
+                LFlightOwner << _T("basic:") << Authorization.Username << _T(":") << Authorization.Password;
+            } else if (IsAccess) {
+                LFlightOwner << _T("bearer:") << Authorization.Token;
+            }
+
+            if (JoinFlight(AConnection, LFlightOwner, Path, Payload))
+                return;
+
+            CStringList SQL;
+
+            if (!AuthStatement(Authorization, Path, Payload, Agent, Host, SQL)) {
+                ReplyFlight(AConnection, CReply::bad_request, true);
+                AConnection->SendStockReply(CReply::bad_request);
+                return;
+            }
+
+            if (Authorization.Schema == CAuthorization::asBasic) {
+                if (Authorization.GrantType == CAuthorization::agtOwner)
+                    AConnection->Data().Values("grant_type", "owner");
+                else
+                    AConnection->Data().Values("grant_type", "client");
+
+                if (Path == "/sign/out") {
+                    m_SecretCache.Delete(Authorization.Username);
+                    m_SessionCache.Delete(Authorization.Username);
+                }
+
+                // The session may have signed replies in the cache.
+                if (CResponseCache::ChangesSession(Path))
+                    m_ResponseCache.Delete(Authorization.Username);
+
+            } else {
+                if (Authorization.TokenType == CAuthorization::attAccess)
+                    AConnection->Data().Values("token_type", "access");
+                else
+                    AConnection->Data().Values("token_type", "refresh");
+            }
+
+            AConnection->Data().Values("signature", "false");
+            AConnection->Data().Values("path", Path);
+
+            if (!EnqueueQuery(AConnection, SQL)) {
+                ReplyFlight(AConnection, CReply::service_unavailable, true);
+                AConnection->SendStockReply(CReply::service_unavailable);
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::SignFetch(CHTTPServerConnection *AConnection, const CString &Path, const CString &Payload,
+                const CString &Session, const CString &Nonce, const CString &Signature, const CString &Agent,
+                const CString &Host, long int ReceiveWindow, bool Verified) {
+
+            CStringList Params;
+            CStringList SQL;
+
+            if (Path == "/sign/in") {
+                Params.Add(Payload.IsEmpty() ? _T("{}") : Payload.c_str());
+                Params.Add(Agent);
+                Params.Add(Host);
+
+                SQL.Add(CPQStatement::Get(psSignIn).Bind(Params));
+            } else if (Path == "/sign/up") {
+                Params.Add(m_Password);
+                Params.Add(Payload.IsEmpty() ? _T("{}") : Payload.c_str());
+
+                SQL.Add(CPQStatement::Get(psSignUp).Bind(Params));
+            } else {
+                // Only a request whose signature was checked in the worker may get a cached reply.
+                if (Verified) {
+                    if (CachedFetch(AConnection, Session, Path, Payload))
+                        return;
+                } else {
+                    AConnection->Data().Values("cache_key", CString());
+                }
+
+                Params.Add(Path);
+                Params.Add(Payload.IsEmpty() ? _T("{}") : Payload.c_str());
+                Params.Add(Session);
+                Params.Add(Nonce);
+                Params.Add(Signature);
+                Params.Add(Agent);
+                Params.Add(Host);
+                Params.Add(CString().Format("%ld milliseconds", ReceiveWindow));
+                Params.Add(m_LogRing.Active() ? _T("false") : _T("true"));
+
+                SQL.Add(CPQStatement::Get(psSignFetch).Bind(Params));
+
+                if (m_LogRing.Active()) {
+                    AConnection->Data().Values("log_time", to_string(MsEpoch()));
+                    AConnection->Data().Values("log_session", Session);
+                    AConnection->Data().Values("log_payload", Payload);
+                }
+
+                if (Path == "/sign/out") {
+                    m_SecretCache.Delete(Session);
+                    m_SessionCache.Delete(Session);
+                }
+            }
+
+            AConnection->Data().Values("signature", "true");
+            AConnection->Data().Values("path", Path);
+
+            if (!EnqueueQuery(AConnection, SQL)) {
+                AConnection->SendStockReply(CReply::service_unavailable);
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::DoJobDisconnected(CObject *Sender) {
+            auto LConnection = dynamic_cast<CHTTPServerConnection *>(Sender);
+            if (LConnection != nullptr)
+                m_JobWaiters.Remove(LConnection);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::DoQueryDisconnected(CObject *Sender) {
+            auto LConnection = dynamic_cast<CHTTPServerConnection *>(Sender);
+            if (LConnection == nullptr)
+                return;
+
+            RemovePipeline(LConnection);
+
+            m_FlightTable.Remove(LConnection);
+
+            // The reply of the query this request started would never reach its waiters.
+            ReplyFlight(LConnection, CReply::service_unavailable, true);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::DoSessionDisconnected(CObject *Sender) {
+            auto LConnection = dynamic_cast<CHTTPServerConnection *>(Sender);
+            if (LConnection != nullptr) {
+                m_JobWaiters.Remove(LConnection);
+
+                RemovePipeline(LConnection);
+
+                auto LSession = m_SessionManager.FindByConnection(LConnection);
+                if (LSession != nullptr) {
+                    Log()->Message(_T("[%s:%d] WebSocket Session %s closed connection."), LConnection->Socket()->Binding()->PeerIP(),
+                                   LConnection->Socket()->Binding()->PeerPort(),
+                                   LSession->Identity().IsEmpty() ? "(empty)" : LSession->Identity().c_str());
+                    m_SessionDirectory.Detach(LSession->Identity(), LConnection);
+                    m_BootQueue.Remove(LConnection);
+                    delete LSession;
+                } else {
+                    Log()->Message(_T("[%s:%d] WebSocket Session closed connection."), LConnection->Socket()->Binding()->PeerIP(),
+                                   LConnection->Socket()->Binding()->PeerPort());
+                }
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::DoNotify(const CString &Channel, const CString &Payload) {
+            if (Channel == _T("session")) {
+                m_SessionCache.Delete(Payload);
+                m_SecretCache.Delete(Payload);
+                m_ResponseCache.Delete(Payload);
+            } else if (Channel == _T("idtag")) {
+                m_IdTagCache.Delete(Payload);
+            } else if (Channel == _T("cache")) {
+                m_ResponseCache.Invalidate(Payload);
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::DoObject(CHTTPServerConnection *AConnection, const CRouteMatch &Route) {
+
+            auto CheckParams = [this] (const CStringList &Params, const CString &Action, CString &Path, CJSON &Json) {
+
+                const auto& Id = Params["id"];
+                if (!Id.IsEmpty())
+                    Json.Object().AddPair("id", Id);
+
+                if (Action == "method") {
+                    Path << "/method";
+                } else if (Action == "count") {
+                    Path << "/count";
+                } else {
+                    if (Id.IsEmpty()) {
+                        Path << "/list";
+                    } else {
+                        Path << "/get";
+                    }
+                }
+            };
+
+            auto LRequest = AConnection->Request();
+            auto LReply = AConnection->Reply();
+
+            CString LPath;
+            CJSON Json;
+
+            switch (Route.Id) {
+                case rtWhoAmI:
+                    LPath = "/whoami";
+                    break;
+
+                case rtCurrent:
+                    LPath = "/current/";
+                    LPath += Route.Value(0).Lower();
+                    break;
+
+                case rtMethod:
+                    LPath = "/method";
+                    break;
+
+                case rtMethodGet: {
+                    LPath = "/method/get";
+
+                    const auto& Object = LRequest->Params["object"];
+                    const auto& Class = LRequest->Params["class"];
                     const auto& State = LRequest->Params["state"];
                     const auto& ClassCode = LRequest->Params["classcode"];
                     const auto& StateCode = LRequest->Params["statecode"];
@@ -1053,18 +1709,19 @@ namespace Apostol {
 
                     if (!StateCode.IsEmpty())
                         jsonObject.AddPair("statecode", StateCode);
-                } else if (!LAction.IsEmpty()) {
-                    AConnection->SendStockReply(CReply::not_found);
-                    return;
+
+                    break;
                 }
 
-            } else if (LCommand == "client" || LCommand == "contract" || LCommand == "address") {
-                LPath = "/";
-                LPath += LCommand;
-                CheckParams(LRequest->Params, LAction, LPath, Json);
-            } else {
-                AConnection->SendStockReply(CReply::not_found);
-                return;
+                case rtObject:
+                    LPath = "/";
+                    LPath += Route.Value(0).Lower();
+                    CheckParams(LRequest->Params, Route.Value(1).Lower(), LPath, Json);
+                    break;
+
+                default:
+                    AConnection->SendStockReply(CReply::not_found);
+                    return;
             }
 
             try {
@@ -1077,208 +1734,1030 @@ namespace Apostol {
                 const auto &LAgent = GetUserAgent(AConnection);
                 const auto &LHost = GetHost(AConnection);
 
-                AuthFetch(AConnection, LAuthorization, LPath, Json.ToString(), LAgent, LHost);
-            } catch (std::exception &e) {
-                AConnection->CloseConnection(true);
-                AConnection->SendStockReply(CReply::bad_request);
-                Log()->Error(APP_LOG_EMERG, 0, e.what());
-            }
+                AuthFetch(AConnection, LAuthorization, LPath, Json.ToString(), LAgent, LHost);
+            } catch (std::exception &e) {
+                AConnection->CloseConnection(true);
+                AConnection->SendStockReply(CReply::bad_request);
+                Log()->Error(APP_LOG_EMERG, 0, e.what());
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::DoOAuth2(CHTTPServerConnection *AConnection, const CRouteMatch &Route) {
+
+            auto AddParam = [AConnection](const CJSONMember &Item, TCHAR Separator = '&') {
+
+                const auto& Key = Item.String();
+                const auto& Value = Item.Value().AsString();
+
+                if (Value.IsEmpty())
+                    throw ExceptionFrm(_T("OAuth2: Parameter \"%s\" is empty."), Key.c_str());
+
+                CString Result;
+
+                Result << Separator;
+                Result << Item.String();
+                Result << _T("=");
+
+                if (Key == _T("redirect_uri") && Value.front() == '/') {
+                    const auto& Origin = GetOrigin(AConnection);
+                    Result << CHTTPServer::URLEncode(Origin + Value);
+                } else {
+                    Result << CHTTPServer::URLEncode(Value);
+                }
+
+                return Result;
+            };
+
+            auto LRequest = AConnection->Request();
+            auto LReply = AConnection->Reply();
+
+            LReply->ContentType = CReply::html;
+
+            CString Location;
+
+            const auto& Provider = Route.Value(0);
+
+            if (Route.Count == 1) {
+
+                const auto& AuthParams = Server().AuthParams();
+                const auto& AuthParam = AuthParams[Provider].Value();
+
+                const auto& AuthURI = AuthParam.AuthURI();
+                const auto& ClientId = AuthParam.Audience();
+
+                CJSON jsonParams;
+                if (LRequest->Content.IsEmpty()) {
+                    for (int i = 0; i < LRequest->Params.Count(); ++i) {
+                        jsonParams.Object().AddPair(LRequest->Params.Names(i), LRequest->Params.ValueFromIndex(i));
+                    }
+                } else {
+                    ContentToJson(LRequest, jsonParams);
+                }
+
+                const auto& Params = jsonParams.Object();
+
+                Location = AuthURI;
+                Location += AddParam(CJSONMember("client_id", ClientId), '?');
+
+                for (int i = 0; i < Params.Count(); i++)
+                    Location += AddParam(Params.Members(i), '&');
+
+            } else {
+                const auto& Action = Route.Value(1);
+
+                if (Action == "code") {
+
+                } else if (Action == "callback") {
+
+                }
+
+                DebugMessage("Callback (href): %s\n", LRequest->Location.href().c_str());
+                Location = "/";
+            }
+
+            DebugMessage("Location: %s\n", Location.c_str());
+            Redirect(AConnection, Location);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::DoAPI(CHTTPServerConnection *AConnection, const CRouteMatch &Route) {
+            auto LReply = AConnection->Reply();
+
+            LReply->ContentType = CReply::json;
+
+            try {
+                switch (Route.Id) {
+                    case rtPing:
+                        AConnection->SendStockReply(CReply::ok);
+                        break;
+
+                    case rtTime:
+                        LReply->Content << "{\"serverTime\": " << to_string(MsEpoch()) << "}";
+                        AConnection->SendReply(CReply::ok);
+                        break;
+
+                    case rtMetrics:
+                        DoMetrics(AConnection);
+                        break;
+
+                    case rtConnectors:
+                        DoConnectors(AConnection);
+                        break;
+
+                    case rtJob: {
+                        const auto& Identity = Route.Value(0);
+
+                        if (Identity.Length() != APOSTOL_MODULE_UID_LENGTH) {
+                            AConnection->SendStockReply(CReply::bad_request);
+                            return;
+                        }
+
+                        CJobWaiter Waiter;
+
+                        Waiter.Connection = AConnection;
+                        Waiter.Identity = Identity;
+                        Waiter.Deadline = MsEpoch() + StrToIntDef(AConnection->Request()->Params["wait"].c_str(), 0);
+
+                        WaitJob(Waiter);
+
+                        break;
+                    }
+
+                    default:
+                        DoObject(AConnection, Route);
+                        break;
+                }
+            } catch (std::exception &e) {
+                ExceptionToJson(0, e, LReply->Content);
+
+                AConnection->CloseConnection(true);
+                AConnection->SendReply(CReply::bad_request);
+
+                Log()->Error(APP_LOG_EMERG, 0, e.what());
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CWebService::SendToStation(const CString &Identity, const CString &Message, bool Forward) {
+            auto lpSession = m_SessionManager.FindByIdentity(Identity);
+            if (lpSession != nullptr && lpSession->Connection() != nullptr) {
+                auto LConnection = lpSession->Connection();
+                LConnection->WSReply()->SetPayload(Message);
+                LConnection->SendWebSocket(true);
+                return true;
+            }
+
+            if (!Forward)
+                return false;
+
+            CSessionRecord Record;
+            if (!m_SessionDirectory.Find(Identity, Record) || Record.Worker == 0 || Record.Worker == getpid())
+                return false;
+
+            CString Packet(Identity);
+            Packet.Append('\n');
+            Packet << Message;
+
+            return m_Channel.Send(Record.Worker, Packet);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::DoStation(CHTTPServerConnection *AConnection, const CString &Identity) {
+            auto LRequest = AConnection->Request();
+
+            CAuthorization LAuthorization;
+            if (!CheckAuthorization(AConnection, LAuthorization)) {
+                AConnection->SendReply();
+                return;
+            }
+
+            const CJSON Message(LRequest->Content);
+            if (!Message.IsArray())
+                throw Delphi::Exception::Exception(_T("Expected an OCPP message (JSON array)."));
+
+            const auto IsClient = LAuthorization.Schema == CAuthorization::asBasic &&
+                    LAuthorization.GrantType != CAuthorization::agtOwner;
+
+            const CString LMessage(LRequest->Content);
+
+            auto OnExecuted = [this, AConnection, Identity, LMessage, IsClient](CPQPollQuery *APollQuery) {
+
+                auto LReply = AConnection->Reply();
+                auto LResult = APollQuery->Results(0);
+
+                try {
+                    if (LResult->ExecStatus() != PGRES_TUPLES_OK)
+                        throw Delphi::Exception::EDBError(LResult->GetErrorMessage());
+
+                    const auto Count = LResult->nTuples();
+                    const auto From = IsClient ? 1 : 0;
+
+                    if (IsClient && Count > 0)
+                        AfterQuery(LReply, _T("/authenticate"), LResult, 0, 1);
+
+                    bool Allowed = false;
+
+                    for (int Row = From; Row < Count; ++Row) {
+                        if (LResult->GetIsNull(Row, 0))
+                            continue;
+
+                        const CJSON Payload(CString(LResult->GetValue(Row, 0)));
+
+                        if (Payload.HasOwnProperty(_T("error"))) {
+                            LReply->ContentType = CReply::json;
+                            LReply->Content = Payload.ToString();
+                            AConnection->SendReply(CReply::forbidden, nullptr, true);
+                            return;
+                        }
+
+                        if (Payload[_T("identity")].AsString() == Identity)
+                            Allowed = true;
+                    }
+
+                    if (!Allowed) {
+                        AConnection->SendStockReply(CReply::forbidden, true);
+                        return;
+                    }
+
+                    AConnection->SendStockReply(SendToStation(Identity, LMessage) ? CReply::accepted : CReply::not_found, true);
+                } catch (Delphi::Exception::Exception &E) {
+                    LReply->Content.Clear();
+                    ExceptionToJson(0, E, LReply->Content);
+                    Log()->Error(APP_LOG_EMERG, 0, E.what());
+
+                    AConnection->SendReply(CReply::internal_server_error, nullptr, true);
+                }
+            };
+
+            auto OnException = [this, AConnection](CPQPollQuery *APollQuery, Delphi::Exception::Exception *AException) {
+
+                Log()->Error(APP_LOG_EMERG, 0, AException->what());
+                AConnection->SendStockReply(CReply::internal_server_error, true);
+
+            };
+
+            // Sending a command changes the station: the caller needs the right to update it, not just to see it.
+            CJSON Json;
+            Json.Object().AddPair(_T("identity"), Identity);
+
+            CStringList SQL;
+
+            if (!AuthStatement(LAuthorization, _T("/charge_point/control"), Json.ToString(),
+                    GetUserAgent(AConnection), GetHost(AConnection), SQL)) {
+                AConnection->SendStockReply(CReply::bad_request);
+                return;
+            }
+
+            if (!ExecSQL(SQL, AConnection, OnExecuted, OnException))
+                AConnection->SendStockReply(CReply::service_unavailable);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CWebService::OcppFetch(CHTTPServerConnection *AConnection, CPQStatementId Id, const CWSMessage &Request,
+                const CString &Identity, const CString &Payload, COnOcppResponse && OnResponse) {
+
+            auto SendResponse = [](CPQPollQuery *APollQuery, const CWSMessage &Response) {
+                // The core unbinds the query when the station goes away while it runs.
+                auto LConnection = dynamic_cast<CHTTPServerConnection *> (APollQuery->PollConnection());
+                if (LConnection == nullptr)
+                    return;
+
+                CString LResponse;
+                CWSProtocol::Response(Response, LResponse);
+#ifdef _DEBUG
+                DebugMessage("\n[%p] [%s:%d] [%d] [WebSocket] Response:\n%s\n", LConnection, LConnection->Socket()->Binding()->PeerIP(),
+                             LConnection->Socket()->Binding()->PeerPort(), LConnection->Socket()->Binding()->Handle(), LResponse.c_str());
+#endif
+                LConnection->WSReply()->SetPayload(LResponse);
+                LConnection->SendWebSocket(true);
+            };
+
+            const auto Start = MsEpoch();
+
+            auto WriteOcppLog = [this, Start, Identity, Payload, Request](const CString &Response) {
+                if (m_LogRing.Active())
+                    WriteLog(CLogRecord::Ocpp(Start, Identity, Request.Action, Payload, Response, MsEpoch() - Start));
+            };
+
+            auto ErrorResponse = [](const CString &Message) {
+                CString Result(_T("{\"error\": "));
+                CLogRecord::AppendString(Result, Message);
+                Result.Append('}');
+                return Result;
+            };
+
+            auto OnExecuted = [this, Request, SendResponse, WriteOcppLog, ErrorResponse, OnResponse](CPQPollQuery *APollQuery) {
+
+                CWSMessage wsmResponse;
+                CWSProtocol::PrepareResponse(Request, wsmResponse);
+
+                CString Response;
+
+                try {
+                    auto LResult = APollQuery->Results(0);
+
+                    if (LResult->ExecStatus() != PGRES_TUPLES_OK)
+                        throw Delphi::Exception::EDBError(LResult->GetErrorMessage());
+
+                    if (LResult->nTuples() == 0 || LResult->GetIsNull(0, 0))
+                        throw Delphi::Exception::EDBError(_T("Empty response."));
+
+                    Response = LResult->GetValue(0, 0);
+
+                    wsmResponse.Payload << Response;
+
+                    WriteOcppLog(Response);
+                } catch (Delphi::Exception::Exception &E) {
+                    m_OcppRouter.Fail();
+
+                    Response.Clear();
+
+                    WriteOcppLog(ErrorResponse(E.what()));
+
+                    wsmResponse.MessageTypeId = mtCallError;
+                    wsmResponse.ErrorCode = CReply::internal_server_error;
+                    wsmResponse.ErrorMessage = E.what();
+
+                    Log()->Error(APP_LOG_EMERG, 0, E.what());
+                }
+
+                SendResponse(APollQuery, wsmResponse);
+
+                if (OnResponse != nullptr)
+                    OnResponse(Response);
+            };
+
+            auto OnException = [this, Request, SendResponse, WriteOcppLog, ErrorResponse, OnResponse](CPQPollQuery *APollQuery, Delphi::Exception::Exception *AException) {
+
+                m_OcppRouter.Fail();
+
+                WriteOcppLog(ErrorResponse(AException->what()));
+
+                CWSMessage wsmResponse;
+                CWSProtocol::PrepareResponse(Request, wsmResponse);
+
+                wsmResponse.MessageTypeId = mtCallError;
+                wsmResponse.ErrorCode = CReply::internal_server_error;
+                wsmResponse.ErrorMessage = AException->what();
+
+                SendResponse(APollQuery, wsmResponse);
+
+                if (OnResponse != nullptr)
+                    OnResponse(CString());
+
+                Log()->Error(APP_LOG_EMERG, 0, AException->what());
+            };
+
+            auto lpSession = CSession::FindOfConnection(AConnection);
+            if (lpSession == nullptr)
+                return false;
+
+            CStringList SQL;
+
+            SQL.Add(m_OcppRouter.Bind(Id, Identity, Payload, lpSession->Session(), lpSession->Agent(), lpSession->IP(),
+                                      !m_LogRing.Active()));
+
+            return ExecSQL(SQL, AConnection, OnExecuted, OnException);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CWebService::OcppAuthorize(CHTTPServerConnection *AConnection, CPQStatementId Id, const CWSMessage &Request,
+                const CString &Identity, const CString &Payload) {
+
+            // Anything but a plain idTag is left to the database, which checks the payload and answers the error.
+            if (!CIdTagCache::IsRequest(Request.Payload))
+                return OcppFetch(AConnection, Id, Request, Identity, Payload);
+
+            const auto& IdTag = Request.Payload[_T("idTag")].AsString();
+
+            CString Status;
+            if (!m_IdTagCache.Find(Identity, IdTag, Status)) {
+                return OcppFetch(AConnection, Id, Request, Identity, Payload, [this, Identity, IdTag](const CString &Response) {
+                    if (Response.IsEmpty())
+                        return;
+                    const CJSON Json(Response);
+                    if (Json.ValueType() != jvtObject || !Json.HasOwnProperty(_T("idTagInfo")))
+                        return;
+                    const auto& LStatus = Json[_T("idTagInfo")][_T("status")].AsString();
+                    // "Invalid" means the charge point is unknown, not the idTag.
+                    if (LStatus != _T("Invalid"))
+                        m_IdTagCache.Add(Identity, IdTag, LStatus);
+                });
+            }
+
+            const auto Now = MsEpoch();
+
+            CWSMessage wsmResponse;
+            CWSProtocol::PrepareResponse(Request, wsmResponse);
+
+            CString Response(_T("{\"idTagInfo\": {\"expiryDate\": \""));
+            Response << MsToISOTime(Now + 86400000) << _T("\", \"status\": ");
+            CLogRecord::AppendString(Response, Status);
+            Response << _T("}}");
+
+            wsmResponse.Payload << Response;
+
+            WriteLog(CLogRecord::Ocpp(Now, Identity, Request.Action, Payload, Response, 0));
+
+            CString LResponse;
+            CWSProtocol::Response(wsmResponse, LResponse);
+
+            AConnection->WSReply()->SetPayload(LResponse);
+            AConnection->SendWebSocket(true);
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::OcppBootNotification(CHTTPServerConnection *AConnection, const CWSMessage &Request,
+                const CString &Identity, const CString &Payload) {
+
+            CBootRequest Boot;
+
+            Boot.Connection = AConnection;
+            Boot.Request = Request;
+            Boot.Identity = Identity;
+            Boot.Payload = Payload;
+            Boot.Epoch = MsEpoch();
+
+            if (m_BootQueue.Acquire()) {
+                RunBoot(Boot);
+            } else if (!m_BootQueue.Push(Boot)) {
+                OcppBootPending(Boot);
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::OcppBootPending(const CBootRequest &Boot) {
+
+            const auto Now = MsEpoch();
+
+            CWSMessage wsmResponse;
+            CWSProtocol::PrepareResponse(Boot.Request, wsmResponse);
+
+            // For "Pending" the interval is when the station should send BootNotification again.
+            const auto& Response = CString().Format("{\"currentTime\": \"%s\", \"interval\": %d, \"status\": \"Pending\"}",
+                                                    MsToISOTime(Now).c_str(), m_BootQueue.RetryInterval());
+
+            wsmResponse.Payload << Response;
+
+            WriteLog(CLogRecord::Ocpp(Now, Boot.Identity, Boot.Request.Action, Boot.Payload, Response, 0));
+
+            CString LResponse;
+            CWSProtocol::Response(wsmResponse, LResponse);
+
+            Boot.Connection->WSReply()->SetPayload(LResponse);
+            Boot.Connection->SendWebSocket(true);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::RunBoot(const CBootRequest &Boot) {
+
+            auto OnResponse = [this](const CString &Response) {
+                m_BootQueue.Release();
+                FlushBootQueue();
+            };
+
+            CPQStatementId Id;
+
+            try {
+                if (m_OcppRouter.Find(Boot.Request.Action, Id) &&
+                        OcppFetch(Boot.Connection, Id, Boot.Request, Boot.Identity, Boot.Payload, OnResponse))
+                    return;
+            } catch (std::exception &e) {
+                Log()->Error(APP_LOG_WARN, 0, e.what());
+            }
+
+            m_BootQueue.Release();
+
+            OcppBootPending(Boot);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::FlushBootQueue() {
+
+            const auto Now = MsEpoch();
+
+            CBootRequest Boot;
+
+            while (m_BootQueue.Expired(Boot, Now))
+                OcppBootPending(Boot);
+
+            while (m_BootQueue.Next(Boot, Now))
+                RunBoot(Boot);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::JobDone(const CString &Identity, const CString &Content) {
+
+            const auto Now = MsEpoch();
+
+            // A reply that did not get into the job store stays here until its time is up.
+            const auto Stored = m_JobStore.Add(Identity, Content, Now);
+            m_JobRelease.emplace_back(Identity, Stored ? Now : Now + (uint64_t) m_JobStore.TimeToLive() * 1000);
+
+            m_JobWaiters.Flush(Identity, [this](const CJobWaiter &Waiter) { return ReplyJob(Waiter, false); });
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        bool CWebService::ReplyJob(const CJobWaiter &Waiter, bool Final) {
+
+            const auto Now = MsEpoch();
+            const auto IsWebSocket = Waiter.Connection->Protocol() == pWebSocket;
+
+            CString Content;
+
+            auto LJob = m_pJobs->FindJobById(Waiter.Identity);
+
+            const auto Done = LJob != nullptr && !LJob->Reply().Content.IsEmpty();
+
+            if (Done) {
+                Content = LJob->Reply().Content;
+                m_JobRelease.emplace_back(Waiter.Identity, Now);
+            } else if (!m_JobStore.Find(Waiter.Identity, Content, Now)) {
+                if (!Final)
+                    return false;
+            }
+
+            // A reply is handed out once.
+            if (!Content.IsEmpty())
+                m_JobStore.Delete(Waiter.Identity);
+
+            if (IsWebSocket) {
+                CWSMessage wsmResponse;
+                CWSProtocol::PrepareResponse(Waiter.Request, wsmResponse);
+
+                if (!Content.IsEmpty()) {
+                    wsmResponse.Payload << Content;
+                } else {
+                    wsmResponse.MessageTypeId = mtCallError;
+                    wsmResponse.ErrorCode = LJob == nullptr ? CReply::not_found : CReply::no_content;
+                    wsmResponse.ErrorMessage = LJob == nullptr ? _T("Job not found.") : _T("Job is not done yet.");
+                }
+
+                CString LResponse;
+                CWSProtocol::Response(wsmResponse, LResponse);
+
+                Waiter.Connection->WSReply()->SetPayload(LResponse);
+                Waiter.Connection->SendWebSocket(true);
+            } else if (!Content.IsEmpty()) {
+                auto LReply = Waiter.Connection->Reply();
+
+                LReply->Content = Content;
+
+                CReply::GetReply(LReply, CReply::ok);
+
+                if (Done)
+                    LReply->Headers << LJob->Reply().Headers;
+
+                Waiter.Connection->SendReply();
+            } else {
+                Waiter.Connection->SendStockReply(LJob == nullptr ? CReply::not_found : CReply::no_content);
+            }
+
+            return true;
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::WaitJob(const CJobWaiter &Waiter) {
+
+            const auto Now = MsEpoch();
+
+            CJobWaiter LWaiter(Waiter);
+
+            if (LWaiter.Deadline > Now + m_JobWait)
+                LWaiter.Deadline = Now + m_JobWait;
+
+            if (LWaiter.Deadline <= Now) {
+                ReplyJob(LWaiter, true);
+                return;
+            }
+
+            if (ReplyJob(LWaiter, false))
+                return;
+
+            if (!m_JobWaiters.Add(LWaiter)) {
+                ReplyJob(LWaiter, true);
+                return;
+            }
+
+            // A WebSocket connection is already watched by its session.
+            if (LWaiter.Connection->Protocol() != pWebSocket) {
+#if defined(_GLIBCXX_RELEASE) && (_GLIBCXX_RELEASE >= 9)
+                LWaiter.Connection->OnDisconnected([this](auto && Sender) { DoJobDisconnected(Sender); });
+#else
+                LWaiter.Connection->OnDisconnected(std::bind(&CWebService::DoJobDisconnected, this, _1));
+#endif
+            }
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::FlushJobs() {
+
+            const auto Now = MsEpoch();
+
+            for (auto it = m_JobRelease.begin(); it != m_JobRelease.end();) {
+                if (it->second <= Now) {
+                    delete m_pJobs->FindJobById(it->first);
+                    it = m_JobRelease.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            // Jobs of other workers show up in the job store.
+            m_JobWaiters.Flush([this, Now](const CJobWaiter &Waiter) {
+                return ReplyJob(Waiter, Waiter.Deadline <= Now);
+            });
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::OcppStatusNotification(const CWSMessage &Request, const CString &Identity) {
+            if (!m_ConnectorTable.Active() || Request.Payload.ValueType() != jvtObject)
+                return;
+
+            const auto& Payload = Request.Payload;
+
+            if (!Payload.HasOwnProperty(_T("connectorId")) || !Payload.HasOwnProperty(_T("status")))
+                return;
+
+            CConnectorStatus Status;
+
+            Status.Identity = Identity;
+            Status.ConnectorId = StrToIntDef(Payload[_T("connectorId")].AsString().c_str(), -1);
+            Status.Status = Payload[_T("status")].AsString();
+
+            if (Payload.HasOwnProperty(_T("errorCode")))
+                Status.ErrorCode = Payload[_T("errorCode")].AsString();
+            if (Payload.HasOwnProperty(_T("info")))
+                Status.Info = Payload[_T("info")].AsString();
+            if (Payload.HasOwnProperty(_T("vendorId")))
+                Status.VendorId = Payload[_T("vendorId")].AsString();
+            if (Payload.HasOwnProperty(_T("vendorErrorCode")))
+                Status.VendorErrorCode = Payload[_T("vendorErrorCode")].AsString();
+            if (Payload.HasOwnProperty(_T("timestamp")))
+                Status.Timestamp = Payload[_T("timestamp")].AsString();
+
+            Status.Updated = MsEpoch();
+
+            if (!CConnectorTable::IsConnectorId(Status.ConnectorId) || Status.Status.IsEmpty())
+                return;
+
+            if (!m_ConnectorTable.Update(Status))
+                Log()->Error(APP_LOG_WARN, 0, "[ConnectorTable] No room for \"%s\" connector %d.", Identity.c_str(),
+                             Status.ConnectorId);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::OcppHeartbeat(CHTTPServerConnection *AConnection, const CWSMessage &Request,
+                const CString &Identity) {
+
+            // Only called for a session confirmed by the database.
+            auto lpSession = CSession::FindOfConnection(AConnection);
+            m_LastSeen.Touch(Identity, lpSession == nullptr ? CString() : lpSession->Session());
+
+            const auto Now = MsEpoch();
+
+            CWSMessage wsmResponse;
+            CWSProtocol::PrepareResponse(Request, wsmResponse);
+
+            const auto& Response = CString().Format("{\"currentTime\": \"%s\"}", MsToISOTime(Now).c_str());
+
+            wsmResponse.Payload << Response;
+
+            WriteLog(CLogRecord::Ocpp(Now, Identity, Request.Action, Request.Payload.ToString(), Response, 0));
+
+            CString LResponse;
+            CWSProtocol::Response(wsmResponse, LResponse);
+
+            AConnection->WSReply()->SetPayload(LResponse);
+            AConnection->SendWebSocket(true);
         }
         //--------------------------------------------------------------------------------------------------------------
 
-        void CWebService::DoOAuth2(CHTTPServerConnection *AConnection) {
-
-            auto AddParam = [AConnection](const CJSONMember &Item, TCHAR Separator = '&') {
-
-                const auto& Key = Item.String();
-                const auto& Value = Item.Value().AsString();
+        void CWebService::FlushLastSeen() {
 
-                if (Value.IsEmpty())
-                    throw ExceptionFrm(_T("OAuth2: Parameter \"%s\" is empty."), Key.c_str());
+            const auto Now = time(nullptr);
 
-                CString Result;
+            if (!m_LastSeen.Ready(Now))
+                return;
 
-                Result << Separator;
-                Result << Item.String();
-                Result << _T("=");
+            CStringList Params;
+            m_LastSeen.Take(Params, Now);
 
-                if (Key == _T("redirect_uri") && Value.front() == '/') {
-                    const auto& Origin = GetOrigin(AConnection);
-                    Result << CHTTPServer::URLEncode(Origin + Value);
-                } else {
-                    Result << CHTTPServer::URLEncode(Value);
+            auto OnExecuted = [this](CPQPollQuery *APollQuery) {
+                auto LResult = APollQuery->Results(0);
+                if (LResult->ExecStatus() != PGRES_TUPLES_OK) {
+                    m_LastSeen.Done(false);
+                    Log()->Error(APP_LOG_WARN, 0, LResult->GetErrorMessage());
+                    return;
                 }
-
-                return Result;
+                m_LastSeen.Done(true);
             };
 
-            auto LRequest = AConnection->Request();
-            auto LReply = AConnection->Reply();
+            auto OnException = [this](CPQPollQuery *APollQuery, Delphi::Exception::Exception *AException) {
+                m_LastSeen.Done(false);
+                Log()->Error(APP_LOG_WARN, 0, AException->what());
+            };
 
-            LReply->ContentType = CReply::html;
+            CStringList SQL;
 
-            CStringList LRouts;
-            SplitColumns(LRequest->Location.pathname, LRouts, '/');
+            try {
+                SQL.Add(CPQStatement::Get(psOcppSetLastSeen).Bind(Params));
 
-            if (LRouts.Count() < 2) {
-                AConnection->SendStockReply(CReply::not_found);
-                return;
+                if (ExecSQL(SQL, nullptr, OnExecuted, OnException))
+                    return;
+            } catch (std::exception &e) {
+                Log()->Error(APP_LOG_WARN, 0, e.what());
             }
 
-            CString Location;
-
-            const auto& Provider = LRouts[1];
+            m_LastSeen.Done(false);
+        }
+        //--------------------------------------------------------------------------------------------------------------
 
-            if (LRouts.Count() == 2) {
+        void CWebService::OcppMeterValues(CHTTPServerConnection *AConnection, const CWSMessage &Request,
+                const CString &Identity, const CString &Payload) {
 
-                const auto& AuthParams = Server().AuthParams();
-                const auto& AuthParam = AuthParams[Provider].Value();
+            const auto& Value = Request.Payload;
 
-                const auto& AuthURI = AuthParam.AuthURI();
-                const auto& ClientId = AuthParam.Audience();
+            // Same checks as ocpp.MeterValues, the rest is left to ocpp.AddMeterValues.
+            if (Value.ValueType() != jvtObject || !Value.HasOwnProperty(_T("connectorId")) || !Value.HasOwnProperty(_T("meterValue")))
+                throw Delphi::Exception::Exception(_T("MeterValues: connectorId and meterValue are required."));
 
-                CJSON jsonParams;
-                if (LRequest->Content.IsEmpty()) {
-                    for (int i = 0; i < LRequest->Params.Count(); ++i) {
-                        jsonParams.Object().AddPair(LRequest->Params.Names(i), LRequest->Params.ValueFromIndex(i));
-                    }
-                } else {
-                    ContentToJson(LRequest, jsonParams);
-                }
+            if (!Value[_T("meterValue")].IsArray())
+                throw Delphi::Exception::Exception(_T("MeterValues: meterValue must be an array."));
 
-                const auto& Params = jsonParams.Object();
+            const auto Now = MsEpoch();
 
-                Location = AuthURI;
-                Location += AddParam(CJSONMember("client_id", ClientId), '?');
+            CWSMessage wsmResponse;
+            CWSProtocol::PrepareResponse(Request, wsmResponse);
 
-                for (int i = 0; i < Params.Count(); i++)
-                    Location += AddParam(Params.Members(i), '&');
+            if (m_MeterBuffer.Add(Identity, Payload, Now)) {
+                wsmResponse.Payload << _T("{}");
 
+                WriteLog(CLogRecord::Ocpp(Now, Identity, Request.Action, Payload, _T("{}"), 0));
             } else {
-                const auto& Action = LRouts[2];
+                // The database is behind: let the station keep the values and send them again.
+                wsmResponse.MessageTypeId = mtCallError;
+                wsmResponse.ErrorCode = CReply::service_unavailable;
+                wsmResponse.ErrorMessage = _T("Meter values buffer is full.");
+            }
 
-                if (Action == "code") {
+            CString LResponse;
+            CWSProtocol::Response(wsmResponse, LResponse);
 
-                } else if (Action == "callback") {
+            AConnection->WSReply()->SetPayload(LResponse);
+            AConnection->SendWebSocket(true);
+
+            FlushMeterValues();
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::FlushMeterValues() {
+
+            const auto Now = MsEpoch();
+
+            if (!m_MeterBuffer.Ready(Now))
+                return;
+
+            CStringList Params;
+            Params.Add(m_MeterBuffer.Take(Now));
+            Params.Add(m_LogRing.Active() ? _T("false") : _T("true"));
 
+            auto OnExecuted = [this](CPQPollQuery *APollQuery) {
+                auto LResult = APollQuery->Results(0);
+                if (LResult->ExecStatus() != PGRES_TUPLES_OK) {
+                    m_MeterBuffer.Done(false);
+                    Log()->Error(APP_LOG_WARN, 0, LResult->GetErrorMessage());
+                    return;
                 }
+                m_MeterBuffer.Done(true);
+                FlushMeterValues();
+            };
 
-                DebugMessage("Callback (href): %s\n", LRequest->Location.href().c_str());
-                Location = "/";
+            auto OnException = [this](CPQPollQuery *APollQuery, Delphi::Exception::Exception *AException) {
+                m_MeterBuffer.Done(false);
+                Log()->Error(APP_LOG_WARN, 0, AException->what());
+            };
+
+            CStringList SQL;
+
+            try {
+                SQL.Add(CPQStatement::Get(psOcppAddMeterValues).Bind(Params));
+
+                if (ExecSQL(SQL, nullptr, OnExecuted, OnException))
+                    return;
+            } catch (std::exception &e) {
+                Log()->Error(APP_LOG_WARN, 0, e.what());
             }
 
-            DebugMessage("Location: %s\n", Location.c_str());
-            Redirect(AConnection, Location);
+            m_MeterBuffer.Done(false);
         }
         //--------------------------------------------------------------------------------------------------------------
 
-        void CWebService::DoAPI(CHTTPServerConnection *AConnection) {
+        void CWebService::DoConnectors(CHTTPServerConnection *AConnection) {
             auto LRequest = AConnection->Request();
             auto LReply = AConnection->Reply();
 
-            LReply->ContentType = CReply::json;
-
-            CStringList LRouts;
-            SplitColumns(LRequest->Location.pathname, LRouts, '/');
+            CAuthorization LAuthorization;
+            if (!CheckAuthorization(AConnection, LAuthorization)) {
+                AConnection->SendReply();
+                return;
+            }
 
-            if (LRouts.Count() < 3) {
-                AConnection->SendStockReply(CReply::not_found);
+            if (!m_ConnectorTable.Active()) {
+                AConnection->SendStockReply(CReply::service_unavailable);
                 return;
             }
 
-            const auto& LService = LRouts[0].Lower();
-            const auto& LVersion = LRouts[1].Lower();
-            const auto& LCommand = LRouts[2].Lower();
+            const CString LIdentity(LRequest->Params["identity"]);
 
-            if (LVersion == "v1") {
-                m_Version = 1;
-            } else if (LVersion == "v2") {
-                m_Version = 2;
-            }
+            // The first row of a client grant is the reply of api.authenticate.
+            const auto IsClient = LAuthorization.Schema == CAuthorization::asBasic &&
+                    LAuthorization.GrantType != CAuthorization::agtOwner;
 
-            if (LService != "api" || (m_Version == -1)) {
-                AConnection->SendStockReply(CReply::not_found);
-                return;
-            }
+            auto OnExecuted = [this, AConnection, LIdentity, IsClient](CPQPollQuery *APollQuery) {
 
-            try {
-                if (LCommand == "ping") {
+                auto LReply = AConnection->Reply();
+                auto LResult = APollQuery->Results(0);
 
-                    AConnection->SendStockReply(CReply::ok);
+                try {
+                    if (LResult->ExecStatus() != PGRES_TUPLES_OK)
+                        throw Delphi::Exception::EDBError(LResult->GetErrorMessage());
 
-                } else if (LCommand == "time") {
+                    const auto Count = LResult->nTuples();
+                    const auto From = IsClient ? 1 : 0;
 
-                    LReply->Content << "{\"serverTime\": " << to_string(MsEpoch()) << "}";
+                    if (IsClient && Count > 0)
+                        AfterQuery(LReply, _T("/authenticate"), LResult, 0, 1);
 
-                    AConnection->SendReply(CReply::ok);
+                    std::unordered_set<std::string> Allowed;
 
-                } else if (m_Version == 2) {
+                    for (int Row = From; Row < Count; ++Row) {
+                        if (LResult->GetIsNull(Row, 0))
+                            continue;
 
-                    if (LRouts.Count() != 3) {
-                        AConnection->SendStockReply(CReply::bad_request);
-                        return;
-                    }
+                        const CJSON Payload(CString(LResult->GetValue(Row, 0)));
 
-                    const auto& Identity = LRouts[2];
+                        if (Payload.HasOwnProperty(_T("error"))) {
+                            LReply->ContentType = CReply::json;
+                            LReply->Content = Payload.ToString();
+                            AConnection->SendReply(CReply::forbidden, nullptr, true);
+                            return;
+                        }
 
-                    if (Identity.Length() != APOSTOL_MODULE_UID_LENGTH) {
-                        AConnection->SendStockReply(CReply::bad_request);
-                        return;
+                        Allowed.insert(Payload[_T("identity")].AsString().c_str());
                     }
 
-                    auto LJob = m_pJobs->FindJobById(Identity);
+                    ReplyConnectors(AConnection, LIdentity, Allowed);
+                } catch (Delphi::Exception::Exception &E) {
+                    LReply->Content.Clear();
+                    ExceptionToJson(0, E, LReply->Content);
+                    Log()->Error(APP_LOG_EMERG, 0, E.what());
 
-                    if (LJob == nullptr) {
-                        AConnection->SendStockReply(CReply::not_found);
-                        return;
-                    }
+                    AConnection->SendReply(CReply::internal_server_error, nullptr, true);
+                }
+            };
 
-                    if (LJob->Reply().Content.IsEmpty()) {
-                        AConnection->SendStockReply(CReply::no_content);
-                        return;
-                    }
+            auto OnException = [this, AConnection](CPQPollQuery *APollQuery, Delphi::Exception::Exception *AException) {
 
-                    LReply->Content = LJob->Reply().Content;
+                Log()->Error(APP_LOG_EMERG, 0, AException->what());
+                AConnection->SendStockReply(CReply::internal_server_error, true);
 
-                    CReply::GetReply(LReply, CReply::ok);
+            };
 
-                    LReply->Headers << LJob->Reply().Headers;
+            // The table has no owners, the database tells which stations the caller may see.
+            CJSON Json;
+            if (!LIdentity.IsEmpty())
+                Json.Object().AddPair(_T("identity"), LIdentity);
 
-                    AConnection->SendReply();
+            CStringList SQL;
+
+            if (!AuthStatement(LAuthorization, _T("/charge_point/access"), LIdentity.IsEmpty() ? CString() : Json.ToString(),
+                    GetUserAgent(AConnection), GetHost(AConnection), SQL)) {
+                AConnection->SendStockReply(CReply::bad_request);
+                return;
+            }
 
-                    delete LJob;
+            if (!ExecSQL(SQL, AConnection, OnExecuted, OnException))
+                AConnection->SendStockReply(CReply::service_unavailable);
+        }
+        //--------------------------------------------------------------------------------------------------------------
 
-                } else {
+        void CWebService::ReplyConnectors(CHTTPServerConnection *AConnection, const CString &Identity,
+                const std::unordered_set<std::string> &Allowed) {
 
-                    DoObject(AConnection, LRouts);
+            auto LReply = AConnection->Reply();
 
-                }
-            } catch (std::exception &e) {
-                ExceptionToJson(0, e, LReply->Content);
+            std::vector<CConnectorStatus> List;
+            m_ConnectorTable.List(Identity, List);
 
-                AConnection->CloseConnection(true);
-                AConnection->SendReply(CReply::bad_request);
+            CSessionRecord Record;
 
-                Log()->Error(APP_LOG_EMERG, 0, e.what());
+            LReply->ContentType = CReply::json;
+
+            LReply->Content = "[";
+
+            size_t Count = 0;
+            for (const auto& Status : List) {
+                if (Allowed.count(Status.Identity.c_str()) == 0)
+                    continue;
+
+                if (Count++ > 0)
+                    LReply->Content << ", ";
+
+                const auto Connected = m_SessionDirectory.Find(Status.Identity, Record) && Record.Worker != 0;
+
+                LReply->Content << "{\"identity\": ";
+                CLogRecord::AppendString(LReply->Content, Status.Identity);
+                LReply->Content << ", \"connectorId\": " << CString().Format("%d", Status.ConnectorId);
+                LReply->Content << ", \"status\": ";
+                CLogRecord::AppendString(LReply->Content, Status.Status);
+                LReply->Content << ", \"errorCode\": ";
+                CLogRecord::AppendString(LReply->Content, Status.ErrorCode);
+                LReply->Content << ", \"info\": ";
+                CLogRecord::AppendString(LReply->Content, Status.Info);
+                LReply->Content << ", \"vendorId\": ";
+                CLogRecord::AppendString(LReply->Content, Status.VendorId);
+                LReply->Content << ", \"vendorErrorCode\": ";
+                CLogRecord::AppendString(LReply->Content, Status.VendorErrorCode);
+                LReply->Content << ", \"timestamp\": ";
+                CLogRecord::AppendString(LReply->Content, Status.Timestamp);
+                LReply->Content << ", \"updated\": \"" << MsToISOTime(Status.Updated) << "\"";
+                LReply->Content << ", \"connected\": " << (Connected ? "true" : "false") << "}";
             }
+            LReply->Content << "]";
+
+            AConnection->SendReply(CReply::ok, nullptr, true);
         }
         //--------------------------------------------------------------------------------------------------------------
 
-        void CWebService::DoWSSession(CHTTPServerConnection *AConnection) {
-
-            auto LRequest = AConnection->Request();
+        void CWebService::DoMetrics(CHTTPServerConnection *AConnection) {
             auto LReply = AConnection->Reply();
 
-            LReply->ContentType = CReply::html;
+            if (!m_Metrics) {
+                AConnection->SendStockReply(CReply::not_found);
+                return;
+            }
 
-            CStringList LPath;
-            SplitColumns(LRequest->Location.pathname, LPath, '/');
+            CAuthorization LAuthorization;
+            if (!CheckAuthorization(AConnection, LAuthorization)) {
+                AConnection->SendReply();
+                return;
+            }
 
-            if (LPath.Count() < 2) {
-                AConnection->SendStockReply(CReply::not_found);
+            // A password is only checked by the database, a bearer token has been verified here.
+            if (LAuthorization.Schema != CAuthorization::asBearer) {
+                AConnection->SendStockReply(CReply::forbidden);
                 return;
             }
 
+            LReply->ContentType = CReply::json;
+
+            LReply->Content = "{";
+            LReply->Content << "\"nonce\": {\"count\": " << to_string(m_NonceStore.Count());
+            LReply->Content << ", \"accepted\": " << to_string(m_NonceStore.Accepted());
+            LReply->Content << ", \"rejected\": " << to_string(m_NonceStore.Rejected()) << "}";
+            LReply->Content << ", \"secret\": {\"count\": " << to_string(m_SecretCache.Count()) << "}";
+            LReply->Content << ", \"token\": {\"count\": " << to_string(m_TokenCache.Count());
+            LReply->Content << ", \"hits\": " << to_string(m_TokenCache.Hits());
+            LReply->Content << ", \"misses\": " << to_string(m_TokenCache.Misses()) << "}";
+            LReply->Content << ", \"verifier\": {\"count\": " << to_string(m_Verifiers->Count()) << "}";
+            LReply->Content << ", \"session\": {\"count\": " << to_string(m_SessionCache.Count());
+            LReply->Content << ", \"hits\": " << to_string(m_SessionCache.Hits());
+            LReply->Content << ", \"misses\": " << to_string(m_SessionCache.Misses()) << "}";
+            LReply->Content << ", \"response\": {\"count\": " << to_string(m_ResponseCache.Count());
+            LReply->Content << ", \"hits\": " << to_string(m_ResponseCache.Hits());
+            LReply->Content << ", \"misses\": " << to_string(m_ResponseCache.Misses()) << "}";
+            LReply->Content << ", \"jobs\": {\"stored\": " << to_string(m_JobStore.Stored());
+            LReply->Content << ", \"claimed\": " << to_string(m_JobStore.Claimed());
+            LReply->Content << ", \"evicted\": " << to_string(m_JobStore.Evicted());
+            LReply->Content << ", \"waiting\": " << to_string(m_JobWaiters.Count()) << "}";
+            LReply->Content << ", \"flight\": {\"count\": " << to_string(m_FlightTable.Count());
+            LReply->Content << ", \"started\": " << to_string(m_FlightTable.Started());
+            LReply->Content << ", \"joined\": " << to_string(m_FlightTable.Joined()) << "}";
+            LReply->Content << ", \"ocpp\": {\"routed\": " << to_string(m_OcppRouter.Routed());
+            LReply->Content << ", \"failed\": " << to_string(m_OcppRouter.Failed());
+            LReply->Content << ", \"boot\": {\"running\": " << to_string(m_BootQueue.Running());
+            LReply->Content << ", \"queued\": " << to_string(m_BootQueue.Count());
+            LReply->Content << ", \"peak\": " << to_string(m_BootQueue.Peak());
+            LReply->Content << ", \"admitted\": " << to_string(m_BootQueue.Admitted());
+            LReply->Content << ", \"deferred\": " << to_string(m_BootQueue.Deferred()) << "}";
+            LReply->Content << ", \"heartbeat\": " << to_string(m_LastSeen.Answered());
+            LReply->Content << ", \"lastSeen\": {\"count\": " << to_string(m_LastSeen.Count());
+            LReply->Content << ", \"flushed\": " << to_string(m_LastSeen.Flushed()) << "}";
+            LReply->Content << ", \"meterValues\": {\"count\": " << to_string(m_MeterBuffer.Count());
+            LReply->Content << ", \"size\": " << to_string(m_MeterBuffer.Size());
+            LReply->Content << ", \"accepted\": " << to_string(m_MeterBuffer.Accepted());
+            LReply->Content << ", \"rejected\": " << to_string(m_MeterBuffer.Rejected());
+            LReply->Content << ", \"flushed\": " << to_string(m_MeterBuffer.Flushed()) << "}";
+            LReply->Content << ", \"connectors\": {\"updated\": " << to_string(m_ConnectorTable.Updated());
+            LReply->Content << ", \"evicted\": " << to_string(m_ConnectorTable.Evicted()) << "}";
+            LReply->Content << ", \"directory\": {\"evicted\": " << to_string(m_SessionDirectory.Evicted()) << "}";
+            LReply->Content << ", \"idTag\": {\"count\": " << to_string(m_IdTagCache.Count());
+            LReply->Content << ", \"hits\": " << to_string(m_IdTagCache.Hits());
+            LReply->Content << ", \"misses\": " << to_string(m_IdTagCache.Misses()) << "}}";
+            LReply->Content << ", \"log\": {\"count\": " << to_string(m_LogRing.Count());
+            LReply->Content << ", \"dropped\": " << to_string(m_LogRing.Dropped());
+            LReply->Content << ", \"fallback\": " << to_string(m_LogFallback) << "}";
+            LReply->Content << ", \"static\": {\"count\": " << to_string(m_StaticCache.Count());
+            LReply->Content << ", \"size\": " << to_string(m_StaticCache.Size());
+            LReply->Content << ", \"hits\": " << to_string(m_StaticCache.Hits());
+            LReply->Content << ", \"misses\": " << to_string(m_StaticCache.Misses()) << "}";
+            LReply->Content << "}";
+
+            AConnection->SendReply(CReply::ok);
+        }
+        //--------------------------------------------------------------------------------------------------------------
+
+        void CWebService::DoWSSession(CHTTPServerConnection *AConnection, const CRouteMatch &Route) {
+
+            auto LRequest = AConnection->Request();
+            auto LReply = AConnection->Reply();
+
+            LReply->ContentType = CReply::html;
+
             const auto& LAuthorization = LRequest->Headers.Values(_T("Authorization"));
 
             const auto& LSecWebSocketKey = LRequest->Headers.Values(_T("Sec-WebSocket-Key"));
@@ -1287,7 +2766,7 @@ namespace Apostol {
                 return;
             }
 
-            const auto& LIdentity = LPath[1];
+            const auto& LIdentity = Route.Value(0);
             const auto& LSecWebSocketProtocol = LRequest->Headers.Values(_T("Sec-WebSocket-Protocol"));
 
             const CString LAccept(SHA1(LSecWebSocketKey + _T("258EAFA5-E914-47DA-95CA-C5AB0DC85B11")));
@@ -1340,6 +2819,9 @@ namespace Apostol {
                     CWSProtocol::Request(LRequest, wsmRequest);
 
                     if (wsmRequest.MessageTypeId == mtOpen) {
+                        // Until the database answers, the calls of the station go the generic way.
+                        AConnection->Data().Values("authorized", CString());
+
                         if (wsmRequest.Payload.ValueType() == jvtObject) {
                             wsmRequest.Action = _T("/authorize");
 
@@ -1362,6 +2844,8 @@ namespace Apostol {
 
                         wsmRequest.MessageTypeId = mtCall;
                     } else if (wsmRequest.MessageTypeId == mtClose) {
+                        AConnection->Data().Values("authorized", CString());
+
                         wsmRequest.Action = _T("/sign/out");
                         wsmRequest.MessageTypeId = mtCall;
                     }
@@ -1369,7 +2853,65 @@ namespace Apostol {
                     const auto& LPayload = wsmRequest.Payload.ToString();
                     const auto& LNonce = to_string(MsEpoch() * 1000);
 
-                    if (wsmRequest.MessageTypeId == mtCall) {
+                    CPQStatementId LOcppStatement;
+
+                    // Only a session confirmed by the database skips daemon.SignFetch.
+                    const auto Authorized = wsmRequest.MessageTypeId == mtCall && IsAuthorized(AConnection);
+
+                    if (Authorized && m_LastSeen.Enabled() && wsmRequest.Action == _T("Heartbeat")) {
+
+                        OcppHeartbeat(AConnection, wsmRequest, lpSession->Identity());
+
+                    } else if (Authorized && m_MeterBuffer.Enabled() && wsmRequest.Action == _T("MeterValues")) {
+
+                        OcppMeterValues(AConnection, wsmRequest, lpSession->Identity(), LPayload);
+
+                    } else if (Authorized && m_BootQueue.Enabled() && wsmRequest.Action == _T("BootNotification") &&
+                            m_OcppRouter.Find(wsmRequest.Action, LOcppStatement)) {
+
+                        OcppBootNotification(AConnection, wsmRequest, lpSession->Identity(), LPayload);
+
+                    } else if (Authorized && m_IdTagCache.Enabled() && wsmRequest.Action == _T("Authorize") &&
+                            m_OcppRouter.Find(wsmRequest.Action, LOcppStatement)) {
+
+                        if (!OcppAuthorize(AConnection, LOcppStatement, wsmRequest, lpSession->Identity(), LPayload))
+                            throw Delphi::Exception::Exception(_T("Service unavailable."));
+
+                    } else if (Authorized && m_OcppRouter.Find(wsmRequest.Action, LOcppStatement)) {
+
+                        // The idTag is about to be (or stop being) in a transaction: ask the database next time.
+                        if (wsmRequest.Payload.ValueType() == jvtObject && wsmRequest.Payload.HasOwnProperty(_T("idTag")))
+                            m_IdTagCache.Delete(wsmRequest.Payload[_T("idTag")].AsString());
+
+                        // The current state is served from memory, the database keeps the history.
+                        if (wsmRequest.Action == _T("StatusNotification"))
+                            OcppStatusNotification(wsmRequest, lpSession->Identity());
+
+                        if (!OcppFetch(AConnection, LOcppStatement, wsmRequest, lpSession->Identity(), LPayload))
+                            throw Delphi::Exception::Exception(_T("Service unavailable."));
+
+                    } else if (wsmRequest.MessageTypeId == mtCall && wsmRequest.Action == _T("/job")) {
+
+                        if (wsmRequest.Payload.ValueType() != jvtObject || !wsmRequest.Payload.HasOwnProperty(_T("id")))
+                            throw Delphi::Exception::Exception(_T("Job id cannot be empty."));
+
+                        CJobWaiter Waiter;
+
+                        Waiter.Connection = AConnection;
+                        Waiter.Identity = wsmRequest.Payload[_T("id")].AsString();
+
+                        if (Waiter.Identity.Length() != APOSTOL_MODULE_UID_LENGTH)
+                            throw Delphi::Exception::Exception(_T("Invalid job id."));
+
+                        Waiter.Request = wsmRequest;
+                        Waiter.Deadline = MsEpoch();
+
+                        if (wsmRequest.Payload.HasOwnProperty(_T("wait")))
+                            Waiter.Deadline += StrToIntDef(wsmRequest.Payload[_T("wait")].AsString().c_str(), 0);
+
+                        WaitJob(Waiter);
+
+                    } else if (wsmRequest.MessageTypeId == mtCall) {
 
                         sigData = wsmRequest.Action;
                         sigData << LNonce;
@@ -1421,19 +2963,35 @@ namespace Apostol {
                 return;
             }
 
-            if (LPath.SubString(0, 9) == _T("/session/")) {
-                DoWSSession(AConnection);
+            const auto& Route = CRouteTable::Match(LPath, rmGet);
+
+            if (Route.Status == rsNotFound) {
+                AConnection->SendStockReply(CReply::not_found);
                 return;
             }
 
-            if (LPath.SubString(0, 5) == _T("/api/")) {
-                DoAPI(AConnection);
+            if (Route.Status == rsNotAllowed) {
+                MethodNotAllowed(AConnection);
                 return;
             }
 
-            if (LPath.SubString(0, 8) == _T("/oauth2/")) {
-                DoOAuth2(AConnection);
-                return;
+            switch (Route.Id) {
+                case rtNone:
+                    break;
+
+                case rtSession:
+                    DoWSSession(AConnection, Route);
+                    return;
+
+                case rtOAuth2:
+                    DoOAuth2(AConnection, Route);
+                    return;
+
+                default:
+                    if (Route.Version != 0)
+                        m_Version = Route.Version;
+                    DoAPI(AConnection, Route);
+                    return;
             }
 
             // If path ends in slash.
@@ -1448,9 +3006,11 @@ namespace Apostol {
                 CString LSession;
                 const auto auth = CheckSession(LRequest, LPath, LSession);
                 if (auth == 1) {
-                    if (!Authorize(AConnection, LSession, LPath))
-                        AConnection->SendStockReply(CReply::service_unavailable);
-                    return;
+                    if (!m_SessionCache.Check(LSession)) {
+                        if (!Authorize(AConnection, LSession, LPath))
+                            AConnection->SendStockReply(CReply::service_unavailable);
+                        return;
+                    }
                 } else if (auth == 0) {
                     LPath = _T("/sign/index.html");
                 } else if (auth == -1) {
@@ -1461,7 +3021,8 @@ namespace Apostol {
                 }
             }
 
-            SendResource(AConnection, LPath, Mapping::ExtToType(fileExt));
+            if (!SendStatic(AConnection, LPath, Mapping::ExtToType(fileExt)))
+                SendResource(AConnection, LPath, Mapping::ExtToType(fileExt));
         }
         //--------------------------------------------------------------------------------------------------------------
 
@@ -1471,34 +3032,21 @@ namespace Apostol {
 
             LReply->ContentType = CReply::json;
 
-            CStringList LRouts;
-            SplitColumns(LRequest->Location.pathname, LRouts, '/');
-            if (LRouts.Count() < 2) {
-                AConnection->SendStockReply(CReply::not_found);
-                return;
-            }
+            const auto& Route = CRouteTable::Match(LRequest->Location.pathname, rmPost);
 
-            if (LRouts[1] == _T("v1")) {
-                m_Version = 1;
-            } else if (LRouts[1] == _T("v2")) {
-                m_Version = 2;
+            if (Route.Status == rsNotAllowed) {
+                MethodNotAllowed(AConnection);
+                return;
             }
 
-            if (LRouts[0] != _T("api") || (m_Version == -1)) {
+            if (Route.Status != rsFound) {
                 AConnection->SendStockReply(CReply::not_found);
                 return;
             }
 
-            CString LPath;
-            for (int I = 2; I < LRouts.Count(); ++I) {
-                LPath.Append('/');
-                LPath.Append(LRouts[I].Lower());
-            }
+            m_Version = Route.Version;
 
-            if (LPath.IsEmpty()) {
-                AConnection->SendStockReply(CReply::not_found);
-                return;
-            }
+            const auto& LPath = CRouteTable::Route(Route.Tail);
 
             const auto& LContentType = LRequest->Headers.Values(_T("Content-Type")).Lower();
             const auto contentJson = (LContentType.Find(_T("application/json")) != CString::npos);
@@ -1514,12 +3062,17 @@ namespace Apostol {
             const auto& LSignature = LRequest->Headers.Values(_T("Signature"));
 
             try {
+                if (Route.Id == rtStation) {
+                    DoStation(AConnection, Route.Value(0));
+                    return;
+                }
+
                 if (LSignature.IsEmpty()) {
 
-                    if (LPath == "/sign/in") {
+                    if (Route.Id == rtSignIn) {
                         SignIn(AConnection, LPayload, LAgent, LHost);
                         return;
-                    } else if (LPath == "/sign/up") {
+                    } else if (Route.Id == rtSignUp) {
                         SignUp(AConnection, LPayload);
                         return;
                     } else {
@@ -1541,7 +3094,19 @@ namespace Apostol {
                     if (!receiveWindow.IsEmpty())
                         LReceiveWindow = StrToIntDef(receiveWindow.c_str(), LReceiveWindow);
 
-                    SignFetch(AConnection, LPath, LPayload, LSession, LNonce, LSignature, LAgent, LHost, LReceiveWindow);
+                    bool LVerified;
+
+                    try {
+                        LVerified = CheckSignature(LPath, LPayload, LSession, LNonce, LSignature, LReceiveWindow);
+                    } catch (CAuthorizationError &e) {
+                        ExceptionToJson(CReply::unauthorized, e, LReply->Content);
+                        AConnection->SendReply(CReply::unauthorized);
+                        Log()->Error(APP_LOG_NOTICE, 0, e.what());
+                        return;
+                    }
+
+                    SignFetch(AConnection, LPath, LPayload, LSession, LNonce, LSignature, LAgent, LHost, LReceiveWindow,
+                              LVerified);
                 }
             } catch (Delphi::Exception::Exception &E) {
                 ExceptionToJson(0, E, LReply->Content);
@@ -1556,8 +3121,116 @@ namespace Apostol {
 
             if (m_Password.IsEmpty()) {
                 const auto& connInfo = Config()->PostgresConnInfo();
-                m_Password = PQQuoteLiteral(connInfo["password"]);
+                m_Password = connInfo["password"];
+            }
+
+            CIniFile IniFile(Config()->ConfFile().c_str());
+
+            m_Pipeline = IniFile.ReadBool(_T("postgres/pipeline"), _T("enable"), false);
+            m_PipelineDepth = IniFile.ReadInteger(_T("postgres/pipeline"), _T("depth"), m_PipelineDepth);
+            m_PipelineBatch = IniFile.ReadInteger(_T("postgres/pipeline"), _T("batch"), m_PipelineBatch);
+
+            m_SecretCache.TimeToLive(IniFile.ReadInteger(_T("webservice/secret"), _T("ttl"), (int) m_SecretCache.TimeToLive()));
+            m_SecretCache.MaxCount(IniFile.ReadInteger(_T("webservice/secret"), _T("max"), (int) m_SecretCache.MaxCount()));
+
+            m_TokenCache.TimeToLive(IniFile.ReadInteger(_T("webservice/token"), _T("ttl"), (int) m_TokenCache.TimeToLive()));
+            m_TokenCache.MaxCount(IniFile.ReadInteger(_T("webservice/token"), _T("max"), (int) m_TokenCache.MaxCount()));
+
+            m_SessionDirectory.Capacity(IniFile.ReadInteger(_T("webservice/directory"), _T("size"), (int) m_SessionDirectory.Capacity()));
+            m_ConnectorTable.Capacity(IniFile.ReadInteger(_T("webservice/connectors"), _T("size"), (int) m_ConnectorTable.Capacity()));
+
+            m_JobStore.Capacity((size_t) IniFile.ReadInteger(_T("webservice/jobs"), _T("size"), (int) m_JobStore.Capacity()));
+            m_JobStore.RecordSize((size_t) IniFile.ReadInteger(_T("webservice/jobs"), _T("record"), (int) (m_JobStore.RecordSize() / 1024)) * 1024);
+            m_JobStore.TimeToLive(IniFile.ReadInteger(_T("webservice/jobs"), _T("ttl"), (int) m_JobStore.TimeToLive()));
+            m_JobWaiters.MaxCount((size_t) IniFile.ReadInteger(_T("webservice/jobs"), _T("waiters"), (int) m_JobWaiters.MaxCount()));
+            m_JobWait = (uint64_t) IniFile.ReadInteger(_T("webservice/jobs"), _T("wait"), (int) m_JobWait);
+
+            try {
+                m_SessionDirectory.Open();
+                m_ConnectorTable.Open();
+                m_JobStore.Open();
+                m_Channel.Open();
+            } catch (std::exception &e) {
+                Log()->Error(APP_LOG_ALERT, 0, e.what());
+            }
+
+            m_SessionCache.TimeToLive(IniFile.ReadInteger(_T("webservice/session"), _T("ttl"), (int) m_SessionCache.TimeToLive()));
+            m_SessionCache.MaxCount(IniFile.ReadInteger(_T("webservice/session"), _T("max"), (int) m_SessionCache.MaxCount()));
+
+            m_ResponseCache.Enabled(IniFile.ReadBool(_T("webservice/response"), _T("enable"), false));
+            m_ResponseCache.MaxCount(IniFile.ReadInteger(_T("webservice/response"), _T("max"), (int) m_ResponseCache.MaxCount()));
+
+            const auto& responseRules = IniFile.ReadString(_T("webservice/response"), _T("routes"), CString());
+            if (!responseRules.IsEmpty())
+                m_ResponseCache.Rules(responseRules);
+
+            m_Metrics = IniFile.ReadBool(_T("webservice/metrics"), _T("enable"), false);
+
+            m_FlightTable.Enabled(IniFile.ReadBool(_T("webservice/flight"), _T("enable"), m_FlightTable.Enabled()));
+            m_FlightTable.MaxWaiters((size_t) IniFile.ReadInteger(_T("webservice/flight"), _T("waiters"), (int) m_FlightTable.MaxWaiters()));
+
+            if (IniFile.ReadBool(_T("postgres/listen"), _T("enable"), true)) {
+                const auto& connInfo = Config()->PostgresConnInfo();
+
+                for (const auto Keyword : {_T("dbname"), _T("host"), _T("hostaddr"), _T("port"), _T("user"), _T("password"), _T("sslmode")}) {
+                    const auto& Value = connInfo[Keyword];
+                    if (!Value.IsEmpty())
+                        m_Listener.Param(Keyword, Value);
+                }
+
+                m_Listener.Listen(_T("session"));
+                m_Listener.Listen(_T("idtag"));
+                m_Listener.Listen(_T("cache"));
+
+                m_Listener.OnNotify([this](const CString &Channel, const CString &Payload) { DoNotify(Channel, Payload); });
+
+                // Revocations sent while we were not listening are lost.
+                m_Listener.OnConnected([this]() {
+                    m_SessionCache.Clear();
+                    m_SecretCache.Clear();
+                    m_IdTagCache.Clear();
+                    m_ResponseCache.Clear();
+                });
+            } else {
+                // Nothing would tell us that a card was blocked.
+                m_IdTagCache.Enabled(false);
+                m_ResponseCache.Enabled(false);
+            }
+
+            if (IniFile.ReadBool(_T("postgres/log"), _T("async"), false)) {
+                try {
+                    m_LogRing.Open((uint32_t) IniFile.ReadInteger(_T("postgres/log"), _T("size"), 16384),
+                                   (uint32_t) IniFile.ReadInteger(_T("postgres/log"), _T("record"), 4096));
+                } catch (std::exception &e) {
+                    Log()->Error(APP_LOG_ALERT, 0, e.what());
+                }
+            }
+
+            m_OcppRouter.Enabled(IniFile.ReadBool(_T("webservice/ocpp"), _T("router"), m_OcppRouter.Enabled()));
+            m_LastSeen.Enabled(IniFile.ReadBool(_T("webservice/ocpp"), _T("heartbeat"), m_LastSeen.Enabled()));
+            m_LastSeen.Period(IniFile.ReadInteger(_T("webservice/ocpp"), _T("flush"), (int) m_LastSeen.Period()));
+
+            m_BootQueue.Enabled(IniFile.ReadBool(_T("webservice/boot"), _T("enable"), m_BootQueue.Enabled()));
+            m_BootQueue.Limit((size_t) IniFile.ReadInteger(_T("webservice/boot"), _T("limit"), (int) m_BootQueue.Limit()));
+            m_BootQueue.MaxCount((size_t) IniFile.ReadInteger(_T("webservice/boot"), _T("queue"), (int) m_BootQueue.MaxCount()));
+            m_BootQueue.Wait((uint64_t) IniFile.ReadInteger(_T("webservice/boot"), _T("wait"), (int) m_BootQueue.Wait()));
+            m_BootQueue.Retry(IniFile.ReadInteger(_T("webservice/boot"), _T("retry"), m_BootQueue.Retry()));
+            m_BootQueue.Jitter(IniFile.ReadInteger(_T("webservice/boot"), _T("jitter"), m_BootQueue.Jitter()));
+
+            if (m_IdTagCache.Enabled()) {
+                m_IdTagCache.Enabled(IniFile.ReadBool(_T("webservice/idtag"), _T("enable"), true));
+                m_IdTagCache.TimeToLive(IniFile.ReadInteger(_T("webservice/idtag"), _T("ttl"), (int) m_IdTagCache.TimeToLive()));
+                m_IdTagCache.MaxCount(IniFile.ReadInteger(_T("webservice/idtag"), _T("max"), (int) m_IdTagCache.MaxCount()));
             }
+
+            m_MeterBuffer.Enabled(IniFile.ReadBool(_T("webservice/meter"), _T("enable"), m_MeterBuffer.Enabled()));
+            m_MeterBuffer.MaxSize((size_t) IniFile.ReadInteger(_T("webservice/meter"), _T("max"), (int) (m_MeterBuffer.MaxSize() / 1024)) * 1024);
+            m_MeterBuffer.BatchCount((size_t) IniFile.ReadInteger(_T("webservice/meter"), _T("batch"), (int) m_MeterBuffer.BatchCount()));
+            m_MeterBuffer.Interval((uint64_t) IniFile.ReadInteger(_T("webservice/meter"), _T("interval"), (int) m_MeterBuffer.Interval()));
+
+            m_StaticCache.Enabled(IniFile.ReadBool(_T("webservice/static"), _T("enable"), m_StaticCache.Enabled()));
+            m_StaticCache.MaxSize((size_t) IniFile.ReadInteger(_T("webservice/static"), _T("max"), (int) (m_StaticCache.MaxSize() / 1024)) * 1024);
+            m_StaticCache.MaxFileSize((size_t) IniFile.ReadInteger(_T("webservice/static"), _T("file"), (int) (m_StaticCache.MaxFileSize() / 1024)) * 1024);
         }
         //--------------------------------------------------------------------------------------------------------------
 
@@ -1565,9 +3238,30 @@ namespace Apostol {
             auto now = Now();
 
             if ((now >= m_FixedDate)) {
-                m_FixedDate = now + (CDateTime) 30 * 60 / 86400; // 30 min
+                m_FixedDate = now;
                 LoadProviders();
             }
+
+            if (m_PipelineInFlight < m_PipelineDepth)
+                FlushPipeline();
+
+            FlushBootQueue();
+            FlushJobs();
+            FlushLastSeen();
+            FlushMeterValues();
+
+            m_Listener.Poll();
+
+            CString Packet;
+            while (m_Channel.Receive(Packet)) {
+                const auto Pos = Packet.Find('\n');
+                if (Pos == CString::npos)
+                    continue;
+
+                const auto& Identity = Packet.SubString(0, Pos);
+                if (!SendToStation(Identity, Packet.SubString(Pos + 1, Packet.Length() - Pos - 1), false))
+                    Log()->Error(APP_LOG_WARN, 0, _T("Station \"%s\" is not connected to this worker."), Identity.c_str());
+            }
         }
         //--------------------------------------------------------------------------------------------------------------
 
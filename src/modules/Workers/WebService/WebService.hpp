@@ -25,6 +25,34 @@ Author:
 #define APOSTOL_WEBSERVICE_HPP
 //----------------------------------------------------------------------------------------------------------------------
 
+#include <deque>
+#include <list>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Statement.hpp"
+#include "TimedCache.hpp"
+#include "SecretCache.hpp"
+#include "NonceStore.hpp"
+#include "TokenCache.hpp"
+#include "StaticCache.hpp"
+#include "SessionCache.hpp"
+#include "IdTagCache.hpp"
+#include "SessionDirectory.hpp"
+#include "ConnectorTable.hpp"
+#include "OcppRouter.hpp"
+#include "RouteTable.hpp"
+#include "ResponseCache.hpp"
+#include "FlightTable.hpp"
+#include "JobStore.hpp"
+#include "LastSeen.hpp"
+#include "MeterBuffer.hpp"
+#include "BootQueue.hpp"
+#include "LogRecord.hpp"
+//----------------------------------------------------------------------------------------------------------------------
+
 extern "C++" {
 
 namespace Apostol {
@@ -37,6 +65,21 @@ namespace Apostol {
 
         //--------------------------------------------------------------------------------------------------------------
 
+        class CVerifierTable;
+        //--------------------------------------------------------------------------------------------------------------
+
+        typedef struct pipeline_query_s {
+            CHTTPServerConnection *Connection;
+            CStringList SQL;
+        } CPipelineQuery;
+        //--------------------------------------------------------------------------------------------------------------
+
+        /**
+         * Called when an OCPP call routed to the database has been answered. Response is empty on error.
+         */
+        typedef std::function<void (const CString &Response)> COnOcppResponse;
+        //--------------------------------------------------------------------------------------------------------------
+
         class CWebService: public CApostolModule {
         private:
 
@@ -46,15 +89,110 @@ namespace Apostol {
 
             CSessionManager m_SessionManager;
 
+            CSecretCache m_SecretCache;
+            CNonceStore m_NonceStore;
+            CTokenCache m_TokenCache;
+            CStaticCache m_StaticCache;
+            CSessionCache m_SessionCache;
+            CResponseCache m_ResponseCache;
+            CFlightTable m_FlightTable;
+
+            CPQListener m_Listener;
+
+            CSessionDirectory m_SessionDirectory;
+            CConnectorTable m_ConnectorTable;
+            CWorkerChannel m_Channel;
+
+            COcppRouter m_OcppRouter;
+            CLastSeen m_LastSeen;
+            CMeterBuffer m_MeterBuffer;
+            CIdTagCache m_IdTagCache;
+            CBootQueue m_BootQueue;
+
+            CJobStore m_JobStore;
+            CJobWaiters m_JobWaiters;
+            uint64_t m_JobWait;
+
+            // Jobs of this worker to drop from m_pJobs and when: the job store has them or their time is up.
+            std::deque<std::pair<CString, uint64_t>> m_JobRelease;
+
+            CLogRing m_LogRing;
+            size_t m_LogFallback;
+
+            std::shared_ptr<CVerifierTable> m_Verifiers;
+
+            CKeySegment m_KeySegment;
+            uint64_t m_KeySequence;
+
+            bool m_Metrics;
+
+            bool m_Pipeline;
+
+            int m_PipelineDepth;
+            int m_PipelineBatch;
+            int m_PipelineInFlight;
+
+            std::deque<CPipelineQuery> m_PipelineQueue;
+
+            // Batches sent to the database, a connection that goes away is set to nullptr in them.
+            std::list<std::shared_ptr<std::vector<CPipelineQuery>>> m_PipelineBatches;
+
             void InitMethods() override;
 
+            bool EnqueueQuery(CHTTPServerConnection *AConnection, const CStringList &SQL);
+            void FlushPipeline();
+            void RemovePipeline(CHTTPServerConnection *AConnection);
+
             static void AfterQueryWS(CHTTPServerConnection *AConnection, const CString &Path, const CJSON &Payload);
-            static void AfterQuery(CReply *AReply, const CString &Path, const CString &Content);
+
+            static void ResetSession(CHTTPServerConnection *AConnection);
+            static bool IsAuthorized(CHTTPServerConnection *AConnection);
+
+            void AfterQuery(CReply *AReply, const CString &Path, CPQResult *AResult, int From, int Count);
+
+            CReply::CStatusType ResultToReply(CReply *AReply, CPQResult *AResult, const CString &Path,
+                const CString &GrantType);
+
+            void QueryResult(CHTTPServerConnection *AConnection, CPQResult *AResult);
 
             void QueryException(CPQPollQuery *APollQuery, const std::exception &e);
+            void QueryException(CHTTPServerConnection *AConnection, const std::exception &e);
+
+            void WriteLog(const CString &Record);
+            void WriteFetchLog(CHTTPServerConnection *AConnection);
 
             void LoadProviders();
 
+            bool SendStatic(CHTTPServerConnection *AConnection, const CString &Path, LPCTSTR ContentType);
+
+            bool SendToStation(const CString &Identity, const CString &Message, bool Forward = true);
+
+            bool OcppFetch(CHTTPServerConnection *AConnection, CPQStatementId Id, const CWSMessage &Request,
+                const CString &Identity, const CString &Payload, COnOcppResponse && OnResponse = nullptr);
+
+            bool OcppAuthorize(CHTTPServerConnection *AConnection, CPQStatementId Id, const CWSMessage &Request,
+                const CString &Identity, const CString &Payload);
+
+            void OcppBootNotification(CHTTPServerConnection *AConnection, const CWSMessage &Request, const CString &Identity,
+                const CString &Payload);
+            void OcppBootPending(const CBootRequest &Boot);
+            void RunBoot(const CBootRequest &Boot);
+            void FlushBootQueue();
+
+            void OcppStatusNotification(const CWSMessage &Request, const CString &Identity);
+
+            void JobDone(const CString &Identity, const CString &Content);
+            bool ReplyJob(const CJobWaiter &Waiter, bool Final);
+            void WaitJob(const CJobWaiter &Waiter);
+            void FlushJobs();
+
+            void OcppHeartbeat(CHTTPServerConnection *AConnection, const CWSMessage &Request, const CString &Identity);
+            void FlushLastSeen();
+
+            void OcppMeterValues(CHTTPServerConnection *AConnection, const CWSMessage &Request, const CString &Identity,
+                const CString &Payload);
+            void FlushMeterValues();
+
             static void CheckAuthorizationData(CRequest *ARequest, CAuthorization &Authorization);
 
             CString CreateToken(const CCleanToken& CleanToken);
@@ -62,14 +200,23 @@ namespace Apostol {
 
         protected:
 
-            void DoObject(CHTTPServerConnection *AConnection, const CStringList& Routs);
+            void DoObject(CHTTPServerConnection *AConnection, const CRouteMatch &Route);
 
             void DoSessionDisconnected(CObject *Sender);
+            void DoJobDisconnected(CObject *Sender);
+            void DoQueryDisconnected(CObject *Sender);
 
-            void DoOAuth2(CHTTPServerConnection *AConnection);
-            void DoAPI(CHTTPServerConnection *AConnection);
+            void DoNotify(const CString &Channel, const CString &Payload);
 
-            void DoWSSession(CHTTPServerConnection *AConnection);
+            void DoOAuth2(CHTTPServerConnection *AConnection, const CRouteMatch &Route);
+            void DoAPI(CHTTPServerConnection *AConnection, const CRouteMatch &Route);
+            void DoMetrics(CHTTPServerConnection *AConnection);
+            void DoStation(CHTTPServerConnection *AConnection, const CString &Identity);
+            void DoConnectors(CHTTPServerConnection *AConnection);
+            void ReplyConnectors(CHTTPServerConnection *AConnection, const CString &Identity,
+                                 const std::unordered_set<std::string> &Allowed);
+
+            void DoWSSession(CHTTPServerConnection *AConnection, const CRouteMatch &Route);
             void DoWebSocket(CHTTPServerConnection *AConnection);
 
             void DoGet(CHTTPServerConnection *AConnection) override;
@@ -101,18 +248,32 @@ namespace Apostol {
             bool SignUp(CHTTPServerConnection *AConnection, const CString &Payload);
             bool SignIn(CHTTPServerConnection *AConnection, const CString &Payload, const CString &Agent, const CString &Host);
 
+            bool CachedFetch(CHTTPServerConnection *AConnection, const CString &Owner, const CString &Path,
+                             const CString &Payload);
+
+            bool JoinFlight(CHTTPServerConnection *AConnection, const CString &Owner, const CString &Path,
+                            const CString &Payload);
+            void ReplyFlight(CHTTPServerConnection *AConnection, CReply::CStatusType Status, bool Stock = false);
+
+            bool AuthStatement(const CAuthorization &Authorization, const CString &Path, const CString &Payload,
+                               const CString &Agent, const CString &Host, CStringList &SQL) const;
+
             void AuthFetch(CHTTPServerConnection *AConnection, const CAuthorization &Authorization,
                            const CString &Path, const CString &Payload, const CString &Agent, const CString &Host);
 
             void SignFetch(CHTTPServerConnection *AConnection, const CString &Path, const CString &Payload,
                            const CString &Session, const CString &Nonce, const CString &Signature, const CString &Agent,
-                           const CString &Host, long int ReceiveWindow = 5000);
+                           const CString &Host, long int ReceiveWindow = 5000, bool Verified = false);
 
             static CString GetSession(CRequest *ARequest);
             static int CheckSession(CRequest *ARequest, const CString &Path, CString &Session);
 
             bool CheckAuthorization(CHTTPServerConnection *AConnection, CAuthorization &Authorization);
 
+            // Returns true if the signature was verified here, false if it is left to the database.
+            bool CheckSignature(const CString &Path, const CString &Payload, const CString &Session,
+                                const CString &Nonce, const CString &Signature, long int ReceiveWindow);
+
         };
     }
 }